@@ -0,0 +1,52 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <type_traits>
+
+namespace ccb { namespace binary
+{
+    // First bit of the stream is the most significant bit of the first byte.
+    struct MsbFirst {};
+
+    // First bit of the stream is the least significant bit of the first byte (DEFLATE order).
+    struct LsbFirst {};
+
+    namespace details
+    {
+        // Bit streams declare their order with a BitOrder typedef; streams without one are MSB-first.
+        template<typename BitStream>
+        class IsLsbFirst
+        {
+            template<typename S>
+            static auto test(int) -> typename std::is_same<typename S::BitOrder, LsbFirst>::type;
+
+            template<typename>
+            static auto test(...) -> std::false_type;
+
+        public:
+
+            static const bool value = decltype(test<BitStream>(0))::value;
+        };
+    }
+} }
@@ -1,19 +1,20 @@
 #pragma once
 
+#include <type_traits>
+
+#include <ccb/binary/Endianness.hpp>
+
 namespace ccb { namespace binary
 {
-    struct BigEndian {};
-    struct LittleEndian {};
-
     namespace details
     {
         template<typename Endianness, size_t N, typename Iter, typename Unit>
-        struct ByteIteratorIncrementer
+        struct GenericByteIncrementer
         {
         };
 
         template<size_t N, typename Iter, typename Unit>
-        struct ByteIteratorIncrementer<BigEndian, N, Iter, Unit>
+        struct GenericByteIncrementer<BigEndian, N, Iter, Unit>
         {
             void operator () (Unit& value, Iter& pos, Iter end, bool firstIncrement)
             {
@@ -39,7 +40,7 @@ namespace ccb { namespace binary
         };
 
         template<size_t N, typename Iter, typename Unit>
-        struct ByteIteratorIncrementer<LittleEndian, N, Iter, Unit>
+        struct GenericByteIncrementer<LittleEndian, N, Iter, Unit>
         {
             void operator () (Unit& value, Iter& pos, Iter end, bool firstIncrement)
             {
@@ -63,6 +64,51 @@ namespace ccb { namespace binary
                 }
             }
         };
+
+        // Over contiguous bytes a whole unit is fetched with a single load; only the incomplete unit at
+        // the very end goes byte by byte.
+        template<typename Endianness, size_t N, typename Iter, typename Unit>
+        struct ContiguousByteIncrementer
+        {
+            void operator () (Unit& value, Iter& pos, Iter end, bool firstIncrement)
+            {
+                if ((pos != end) && firstIncrement)
+                {
+                    pos++;
+                }
+
+                if (end - pos >= static_cast<ptrdiff_t>(N))
+                {
+                    value = static_cast<Unit>(details::Load<Endianness, typename UnsignedOfSize<N>::type>(pos));
+                    pos += N - 1;
+                }
+                else
+                {
+                    GenericByteIncrementer<Endianness, N, Iter, Unit>()(value, pos, end, false);
+                }
+            }
+        };
+
+        template<size_t N, typename Iter>
+        struct IsContiguousByteIterator
+        {
+            static const bool value = false;
+        };
+
+        template<size_t N, typename T>
+        struct IsContiguousByteIterator<N, T*>
+        {
+            static const bool value = (sizeof(T) == 1) && ((N == 1) || (N == 2) || (N == 4) || (N == 8));
+        };
+
+        template<typename Endianness, size_t N, typename Iter, typename Unit>
+        struct ByteIteratorIncrementer
+            : std::conditional<
+                IsContiguousByteIterator<N, Iter>::value,
+                ContiguousByteIncrementer<Endianness, N, Iter, Unit>,
+                GenericByteIncrementer<Endianness, N, Iter, Unit>>::type
+        {
+        };
     }
 
     template<typename Endianness, size_t N, typename Iter, typename Unit = uint32_t>
@@ -0,0 +1,177 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#ifdef _MSC_VER
+#include <stdlib.h>
+#endif
+
+namespace ccb { namespace binary
+{
+    struct BigEndian {};
+    struct LittleEndian {};
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    typedef BigEndian HostEndian;
+#else
+    typedef LittleEndian HostEndian;
+#endif
+
+    namespace details
+    {
+        template<size_t N>
+        struct UnsignedOfSize
+        {
+        };
+
+        template<>
+        struct UnsignedOfSize<1>
+        {
+            typedef uint8_t type;
+        };
+
+        template<>
+        struct UnsignedOfSize<2>
+        {
+            typedef uint16_t type;
+        };
+
+        template<>
+        struct UnsignedOfSize<4>
+        {
+            typedef uint32_t type;
+        };
+
+        template<>
+        struct UnsignedOfSize<8>
+        {
+            typedef uint64_t type;
+        };
+    }
+
+    inline uint8_t ByteSwap(uint8_t value)
+    {
+        return value;
+    }
+
+    inline uint16_t ByteSwap(uint16_t value)
+    {
+#ifdef _MSC_VER
+        return _byteswap_ushort(value);
+#else
+        return __builtin_bswap16(value);
+#endif
+    }
+
+    inline uint32_t ByteSwap(uint32_t value)
+    {
+#ifdef _MSC_VER
+        return _byteswap_ulong(value);
+#else
+        return __builtin_bswap32(value);
+#endif
+    }
+
+    inline uint64_t ByteSwap(uint64_t value)
+    {
+#ifdef _MSC_VER
+        return _byteswap_uint64(value);
+#else
+        return __builtin_bswap64(value);
+#endif
+    }
+
+    namespace details
+    {
+        template<typename Endianness>
+        struct EndianConverter
+        {
+            template<typename U>
+            static U Convert(U value)
+            {
+                return std::is_same<Endianness, HostEndian>::value ? value : ByteSwap(value);
+            }
+        };
+
+        template<typename Endianness, typename T>
+        T Load(const void* ptr)
+        {
+            static_assert(std::is_arithmetic<T>::value, "Only arithmetic types can be loaded");
+
+            typedef typename UnsignedOfSize<sizeof(T)>::type Unsigned;
+
+            Unsigned bits;
+            memcpy(&bits, ptr, sizeof(bits));
+            bits = EndianConverter<Endianness>::Convert(bits);
+
+            T value;
+            memcpy(&value, &bits, sizeof(value));
+
+            return value;
+        }
+
+        template<typename Endianness, typename T>
+        void Store(void* ptr, T value)
+        {
+            static_assert(std::is_arithmetic<T>::value, "Only arithmetic types can be stored");
+
+            typedef typename UnsignedOfSize<sizeof(T)>::type Unsigned;
+
+            Unsigned bits;
+            memcpy(&bits, &value, sizeof(bits));
+            bits = EndianConverter<Endianness>::Convert(bits);
+
+            memcpy(ptr, &bits, sizeof(bits));
+        }
+    }
+
+    // Unaligned loads and stores of arithmetic values in a fixed byte order; each compiles to a single
+    // move, plus a bswap when the order differs from the host one.
+    template<typename T>
+    T LoadBE(const void* ptr)
+    {
+        return details::Load<BigEndian, T>(ptr);
+    }
+
+    template<typename T>
+    T LoadLE(const void* ptr)
+    {
+        return details::Load<LittleEndian, T>(ptr);
+    }
+
+    template<typename T>
+    void StoreBE(void* ptr, T value)
+    {
+        details::Store<BigEndian>(ptr, value);
+    }
+
+    template<typename T>
+    void StoreLE(void* ptr, T value)
+    {
+        details::Store<LittleEndian>(ptr, value);
+    }
+} }
@@ -0,0 +1,320 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace ccb { namespace binary
+{
+    namespace details
+    {
+        // Nibble value of every character, -1 for characters that are not hex digits.
+        inline const int8_t* HexValues()
+        {
+            static const struct Table
+            {
+                int8_t values[256];
+
+                Table()
+                {
+                    for (int i = 0; i < 256; i++)
+                    {
+                        values[i] = -1;
+                    }
+
+                    for (int i = 0; i < 10; i++)
+                    {
+                        values['0' + i] = static_cast<int8_t>(i);
+                    }
+
+                    for (int i = 0; i < 6; i++)
+                    {
+                        values['a' + i] = static_cast<int8_t>(10 + i);
+                        values['A' + i] = static_cast<int8_t>(10 + i);
+                    }
+                }
+            } table;
+
+            return table.values;
+        }
+
+        inline void HexEncodeScalar(const uint8_t* src, size_t size, char* dest)
+        {
+            static const char digits[] = "0123456789abcdef";
+
+            for (size_t i = 0; i < size; i++)
+            {
+                dest[2 * i] = digits[src[i] >> 4];
+                dest[2 * i + 1] = digits[src[i] & 0x0f];
+            }
+        }
+
+        inline void HexDecodeScalar(const char* src, size_t size, uint8_t* dest)
+        {
+            const auto values = HexValues();
+
+            for (size_t i = 0; i < size; i++)
+            {
+                auto hi = values[static_cast<uint8_t>(src[2 * i])];
+                auto lo = values[static_cast<uint8_t>(src[2 * i + 1])];
+
+                if ((hi < 0) || (lo < 0))
+                {
+                    throw std::invalid_argument(std::string("Not a hex symbol: ") + ((hi < 0) ? src[2 * i] : src[2 * i + 1]));
+                }
+
+                dest[i] = static_cast<uint8_t>((hi << 4) | lo);
+            }
+        }
+
+#if defined(__SSE2__) || defined(_M_X64)
+        // Nibbles 0..15 to '0'..'9', 'a'..'f'.
+        inline __m128i NibblesToHex(__m128i nibbles)
+        {
+            auto letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10));
+
+            return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+        }
+
+        // Encodes 16 bytes into 32 characters.
+        inline void HexEncode16(const uint8_t* src, char* dest)
+        {
+            auto mask = _mm_set1_epi8(0x0f);
+            auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+
+            auto hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+            auto lo = _mm_and_si128(bytes, mask);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), NibblesToHex(_mm_unpacklo_epi8(hi, lo)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 16), NibblesToHex(_mm_unpackhi_epi8(hi, lo)));
+        }
+
+        // Characters to nibbles; valid gets all bits set in lanes holding hex digits. Out-of-range
+        // differences wrap around in 8 bits, so a single signed range check per class is enough.
+        inline __m128i HexToNibbles(__m128i chars, __m128i& valid)
+        {
+            auto digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+            auto letter = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+
+            auto isDigit = _mm_and_si128(_mm_cmpgt_epi8(digit, _mm_set1_epi8(-1)), _mm_cmplt_epi8(digit, _mm_set1_epi8(10)));
+            auto isLetter = _mm_and_si128(_mm_cmpgt_epi8(letter, _mm_set1_epi8(-1)), _mm_cmplt_epi8(letter, _mm_set1_epi8(6)));
+
+            valid = _mm_or_si128(isDigit, isLetter);
+
+            return _mm_or_si128(
+                _mm_and_si128(isDigit, digit),
+                _mm_and_si128(isLetter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+        }
+
+        // Joins pairs of nibbles, high one first, into the low bytes of 16-bit lanes.
+        inline __m128i JoinNibbles(__m128i nibbles)
+        {
+            auto hi = _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00ff)), 4);
+            auto lo = _mm_srli_epi16(nibbles, 8);
+
+            return _mm_or_si128(hi, lo);
+        }
+
+        // Decodes 32 characters into 16 bytes; returns false, writing nothing, if any of them is not a hex digit.
+        inline bool HexDecode16(const char* src, uint8_t* dest)
+        {
+            __m128i valid1;
+            __m128i valid2;
+
+            auto nibbles1 = HexToNibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), valid1);
+            auto nibbles2 = HexToNibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16)), valid2);
+
+            if (_mm_movemask_epi8(_mm_and_si128(valid1, valid2)) != 0xffff)
+            {
+                return false;
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_packus_epi16(JoinNibbles(nibbles1), JoinNibbles(nibbles2)));
+
+            return true;
+        }
+#endif
+
+#if defined(__AVX2__)
+        inline __m256i NibblesToHex(__m256i nibbles)
+        {
+            auto letters = _mm256_and_si256(_mm256_cmpgt_epi8(nibbles, _mm256_set1_epi8(9)), _mm256_set1_epi8('a' - '0' - 10));
+
+            return _mm256_add_epi8(_mm256_add_epi8(nibbles, _mm256_set1_epi8('0')), letters);
+        }
+
+        // Encodes 32 bytes into 64 characters.
+        inline void HexEncode32(const uint8_t* src, char* dest)
+        {
+            auto mask = _mm256_set1_epi8(0x0f);
+            auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+
+            auto hi = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), mask);
+            auto lo = _mm256_and_si256(bytes, mask);
+
+            // Unpacking works within 128-bit lanes, so the halves come out as (0-7, 16-23) and (8-15, 24-31).
+            auto first = NibblesToHex(_mm256_unpacklo_epi8(hi, lo));
+            auto second = NibblesToHex(_mm256_unpackhi_epi8(hi, lo));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest), _mm256_permute2x128_si256(first, second, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 32), _mm256_permute2x128_si256(first, second, 0x31));
+        }
+
+        inline __m256i HexToNibbles(__m256i chars, __m256i& valid)
+        {
+            auto digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+            auto letter = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+
+            auto isDigit = _mm256_and_si256(_mm256_cmpgt_epi8(digit, _mm256_set1_epi8(-1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(10), digit));
+            auto isLetter = _mm256_and_si256(_mm256_cmpgt_epi8(letter, _mm256_set1_epi8(-1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(6), letter));
+
+            valid = _mm256_or_si256(isDigit, isLetter);
+
+            return _mm256_or_si256(
+                _mm256_and_si256(isDigit, digit),
+                _mm256_and_si256(isLetter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+        }
+
+        inline __m256i JoinNibbles(__m256i nibbles)
+        {
+            auto hi = _mm256_slli_epi16(_mm256_and_si256(nibbles, _mm256_set1_epi16(0x00ff)), 4);
+            auto lo = _mm256_srli_epi16(nibbles, 8);
+
+            return _mm256_or_si256(hi, lo);
+        }
+
+        // Decodes 64 characters into 32 bytes.
+        inline bool HexDecode32(const char* src, uint8_t* dest)
+        {
+            __m256i valid1;
+            __m256i valid2;
+
+            auto nibbles1 = HexToNibbles(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)), valid1);
+            auto nibbles2 = HexToNibbles(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32)), valid2);
+
+            if (_mm256_movemask_epi8(_mm256_and_si256(valid1, valid2)) != -1)
+            {
+                return false;
+            }
+
+            // Packing also works within lanes, put the 64-bit quarters back in order.
+            auto packed = _mm256_packus_epi16(JoinNibbles(nibbles1), JoinNibbles(nibbles2));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest), _mm256_permute4x64_epi64(packed, 0xd8));
+
+            return true;
+        }
+#endif
+    }
+
+    /// Writes 2 * size lowercase hex digits to dest. Uses SSE2 on x86-64 and AVX2 when the build enables it.
+    inline void HexEncode(const void* data, size_t size, char* dest)
+    {
+        auto src = static_cast<const uint8_t*>(data);
+        size_t i = 0;
+
+#if defined(__AVX2__)
+        for (; i + 32 <= size; i += 32)
+        {
+            details::HexEncode32(src + i, dest + 2 * i);
+        }
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+        for (; i + 16 <= size; i += 16)
+        {
+            details::HexEncode16(src + i, dest + 2 * i);
+        }
+#endif
+
+        details::HexEncodeScalar(src + i, size - i, dest + 2 * i);
+    }
+
+    /// Decodes length hex digits (either case) into length / 2 bytes at dest. Throws std::invalid_argument
+    /// on odd length or a character that is not a hex digit.
+    inline void HexDecode(const char* hex, size_t length, void* dest)
+    {
+        if (length % 2 != 0)
+        {
+            throw std::invalid_argument("Hex string has odd length");
+        }
+
+        auto out = static_cast<uint8_t*>(dest);
+        auto size = length / 2;
+        size_t i = 0;
+
+        // Blocks with an invalid character drop to the scalar loop, which reports the character.
+#if defined(__AVX2__)
+        for (; i + 32 <= size; i += 32)
+        {
+            if (!details::HexDecode32(hex + 2 * i, out + i))
+            {
+                break;
+            }
+        }
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+        for (; i + 16 <= size; i += 16)
+        {
+            if (!details::HexDecode16(hex + 2 * i, out + i))
+            {
+                break;
+            }
+        }
+#endif
+
+        details::HexDecodeScalar(hex + 2 * i, size - i, out + i);
+    }
+
+    inline std::string ToHex(const void* data, size_t size)
+    {
+        std::string result(2 * size, '\0');
+
+        if (size > 0)
+        {
+            HexEncode(data, size, &result[0]);
+        }
+
+        return result;
+    }
+
+    inline std::vector<uint8_t> FromHex(const std::string& hex)
+    {
+        std::vector<uint8_t> result(hex.size() / 2);
+
+        HexDecode(hex.data(), hex.size(), result.data());
+
+        return result;
+    }
+} }
@@ -25,7 +25,14 @@
 #include <algorithm>
 #include <cassert>
 #include <cinttypes>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
+
+#include <ccb/binary/BitOrder.hpp>
 
 namespace ccb { namespace binary
 {
@@ -55,6 +62,112 @@ namespace ccb { namespace binary
 
             return c;
         }
+
+        // Lookup table slot packed into 32 bits: the number of bits the slot resolves at its table level,
+        // the width of the sub-table it links to (zero for a symbol) and a symbol index or sub-table offset.
+        struct TableEntry
+        {
+            static uint32_t Symbol(uint32_t index, uint32_t length)
+            {
+                return (index << 8) | length;
+            }
+
+            static uint32_t Link(uint32_t offset, uint32_t length, uint32_t subBits)
+            {
+                return (offset << 8) | (subBits << 4) | length;
+            }
+
+            static uint32_t Length(uint32_t entry)
+            {
+                return entry & 0x0f;
+            }
+
+            static uint32_t SubBits(uint32_t entry)
+            {
+                return (entry >> 4) & 0x0f;
+            }
+
+            static uint32_t Value(uint32_t entry)
+            {
+                return entry >> 8;
+            }
+        };
+
+        template<typename BitStream>
+        class HasPeek
+        {
+            template<typename S>
+            static auto test(int)
+            -> decltype(std::declval<S&>().Peek(1u), std::declval<S&>().Skip(1u), std::declval<const S&>().HasBits(1u), std::true_type());
+
+            template<typename>
+            static auto test(...) -> std::false_type;
+
+        public:
+
+            static const bool value = decltype(test<BitStream>(0))::value;
+        };
+
+        inline uint32_t ReverseBits(uint32_t bits, uint32_t length)
+        {
+            uint32_t result = 0;
+
+            for (uint32_t i = 0; i < length; i++)
+            {
+                result = (result << 1) | ((bits >> i) & 1);
+            }
+
+            return result;
+        }
+
+        // Assigns canonical codes (consecutive values within a length, shorter codes first, ties broken by
+        // symbol order, as DEFLATE does) to the given code lengths. Zero length marks an unused symbol.
+        inline std::vector<Code> CanonicalCodes(const std::vector<uint32_t>& lengths)
+        {
+            static const uint32_t MAX_LENGTH = 31;
+
+            std::vector<uint32_t> counts(MAX_LENGTH + 1, 0);
+
+            for (auto length : lengths)
+            {
+                if (length > MAX_LENGTH)
+                {
+                    throw std::logic_error("Code length is too large");
+                }
+
+                counts[length]++;
+            }
+
+            counts[0] = 0;
+
+            int64_t left = 1;
+            std::vector<uint32_t> next(MAX_LENGTH + 1, 0);
+            uint32_t code = 0;
+
+            for (uint32_t length = 1; length <= MAX_LENGTH; length++)
+            {
+                left = (left << 1) - counts[length];
+                if (left < 0)
+                {
+                    throw std::logic_error("Code lengths are over-subscribed");
+                }
+
+                code = (code + counts[length - 1]) << 1;
+                next[length] = code;
+            }
+
+            std::vector<Code> result(lengths.size(), Code { 0, 0 });
+
+            for (size_t i = 0; i < lengths.size(); i++)
+            {
+                if (lengths[i] != 0)
+                {
+                    result[i] = Code { next[lengths[i]]++, lengths[i] };
+                }
+            }
+
+            return result;
+        }
     }
 } }
 
@@ -74,12 +187,27 @@ namespace std
 
 namespace ccb { namespace binary
 {
+    // Decodes prefix codes through flat lookup tables: the first TABLE_BITS bits of a code index
+    // the primary table directly, longer codes continue in sub-tables of at most TABLE_BITS bits each.
     template <typename T>
     class HuffmanDecoder
     {
     private:
 
-        std::unordered_map<details::Code, T> table;
+        static const uint32_t TABLE_BITS = 9;
+
+        std::vector<details::Code> codes;
+
+        std::vector<T> values;
+
+        std::vector<uint32_t> table;
+
+        // Same tables with every level indexed by bit-reversed codes, for LSB-first streams.
+        std::vector<uint32_t> lsbTable;
+
+        std::vector<std::pair<uint32_t, uint32_t>> levels;
+
+        uint32_t primaryBits = 0;
 
         uint32_t maxLength = 0;
 
@@ -93,8 +221,24 @@ namespace ccb { namespace binary
         {
             for (const auto& pair : table)
             {
-                this->Add(pair.first, pair.second);
+                this->AddCode(this->CodeFromString(pair.first), pair.second);
             }
+
+            this->BuildTables();
+        }
+
+        // Decoder for the canonical code with the given lengths; symbols[i] gets a code of codeLengths[i] bits.
+        HuffmanDecoder(const std::vector<uint32_t>& codeLengths, const std::vector<T>& symbols)
+        {
+            assert (codeLengths.size() == symbols.size());
+
+            this->AddCanonical(codeLengths, [&symbols](size_t i) { return symbols[i]; });
+        }
+
+        // Same, with symbols being the indices into codeLengths.
+        HuffmanDecoder(const std::vector<uint32_t>& codeLengths)
+        {
+            this->AddCanonical(codeLengths, [](size_t i) { return static_cast<T>(i); });
         }
 
     public:
@@ -103,38 +247,103 @@ namespace ccb { namespace binary
         {
             assert ((bits >> length) == 0);
 
-            this->AddCode({ bits, length }, value);
+            this->AddAndBuild({ bits, length }, value);
         }
 
         void Add(const char* bits, const T& value)
         {
-            this->AddCode(this->CodeFromString(bits),value);
+            this->AddAndBuild(this->CodeFromString(bits), value);
         }
 
         template<typename BitStream>
         T Next(BitStream& bitstream) const
+        {
+            return this->Decode(bitstream, std::integral_constant<bool, details::HasPeek<BitStream>::value>());
+        }
+
+    private:
+
+        // Streams that can look ahead resolve up to TABLE_BITS bits with a single table read.
+        template<typename BitStream>
+        T Decode(BitStream& bitstream, std::true_type) const
+        {
+            const auto& lookup = details::IsLsbFirst<BitStream>::value ? this->lsbTable : this->table;
+
+            uint32_t offset = 0;
+            uint32_t width = this->primaryBits;
+
+            while (width > 0)
+            {
+                auto bits = static_cast<uint32_t>(bitstream.Peek(width));
+                auto entry = lookup[offset + bits];
+                auto length = details::TableEntry::Length(entry);
+
+                if ((length == 0) || !bitstream.HasBits(length))
+                {
+                    if (details::IsLsbFirst<BitStream>::value)
+                    {
+                        bits = details::ReverseBits(bits, width);
+                    }
+
+                    throw std::runtime_error("Sequence not recognized: " + this->CodeToString({ bits, width }));
+                }
+
+                bitstream.Skip(length);
+
+                if (details::TableEntry::SubBits(entry) == 0)
+                {
+                    return this->values[details::TableEntry::Value(entry)];
+                }
+
+                offset = details::TableEntry::Value(entry);
+                width = details::TableEntry::SubBits(entry);
+            }
+
+            throw std::runtime_error("Sequence not recognized: empty code table");
+        }
+
+        // Bit-at-a-time streams still avoid hashing: after every bit the table slot for the prefix read
+        // so far tells whether a code of exactly that length is complete.
+        template<typename BitStream>
+        T Decode(BitStream& bitstream, std::false_type) const
         {
             details::Code code = { 0, 0 };
 
-            while ((code.length <= this->maxLength) && (bitstream))
+            uint32_t offset = 0;
+            uint32_t width = this->primaryBits;
+            details::Code prefix = { 0, 0 };
+
+            while ((width > 0) && (bitstream))
             {
                 bool bit;
                 bitstream >> bit;
 
                 code << bit;
+                prefix << bit;
 
-                auto pos = this->table.find(code);
-                if (pos != this->table.end())
+                auto entry = this->table[offset + (prefix.bits << (width - prefix.length))];
+                auto length = details::TableEntry::Length(entry);
+
+                if (length == prefix.length)
+                {
+                    if (details::TableEntry::SubBits(entry) == 0)
+                    {
+                        return this->values[details::TableEntry::Value(entry)];
+                    }
+
+                    offset = details::TableEntry::Value(entry);
+                    width = details::TableEntry::SubBits(entry);
+                    prefix = { 0, 0 };
+                }
+                else if ((length == 0) && (prefix.length == width))
                 {
-                    return pos->second;
+                    break;
                 }
             }
 
             throw std::runtime_error("Sequence not recognized: " + this->CodeToString(code));
         }
 
-    private:
-
         std::string CodeToString(const details::Code& code) const
         {
             std::string result;
@@ -149,14 +358,162 @@ namespace ccb { namespace binary
 
         void AddCode(const details::Code& code, const T& value)
         {
-            if (this->table.count(code) > 0)
+            this->codes.push_back(code);
+            this->values.push_back(value);
+
+            this->maxLength = std::max(this->maxLength, code.length);
+        }
+
+        // Tables are rebuilt right away, so Next stays const and safe to call from several threads.
+        // A rejected code is taken back, leaving the decoder as it was.
+        void AddAndBuild(const details::Code& code, const T& value)
+        {
+            auto maxLength = this->maxLength;
+            this->AddCode(code, value);
+
+            try
             {
-                throw std::logic_error("Duplicate code: " + CodeToString(code));
+                this->BuildTables();
             }
+            catch (...)
+            {
+                this->codes.pop_back();
+                this->values.pop_back();
+                this->maxLength = maxLength;
+                throw;
+            }
+        }
 
-            this->table[code] = value;
+        // Sorted by their bits aligned to the left, a code that is a prefix of another comes right before
+        // it or before a code it is also a prefix of, so checking neighbours is enough.
+        void CheckPrefixes() const
+        {
+            std::vector<details::Code> sorted(this->codes);
 
-            this->maxLength = std::max(this->maxLength, code.length);
+            std::sort(sorted.begin(), sorted.end(), [](const details::Code& c1, const details::Code& c2)
+            {
+                auto bits1 = static_cast<uint64_t>(c1.bits) << (32 - c1.length);
+                auto bits2 = static_cast<uint64_t>(c2.bits) << (32 - c2.length);
+
+                return (bits1 < bits2) || ((bits1 == bits2) && (c1.length < c2.length));
+            });
+
+            for (size_t i = 1; i < sorted.size(); i++)
+            {
+                const auto& prefix = sorted[i - 1];
+                const auto& code = sorted[i];
+
+                if (prefix == code)
+                {
+                    throw std::logic_error("Duplicate code: " + CodeToString(code));
+                }
+
+                if ((prefix.length < code.length) && ((code.bits >> (code.length - prefix.length)) == prefix.bits))
+                {
+                    throw std::logic_error("Code " + CodeToString(code) + " conflicts with " + CodeToString(prefix));
+                }
+            }
+        }
+
+        template<typename SymbolAt>
+        void AddCanonical(const std::vector<uint32_t>& codeLengths, SymbolAt symbolAt)
+        {
+            auto codes = details::CanonicalCodes(codeLengths);
+
+            // Canonical codes are prefix-free by construction, no need to check them.
+            for (size_t i = 0; i < codes.size(); i++)
+            {
+                if (codes[i].length > 0)
+                {
+                    this->AddCode(codes[i], symbolAt(i));
+                }
+            }
+
+            this->BuildTables(false);
+        }
+
+        void BuildTables(bool check = true)
+        {
+            if (check)
+            {
+                this->CheckPrefixes();
+            }
+
+            std::vector<details::Code> suffixes(this->codes);
+            std::vector<uint32_t> indices(this->codes.size());
+
+            for (size_t i = 0; i < indices.size(); i++)
+            {
+                indices[i] = static_cast<uint32_t>(i);
+            }
+
+            this->table.clear();
+            this->levels.clear();
+            this->primaryBits = std::min(this->maxLength, TABLE_BITS);
+
+            if (this->primaryBits > 0)
+            {
+                this->BuildTable(suffixes, indices, this->primaryBits);
+            }
+
+            this->lsbTable.resize(this->table.size());
+
+            for (const auto& level : this->levels)
+            {
+                for (uint32_t i = 0; i < (1u << level.second); i++)
+                {
+                    this->lsbTable[level.first + details::ReverseBits(i, level.second)] = this->table[level.first + i];
+                }
+            }
+        }
+
+        uint32_t BuildTable(const std::vector<details::Code>& suffixes, const std::vector<uint32_t>& indices, uint32_t width)
+        {
+            auto offset = static_cast<uint32_t>(this->table.size());
+            this->table.resize(offset + (1 << width), 0);
+            this->levels.push_back(std::make_pair(offset, width));
+
+            std::map<uint32_t, std::pair<std::vector<details::Code>, std::vector<uint32_t>>> longer;
+
+            for (size_t i = 0; i < suffixes.size(); i++)
+            {
+                const auto& suffix = suffixes[i];
+
+                if (suffix.length <= width)
+                {
+                    auto first = suffix.bits << (width - suffix.length);
+                    auto count = 1u << (width - suffix.length);
+
+                    std::fill_n(
+                        this->table.begin() + offset + first,
+                        count,
+                        details::TableEntry::Symbol(indices[i], suffix.length));
+                }
+                else
+                {
+                    auto rest = suffix.length - width;
+                    auto& group = longer[suffix.bits >> rest];
+
+                    group.first.push_back({ suffix.bits & ((1u << rest) - 1), rest });
+                    group.second.push_back(indices[i]);
+                }
+            }
+
+            for (const auto& pair : longer)
+            {
+                uint32_t subLength = 0;
+                for (const auto& suffix : pair.second.first)
+                {
+                    subLength = std::max(subLength, suffix.length);
+                }
+
+                auto subBits = std::min(subLength, TABLE_BITS);
+                auto subOffset = this->BuildTable(pair.second.first, pair.second.second, subBits);
+
+                this->table[offset + pair.first] = details::TableEntry::Link(subOffset, width, subBits);
+            }
+
+            return offset;
         }
 
         details::Code CodeFromString(const char* str)
@@ -193,4 +550,7 @@ namespace ccb { namespace binary
         }
 
     };
+
+    template <typename T>
+    const uint32_t HuffmanDecoder<T>::TABLE_BITS;
 } }
@@ -0,0 +1,270 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ccb/binary/BitOrder.hpp>
+#include <ccb/binary/HuffmanDecoder.hpp>
+
+namespace ccb { namespace binary
+{
+    // Canonical prefix code built from symbol frequencies. Code lengths are limited with the
+    // package-merge algorithm, so the result is optimal among codes no longer than maxLength.
+    template <typename T>
+    class HuffmanEncoder
+    {
+    private:
+
+        struct Entry
+        {
+            details::Code code;
+
+            // The code with its bits reversed, for LSB-first streams.
+            uint32_t reversedBits;
+        };
+
+        std::vector<T> symbols;
+
+        std::vector<uint32_t> lengths;
+
+        std::unordered_map<T, Entry> entries;
+
+    public:
+
+        HuffmanEncoder()
+        {
+        }
+
+    public:
+
+        // Symbols with zero frequency get no code.
+        static HuffmanEncoder<T> FromFrequencies(const std::vector<std::pair<T, uint64_t>>& frequencies, uint32_t maxLength = 15)
+        {
+            std::vector<uint64_t> weights;
+            weights.reserve(frequencies.size());
+
+            for (const auto& pair : frequencies)
+            {
+                weights.push_back(pair.second);
+            }
+
+            auto lengths = BuildCodeLengths(weights, maxLength);
+
+            HuffmanEncoder<T> result;
+
+            for (size_t i = 0; i < frequencies.size(); i++)
+            {
+                result.symbols.push_back(frequencies[i].first);
+                result.lengths.push_back(lengths[i]);
+            }
+
+            result.BuildCodes();
+
+            return result;
+        }
+
+        static HuffmanEncoder<T> FromCodeLengths(const std::vector<std::pair<T, uint32_t>>& codeLengths)
+        {
+            HuffmanEncoder<T> result;
+
+            for (const auto& pair : codeLengths)
+            {
+                result.symbols.push_back(pair.first);
+                result.lengths.push_back(pair.second);
+            }
+
+            result.BuildCodes();
+
+            return result;
+        }
+
+        // Package-merge: returns code lengths (zero for zero weights) with no length above maxLength.
+        static std::vector<uint32_t> BuildCodeLengths(const std::vector<uint64_t>& weights, uint32_t maxLength)
+        {
+            std::vector<uint32_t> result(weights.size(), 0);
+
+            // Nodes are either leaves (symbol index) or packages of two nodes from the previous list.
+            struct Node
+            {
+                uint64_t weight;
+
+                int64_t symbol;
+
+                size_t left;
+
+                size_t right;
+            };
+
+            std::vector<Node> nodes;
+            std::vector<size_t> leaves;
+
+            for (size_t i = 0; i < weights.size(); i++)
+            {
+                if (weights[i] > 0)
+                {
+                    nodes.push_back(Node { weights[i], static_cast<int64_t>(i), 0, 0 });
+                    leaves.push_back(nodes.size() - 1);
+                }
+            }
+
+            if (leaves.size() == 0)
+            {
+                return result;
+            }
+
+            if (leaves.size() == 1)
+            {
+                result[nodes[leaves[0]].symbol] = 1;
+                return result;
+            }
+
+            if ((maxLength >= 32) || ((static_cast<uint64_t>(1) << maxLength) < leaves.size()))
+            {
+                throw std::logic_error("Maximum code length is too small for the number of symbols");
+            }
+
+            std::stable_sort(
+                leaves.begin(),
+                leaves.end(),
+                [&nodes](size_t n1, size_t n2) { return nodes[n1].weight < nodes[n2].weight; });
+
+            auto list = leaves;
+
+            for (uint32_t level = 1; level < maxLength; level++)
+            {
+                std::vector<size_t> packages;
+                packages.reserve(list.size() / 2);
+
+                for (size_t i = 0; i + 1 < list.size(); i += 2)
+                {
+                    nodes.push_back(Node { nodes[list[i]].weight + nodes[list[i + 1]].weight, -1, list[i], list[i + 1] });
+                    packages.push_back(nodes.size() - 1);
+                }
+
+                list.clear();
+                std::merge(
+                    leaves.begin(),
+                    leaves.end(),
+                    packages.begin(),
+                    packages.end(),
+                    std::back_inserter(list),
+                    [&nodes](size_t n1, size_t n2) { return nodes[n1].weight < nodes[n2].weight; });
+            }
+
+            // Every appearance of a leaf among the first 2n-2 items adds one to its code length.
+            std::vector<size_t> stack(list.begin(), list.begin() + 2 * (leaves.size() - 1));
+
+            while (!stack.empty())
+            {
+                const auto& node = nodes[stack.back()];
+                stack.pop_back();
+
+                if (node.symbol >= 0)
+                {
+                    result[node.symbol]++;
+                }
+                else
+                {
+                    stack.push_back(node.left);
+                    stack.push_back(node.right);
+                }
+            }
+
+            return result;
+        }
+
+    public:
+
+        uint32_t GetLength(const T& symbol) const
+        {
+            return this->Find(symbol).code.length;
+        }
+
+        const details::Code& GetCode(const T& symbol) const
+        {
+            return this->Find(symbol).code;
+        }
+
+        std::vector<std::pair<T, uint32_t>> GetCodeLengths() const
+        {
+            std::vector<std::pair<T, uint32_t>> result;
+
+            for (size_t i = 0; i < this->symbols.size(); i++)
+            {
+                result.push_back(std::make_pair(this->symbols[i], this->lengths[i]));
+            }
+
+            return result;
+        }
+
+        HuffmanDecoder<T> CreateDecoder() const
+        {
+            return HuffmanDecoder<T>(this->lengths, this->symbols);
+        }
+
+        template<typename BitStream>
+        void Write(BitStream& bitstream, const T& symbol) const
+        {
+            const auto& entry = this->Find(symbol);
+
+            bitstream.Write(
+                details::IsLsbFirst<BitStream>::value ? entry.reversedBits : entry.code.bits,
+                entry.code.length);
+        }
+
+    private:
+
+        const Entry& Find(const T& symbol) const
+        {
+            auto pos = this->entries.find(symbol);
+            if (pos == this->entries.end())
+            {
+                throw std::runtime_error("Symbol has no code");
+            }
+
+            return pos->second;
+        }
+
+        void BuildCodes()
+        {
+            auto codes = details::CanonicalCodes(this->lengths);
+
+            this->entries.clear();
+
+            for (size_t i = 0; i < codes.size(); i++)
+            {
+                if (codes[i].length > 0)
+                {
+                    this->entries[this->symbols[i]] = Entry { codes[i], details::ReverseBits(codes[i].bits, codes[i].length) };
+                }
+            }
+        }
+    };
+} }
@@ -22,84 +22,238 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cassert>
 #include <cstdint>
-#include <iomanip>
+#include <cstring>
+#include <memory>
 #include <stdexcept>
 #include <string>
-#include <sstream>
 #include <type_traits>
 #include <vector>
 
+#include <ccb/binary/Endianness.hpp>
+#include <ccb/binary/Hex.hpp>
+#include <ccb/binary/Varint.hpp>
+#include <ccb/filesystem/MappedFile.hpp>
+
 namespace ccb { namespace binary
 {
+    /// Reads binary data from a memory block, which is either owned by the stream, borrowed from the
+    /// caller or mapped from a file. Checked reads stop at the end of data; unchecked ones leave bounds
+    /// checking to the caller, who normally tests GetRemaining() once for a whole record.
     class InputBinaryStream
     {
     private:
 
         std::vector<uint8_t> bytes;
 
-        size_t pos = 0;
+        std::shared_ptr<filesystem::MappedFile> file;
+
+        const uint8_t* begin;
+
+        const uint8_t* cur;
+
+        const uint8_t* end;
 
     public:
 
         InputBinaryStream(std::vector<uint8_t>&& bytes)
-            : bytes(bytes)
+            : bytes(std::move(bytes))
+            , begin(this->bytes.data())
+            , cur(this->bytes.data())
+            , end(this->bytes.data() + this->bytes.size())
         {
         }
 
-    public:
+        /// Borrows the data, which must outlive the stream.
+        InputBinaryStream(const void* data, size_t size)
+            : begin(static_cast<const uint8_t*>(data))
+            , cur(static_cast<const uint8_t*>(data))
+            , end(static_cast<const uint8_t*>(data) + size)
+        {
+        }
 
-        bool End() const
+        /// Reads from a mapped file; copies of the stream share the mapping.
+        InputBinaryStream(const std::shared_ptr<filesystem::MappedFile>& file)
+            : file(file)
+            , begin(file->GetData())
+            , cur(file->GetData())
+            , end(file->GetData() + file->GetSize())
         {
-            return this->pos >= this->bytes.size();
         }
 
-        template<typename T>
-        friend typename std::enable_if<std::is_arithmetic<T>::value, InputBinaryStream&>::type
-        operator >> (InputBinaryStream& stream, T& value)
+        /// A copy of an owning stream reads its own copy of the data, at the same position.
+        InputBinaryStream(const InputBinaryStream& other)
+            : bytes(other.bytes)
+            , file(other.file)
+            , begin(other.begin)
+            , cur(other.cur)
+            , end(other.end)
         {
-            auto ptr = reinterpret_cast<uint8_t*>(&value);
-            for (size_t i = 0; (i < sizeof(T)) && (stream.pos < stream.bytes.size()); i++)
+            if (other.begin == other.bytes.data())
             {
-                *(ptr++) = stream.bytes[stream.pos++];
+                this->begin = this->bytes.data();
+                this->cur = this->begin + other.GetPosition();
+                this->end = this->begin + other.GetSize();
             }
+        }
 
-            return stream;
+        // Moving a vector keeps its buffer, so the pointers stay valid.
+        InputBinaryStream(InputBinaryStream&& other) = default;
+
+        InputBinaryStream& operator = (const InputBinaryStream& other)
+        {
+            InputBinaryStream copy(other);
+
+            return *this = std::move(copy);
         }
 
+        InputBinaryStream& operator = (InputBinaryStream&& other) = default;
+
     public:
 
-        static InputBinaryStream FromHex(const std::string& hex)
+        bool End() const
         {
-            std::vector<uint8_t> bytes;
+            return this->cur >= this->end;
+        }
 
-            for (size_t i = 0; i < hex.size(); i += 2)
-            {
-                uint8_t v = (FromHex(hex[i]) << 4) | FromHex(hex[i+1]);
-                bytes.push_back(v);
-            }
+        size_t GetSize() const
+        {
+            return this->end - this->begin;
+        }
 
-            return InputBinaryStream(std::move(bytes));
+        size_t GetPosition() const
+        {
+            return this->cur - this->begin;
         }
 
-    private:
+        size_t GetRemaining() const
+        {
+            return this->end - this->cur;
+        }
 
-        static uint8_t FromHex(char c)
+        /// Copies up to size bytes, returns the number of bytes copied.
+        size_t Read(void* dest, size_t size)
         {
-            c = tolower(c);
+            size = std::min(size, this->GetRemaining());
 
-            if ((c >= '0') && (c <= '9'))
+            if (size > 0)
             {
-                return c - '0';
+                memcpy(dest, this->cur, size);
+                this->cur += size;
             }
-            else if ((c >= 'a') && (c <= 'f'))
+
+            return size;
+        }
+
+        void ReadUnchecked(void* dest, size_t size)
+        {
+            assert (size <= this->GetRemaining());
+
+            memcpy(dest, this->cur, size);
+            this->cur += size;
+        }
+
+        template<typename T>
+        T ReadUnchecked()
+        {
+            static_assert(std::is_arithmetic<T>::value, "Only arithmetic types can be read");
+
+            T value;
+            this->ReadUnchecked(&value, sizeof(T));
+
+            return value;
+        }
+
+        /// Reads a big-endian value; throws if the stream has fewer than sizeof(T) bytes left.
+        template<typename T>
+        T ReadBE()
+        {
+            return LoadBE<T>(this->ReadSpan(sizeof(T)));
+        }
+
+        /// Reads a little-endian value; throws if the stream has fewer than sizeof(T) bytes left.
+        template<typename T>
+        T ReadLE()
+        {
+            return LoadLE<T>(this->ReadSpan(sizeof(T)));
+        }
+
+        /// Reads an unsigned LEB128 varint; throws std::runtime_error if it is truncated or too long.
+        uint64_t ReadVarint()
+        {
+            uint64_t value;
+            this->cur = DecodeVarint(this->cur, this->end, value);
+
+            return value;
+        }
+
+        /// Reads a zigzag-encoded signed varint.
+        int64_t ReadSignedVarint()
+        {
+            return ZigZagDecode(this->ReadVarint());
+        }
+
+        /// Reads count consecutive varints into an array of unsigned integers.
+        template<typename T>
+        void ReadVarints(T* dest, size_t count)
+        {
+            this->cur = DecodeVarints(this->cur, this->end, dest, count);
+        }
+
+        /// Reads a string prefixed with its varint length.
+        std::string ReadString()
+        {
+            auto size = this->ReadVarint();
+            if (size > this->GetRemaining())
             {
-                return (c - 'a') + 10;
+                throw std::out_of_range("Not enough data in the stream");
             }
-            else
+
+            auto data = reinterpret_cast<const char*>(this->ReadSpan(static_cast<size_t>(size)));
+
+            return std::string(data, data + size);
+        }
+
+        /// Returns a pointer to the next size bytes without copying them and skips over them.
+        const uint8_t* ReadSpan(size_t size)
+        {
+            if (size > this->GetRemaining())
             {
-                throw std::invalid_argument(std::string("Not a hex symbol: ") + c);
+                throw std::out_of_range("Not enough data in the stream");
             }
+
+            auto result = this->cur;
+            this->cur += size;
+
+            return result;
+        }
+
+        void Skip(size_t size)
+        {
+            this->cur += std::min(size, this->GetRemaining());
+        }
+
+        template<typename T>
+        friend typename std::enable_if<std::is_arithmetic<T>::value, InputBinaryStream&>::type
+        operator >> (InputBinaryStream& stream, T& value)
+        {
+            stream.Read(&value, sizeof(T));
+
+            return stream;
+        }
+
+    public:
+
+        static InputBinaryStream FromFile(const filesystem::Path& path)
+        {
+            return InputBinaryStream(std::make_shared<filesystem::MappedFile>(path));
+        }
+
+        static InputBinaryStream FromHex(const std::string& hex)
+        {
+            return InputBinaryStream(binary::FromHex(hex));
         }
     };
 } }
@@ -0,0 +1,284 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <ccb/binary/BitOrder.hpp>
+#include <ccb/binary/Endianness.hpp>
+
+namespace ccb { namespace binary
+{
+    namespace details
+    {
+        template<typename Order>
+        struct BitAccumulator
+        {
+        };
+
+        // Valid bits are kept at the top of the accumulator.
+        template<>
+        struct BitAccumulator<MsbFirst>
+        {
+            static uint64_t Load(const uint8_t* ptr, unsigned count)
+            {
+                return LoadBE<uint64_t>(ptr) >> count;
+            }
+
+            static uint64_t LoadByte(uint8_t byte, unsigned count)
+            {
+                return static_cast<uint64_t>(byte) << (56 - count);
+            }
+
+            static uint64_t Peek(uint64_t bits, unsigned count)
+            {
+                return (count == 0) ? 0 : (bits >> (64 - count));
+            }
+
+            static uint64_t Skip(uint64_t bits, unsigned count)
+            {
+                return (count == 64) ? 0 : (bits << count);
+            }
+        };
+
+        // Valid bits are kept at the bottom of the accumulator.
+        template<>
+        struct BitAccumulator<LsbFirst>
+        {
+            static uint64_t Load(const uint8_t* ptr, unsigned count)
+            {
+                return LoadLE<uint64_t>(ptr) << count;
+            }
+
+            static uint64_t LoadByte(uint8_t byte, unsigned count)
+            {
+                return static_cast<uint64_t>(byte) << count;
+            }
+
+            static uint64_t Peek(uint64_t bits, unsigned count)
+            {
+                return (count == 64) ? bits : (bits & ((static_cast<uint64_t>(1) << count) - 1));
+            }
+
+            static uint64_t Skip(uint64_t bits, unsigned count)
+            {
+                return (count == 64) ? 0 : (bits >> count);
+            }
+        };
+    }
+
+    // Bit reader over contiguous memory. Bits are buffered in a 64-bit accumulator, refilled with a single
+    // unaligned load while at least 8 bytes remain, so up to MAX_PEEK bits can be peeked at a time.
+    // Reading past the end yields zeros; IsGood() and HasBits() tell real data from the padding.
+    template<typename Order>
+    class InputBitReader
+    {
+    public:
+
+        typedef Order BitOrder;
+
+        static const unsigned MAX_PEEK = 57;
+
+    private:
+
+        typedef details::BitAccumulator<Order> Accumulator;
+
+        const uint8_t* begin;
+
+        const uint8_t* cur;
+
+        const uint8_t* end;
+
+        uint64_t bits = 0;
+
+        unsigned count = 0;
+
+        // Zero bits appended to the accumulator after the end of data.
+        unsigned padding = 0;
+
+    public:
+
+        InputBitReader(const void* data, size_t size)
+            : begin(static_cast<const uint8_t*>(data))
+            , cur(static_cast<const uint8_t*>(data))
+            , end(static_cast<const uint8_t*>(data) + size)
+        {
+        }
+
+        InputBitReader(const uint8_t* begin, const uint8_t* end)
+            : begin(begin)
+            , cur(begin)
+            , end(end)
+        {
+        }
+
+    public:
+
+        bool IsGood() const
+        {
+            return this->GetBitsLeft() > 0;
+        }
+
+        operator bool () const
+        {
+            return this->IsGood();
+        }
+
+        int64_t GetBitsLeft() const
+        {
+            return static_cast<int64_t>(this->end - this->cur) * 8 + this->count - this->padding;
+        }
+
+        // Number of bits consumed since the beginning of data.
+        uint64_t GetBitPosition() const
+        {
+            return static_cast<uint64_t>(this->cur - this->begin) * 8 + this->padding - this->count;
+        }
+
+        bool HasBits(unsigned count) const
+        {
+            return this->GetBitsLeft() >= static_cast<int64_t>(count);
+        }
+
+        // Returns the next count (up to MAX_PEEK) bits without consuming them. In MSB-first order the
+        // first bit is the most significant bit of the result, in LSB-first order it is the least significant.
+        uint64_t Peek(unsigned count)
+        {
+            assert (count <= MAX_PEEK);
+
+            if (this->count < count)
+            {
+                this->Refill();
+            }
+
+            return Accumulator::Peek(this->bits, count);
+        }
+
+        void Skip(unsigned count)
+        {
+            while (count > this->count)
+            {
+                count -= this->count;
+                this->bits = 0;
+                this->count = 0;
+                this->Refill();
+            }
+
+            this->bits = Accumulator::Skip(this->bits, count);
+            this->count -= count;
+        }
+
+        uint64_t Read(unsigned count)
+        {
+            auto result = this->Peek(count);
+            this->Skip(count);
+            return result;
+        }
+
+        bool Read()
+        {
+            return this->Read(1) != 0;
+        }
+
+        InputBitReader<Order>& operator >> (bool& value)
+        {
+            value = this->Read();
+
+            return *this;
+        }
+
+        // Drops the bits remaining in the current byte.
+        void AlignToByte()
+        {
+            this->Skip(this->count & 7);
+        }
+
+        // Copies whole bytes; the reader must be aligned to a byte boundary. Returns the number of bytes copied.
+        size_t ReadBytes(void* dest, size_t size)
+        {
+            assert ((this->count & 7) == 0);
+
+            auto out = static_cast<uint8_t*>(dest);
+            size_t copied = 0;
+
+            while ((copied < size) && (this->count > this->padding))
+            {
+                out[copied++] = static_cast<uint8_t>(this->Read(8));
+            }
+
+            auto tail = std::min(size - copied, static_cast<size_t>(this->end - this->cur));
+            memcpy(out + copied, this->cur, tail);
+            this->cur += tail;
+
+            if (tail > 0)
+            {
+                this->bits = 0;
+            }
+
+            return copied + tail;
+        }
+
+    private:
+
+        void Refill()
+        {
+            assert (this->count <= 56);
+
+            if (this->end - this->cur >= 8)
+            {
+                // Bits past the counted ones get filled too, but with the same data the next load ORs in.
+                auto bytes = (64 - this->count) >> 3;
+
+                this->bits |= Accumulator::Load(this->cur, this->count);
+                this->cur += bytes;
+                this->count += bytes * 8;
+                return;
+            }
+
+            while (this->count <= 56)
+            {
+                uint8_t byte = 0;
+
+                if (this->cur < this->end)
+                {
+                    byte = *this->cur++;
+                }
+                else
+                {
+                    this->padding += 8;
+                }
+
+                this->bits |= Accumulator::LoadByte(byte, this->count);
+                this->count += 8;
+            }
+        }
+    };
+
+    typedef InputBitReader<MsbFirst> MsbInputBitReader;
+
+    typedef InputBitReader<LsbFirst> LsbInputBitReader;
+} }
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <cstdint>
+#include <iterator>
 #include <type_traits>
 
 namespace ccb { namespace binary
@@ -33,7 +35,9 @@ namespace ccb { namespace binary
 
         using Bits = typename std::make_unsigned<T>::type;
 
-        static const Bits BIT_MASK = 1 << (sizeof(T) * 8 - 1);
+        static const unsigned UNIT_BITS = sizeof(T) * 8;
+
+        static const Bits BIT_MASK = static_cast<Bits>(1) << (UNIT_BITS - 1);
 
         Bits value;
 
@@ -43,6 +47,13 @@ namespace ccb { namespace binary
 
         Iter end;
 
+        // Look-ahead copies the iterator and reads past the current position, which a single-pass
+        // input iterator can't do.
+        template<typename I>
+        using EnableIfForward = typename std::enable_if<std::is_base_of<
+            std::forward_iterator_tag,
+            typename std::iterator_traits<I>::iterator_category>::value>::type;
+
     public:
 
         InputBitStream(Iter begin, Iter end)
@@ -86,6 +97,72 @@ namespace ccb { namespace binary
             return *this;
         }
 
+        // Returns the next count (up to 32) bits without consuming them, first bit in the most significant
+        // position. Bits past the end of the stream read as zeros. Peek and HasBits are available only for
+        // forward iterators; over input iterators a decoder falls back to reading bit by bit.
+        template<typename I = Iter, typename = EnableIfForward<I>>
+        uint32_t Peek(unsigned count) const
+        {
+            uint64_t bits = 0;
+            unsigned available = 0;
+
+            if (this->cur != this->end)
+            {
+                bits = static_cast<uint64_t>(this->value >> (UNIT_BITS - this->bitCount));
+                available = this->bitCount;
+
+                auto pos = this->cur;
+                while ((available < count) && (++pos != this->end))
+                {
+                    // Take only the bits still needed: count is at most 32, so neither shift reaches the width
+                    // of the accumulator or of a 64-bit unit.
+                    auto take = (count - available < UNIT_BITS) ? count - available : UNIT_BITS;
+
+                    bits = (bits << take) | static_cast<uint64_t>(static_cast<Bits>(*pos) >> (UNIT_BITS - take));
+                    available += take;
+                }
+            }
+
+            bits = (available >= count) ? (bits >> (available - count)) : (bits << (count - available));
+
+            return static_cast<uint32_t>(bits & ((static_cast<uint64_t>(1) << count) - 1));
+        }
+
+        template<typename I = Iter, typename = EnableIfForward<I>>
+        bool HasBits(unsigned count) const
+        {
+            if (this->cur == this->end)
+            {
+                return count == 0;
+            }
+
+            unsigned available = this->bitCount;
+
+            auto pos = this->cur;
+            while ((available < count) && (++pos != this->end))
+            {
+                available += UNIT_BITS;
+            }
+
+            return available >= count;
+        }
+
+        void Skip(unsigned count)
+        {
+            while ((count > 0) && (this->cur != this->end))
+            {
+                if (count < static_cast<unsigned>(this->bitCount))
+                {
+                    this->value <<= count;
+                    this->bitCount -= count;
+                    return;
+                }
+
+                count -= this->bitCount;
+                this->Next();
+            }
+        }
+
     private:
 
         void Next()
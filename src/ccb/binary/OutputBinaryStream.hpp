@@ -23,46 +23,273 @@
 #pragma once
 
 #include <cstdint>
-#include <iomanip>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
 #include <string>
-#include <sstream>
 #include <type_traits>
 #include <vector>
 
+#include <ccb/binary/Endianness.hpp>
+#include <ccb/binary/Hex.hpp>
+#include <ccb/binary/Varint.hpp>
+#include <ccb/filesystem/Path.hpp>
+
 namespace ccb { namespace binary
 {
+    /// Binary writer. By default everything accumulates in memory and can be taken out with Data() or
+    /// Release(). With a sink, data is buffered up to the chunk size and then written out, so only
+    /// one chunk is ever resident; the destructor writes out whatever is left.
     class OutputBinaryStream
     {
+    public:
+
+        static const size_t DEFAULT_CHUNK_SIZE = 65536;
+
     private:
 
         std::vector<uint8_t> bytes;
 
+        std::unique_ptr<std::ofstream> file;
+
+        std::ostream* sink = nullptr;
+
+        size_t chunkSize = 0;
+
+        uint64_t flushed = 0;
+
     public:
 
-        std::string GetHex() const
+        OutputBinaryStream()
+        {
+        }
+
+        OutputBinaryStream(std::ostream& sink, size_t chunkSize = DEFAULT_CHUNK_SIZE)
+            : sink(&sink)
+            , chunkSize(chunkSize)
+        {
+            this->bytes.reserve(chunkSize);
+        }
+
+        /// Only in-memory streams can be copied; a sink can't be shared.
+        OutputBinaryStream(const OutputBinaryStream& other)
+            : bytes(other.bytes)
+            , chunkSize(other.chunkSize)
+            , flushed(other.flushed)
+        {
+            if (other.sink != nullptr)
+            {
+                throw std::logic_error("Cannot copy a stream writing into a sink");
+            }
+        }
+
+        OutputBinaryStream(OutputBinaryStream&& other)
+            : bytes(std::move(other.bytes))
+            , file(std::move(other.file))
+            , sink(other.sink)
+            , chunkSize(other.chunkSize)
+            , flushed(other.flushed)
+        {
+            other.sink = nullptr;
+        }
+
+        ~OutputBinaryStream()
+        {
+            // A sink with exceptions enabled must not escape the destructor; errors are only reported
+            // by an explicit Flush().
+            try
+            {
+                this->Flush();
+            }
+            catch (...)
+            {
+            }
+        }
+
+        OutputBinaryStream& operator = (const OutputBinaryStream& other)
+        {
+            OutputBinaryStream copy(other);
+
+            return *this = std::move(copy);
+        }
+
+        /// Writes out what is left for the current sink before taking over the other stream.
+        OutputBinaryStream& operator = (OutputBinaryStream&& other)
+        {
+            if (this != &other)
+            {
+                this->Flush();
+
+                this->bytes = std::move(other.bytes);
+                this->file = std::move(other.file);
+                this->sink = other.sink;
+                this->chunkSize = other.chunkSize;
+                this->flushed = other.flushed;
+
+                other.sink = nullptr;
+            }
+
+            return *this;
+        }
+
+    public:
+
+        /// Total number of bytes written, including the ones already flushed to the sink.
+        uint64_t GetSize() const
+        {
+            return this->flushed + this->bytes.size();
+        }
+
+        /// Bytes not yet flushed; in memory mode this is all of the data.
+        const uint8_t* Data() const
+        {
+            return this->bytes.data();
+        }
+
+        void Reserve(size_t size)
+        {
+            this->bytes.reserve(size);
+        }
+
+        /// Moves the accumulated data out, leaving the stream empty.
+        std::vector<uint8_t> Release()
+        {
+            if (this->sink != nullptr)
+            {
+                throw std::logic_error("Cannot release data of a stream writing into a sink");
+            }
+
+            std::vector<uint8_t> result;
+            result.swap(this->bytes);
+
+            return result;
+        }
+
+        void Write(const void* data, size_t size)
         {
-            std::ostringstream stream;
-            for (auto b : this->bytes)
+            if ((this->sink != nullptr) && (size >= this->chunkSize))
             {
-                stream << std::hex << std::setw(2) << std::setfill('0') << (int)b;
+                // Large blocks go to the sink directly instead of being copied into the buffer first.
+                this->Flush();
+                this->WriteToSink(data, size);
+                return;
             }
 
-            return stream.str();
+            if ((this->sink != nullptr) && (this->bytes.size() + size > this->chunkSize))
+            {
+                this->Flush();
+            }
+
+            // Appending directly skips the zero fill that Extend() pays for in resize().
+            auto bytes = static_cast<const uint8_t*>(data);
+            this->bytes.insert(this->bytes.end(), bytes, bytes + size);
+        }
+
+        template<typename T>
+        void WriteBE(T value)
+        {
+            StoreBE(this->Extend(sizeof(T)), value);
+        }
+
+        template<typename T>
+        void WriteLE(T value)
+        {
+            StoreLE(this->Extend(sizeof(T)), value);
+        }
+
+        void WriteVarint(uint64_t value)
+        {
+            uint8_t buffer[MAX_VARINT_SIZE];
+
+            this->Write(buffer, EncodeVarint(value, buffer));
+        }
+
+        void WriteSignedVarint(int64_t value)
+        {
+            this->WriteVarint(ZigZagEncode(value));
+        }
+
+        /// Writes data prefixed with its varint length.
+        void WriteString(const void* data, size_t size)
+        {
+            this->WriteVarint(size);
+            this->Write(data, size);
+        }
+
+        void WriteString(const std::string& value)
+        {
+            this->WriteString(value.data(), value.size());
+        }
+
+        /// Writes the buffered data to the sink; does nothing in memory mode.
+        void Flush()
+        {
+            if ((this->sink != nullptr) && !this->bytes.empty())
+            {
+                this->WriteToSink(this->bytes.data(), this->bytes.size());
+                this->bytes.clear();
+            }
+        }
+
+        std::string GetHex() const
+        {
+            return ToHex(this->bytes.data(), this->bytes.size());
         }
 
         template<typename T>
         friend typename std::enable_if<std::is_arithmetic<T>::value, OutputBinaryStream&>::type
         operator << (OutputBinaryStream& stream, T value)
         {
-            auto ptr = reinterpret_cast<uint8_t*>(&value);
-            for (size_t i = 0; i < sizeof(T); i++)
+            memcpy(stream.Extend(sizeof(T)), &value, sizeof(T));
+
+            return stream;
+        }
+
+    public:
+
+        static OutputBinaryStream ToFile(const filesystem::Path& path, size_t chunkSize = DEFAULT_CHUNK_SIZE)
+        {
+            std::unique_ptr<std::ofstream> file(new std::ofstream(path.ToShortString(), std::ios::binary | std::ios::trunc));
+
+            if (!file->is_open())
             {
-                stream.bytes.push_back(*ptr);
-                ptr++;
+                throw std::runtime_error("Cannot open file " + path.ToShortString());
             }
 
-            return stream;
+            OutputBinaryStream result(*file, chunkSize);
+            result.file = std::move(file);
+
+            return result;
+        }
+
+    private:
+
+        /// Appends size bytes to the buffer and returns a pointer to them, flushing first if they do not fit into the chunk.
+        uint8_t* Extend(size_t size)
+        {
+            if ((this->sink != nullptr) && (this->bytes.size() + size > this->chunkSize))
+            {
+                this->Flush();
+            }
+
+            auto pos = this->bytes.size();
+            this->bytes.resize(pos + size);
+
+            return this->bytes.data() + pos;
+        }
+
+        void WriteToSink(const void* data, size_t size)
+        {
+            this->sink->write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+
+            if (!*this->sink)
+            {
+                throw std::runtime_error("Cannot write to output stream");
+            }
+
+            this->flushed += size;
         }
     };
 } }
-
@@ -0,0 +1,228 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <ccb/binary/BitOrder.hpp>
+#include <ccb/binary/Endianness.hpp>
+
+namespace ccb { namespace binary
+{
+    namespace details
+    {
+        template<typename Order>
+        struct BitPacker
+        {
+        };
+
+        // Pending bits are kept at the top of the accumulator.
+        template<>
+        struct BitPacker<MsbFirst>
+        {
+            static uint64_t Put(uint64_t bits, unsigned count, uint64_t value, unsigned length)
+            {
+                return bits | (value << (64 - count - length));
+            }
+
+            static void Store(uint8_t* dest, uint64_t bits)
+            {
+                StoreBE(dest, bits);
+            }
+
+            static uint64_t Drop(uint64_t bits, unsigned count)
+            {
+                return (count == 64) ? 0 : (bits << count);
+            }
+        };
+
+        // Pending bits are kept at the bottom of the accumulator.
+        template<>
+        struct BitPacker<LsbFirst>
+        {
+            static uint64_t Put(uint64_t bits, unsigned count, uint64_t value, unsigned /*length*/)
+            {
+                return bits | (value << count);
+            }
+
+            static void Store(uint8_t* dest, uint64_t bits)
+            {
+                StoreLE(dest, bits);
+            }
+
+            static uint64_t Drop(uint64_t bits, unsigned count)
+            {
+                return (count == 64) ? 0 : (bits >> count);
+            }
+        };
+    }
+
+    // Bit writer counterpart of InputBitReader. Bits collect in a 64-bit accumulator, which is stored
+    // to the byte buffer with a single 8-byte write only when the next value would not fit.
+    template<typename Order>
+    class OutputBitStream
+    {
+    public:
+
+        typedef Order BitOrder;
+
+        static const unsigned MAX_WRITE = 57;
+
+    private:
+
+        typedef details::BitPacker<Order> Packer;
+
+        std::vector<uint8_t> bytes;
+
+        size_t size = 0;
+
+        uint64_t bits = 0;
+
+        unsigned count = 0;
+
+    public:
+
+        OutputBitStream()
+        {
+        }
+
+    public:
+
+        // Writes the count (up to MAX_WRITE) lowest bits of value. In MSB-first order the most significant
+        // of them goes first, in LSB-first order the least significant one does.
+        void Write(uint64_t value, unsigned count)
+        {
+            assert (count <= MAX_WRITE);
+            assert ((value >> count) == 0);
+
+            if (count == 0)
+            {
+                return;
+            }
+
+            if (this->count + count > 64)
+            {
+                this->FlushWholeBytes();
+            }
+
+            this->bits = Packer::Put(this->bits, this->count, value, count);
+            this->count += count;
+        }
+
+        void Write(bool bit)
+        {
+            this->Write(bit ? 1 : 0, 1);
+        }
+
+        OutputBitStream<Order>& operator << (bool bit)
+        {
+            this->Write(bit);
+
+            return *this;
+        }
+
+        // Pads the current byte with zero bits.
+        void AlignToByte()
+        {
+            this->count = (this->count + 7) & ~7u;
+        }
+
+        // Appends whole bytes; the stream must be aligned to a byte boundary.
+        void WriteBytes(const void* data, size_t size)
+        {
+            assert ((this->count & 7) == 0);
+
+            this->FlushWholeBytes();
+
+            this->bytes.resize(this->size + size + sizeof(uint64_t));
+            memcpy(this->bytes.data() + this->size, data, size);
+            this->size += size;
+        }
+
+        uint64_t GetBitCount() const
+        {
+            return static_cast<uint64_t>(this->size) * 8 + this->count;
+        }
+
+        // Copy of the bytes written so far, the last one padded with zeros. The stream itself is left as it
+        // is, so writing can go on without a gap.
+        std::vector<uint8_t> GetBytes() const
+        {
+            std::vector<uint8_t> result(this->size + sizeof(uint64_t));
+            if (this->size > 0)
+            {
+                memcpy(result.data(), this->bytes.data(), this->size);
+            }
+
+            Packer::Store(result.data() + this->size, this->bits);
+            result.resize(this->size + ((this->count + 7) >> 3));
+
+            return result;
+        }
+
+        std::vector<uint8_t> Release()
+        {
+            this->Flush();
+
+            std::vector<uint8_t> result;
+            result.swap(this->bytes);
+            this->size = 0;
+
+            return result;
+        }
+
+    private:
+
+        void Flush()
+        {
+            this->AlignToByte();
+            this->FlushWholeBytes();
+            this->bytes.resize(this->size);
+        }
+
+        void FlushWholeBytes()
+        {
+            // Keep room for a full 8-byte store past the logical end, so stores never need a bounds check.
+            if (this->bytes.size() < this->size + sizeof(uint64_t))
+            {
+                this->bytes.resize(std::max(this->bytes.size() * 2, this->size + sizeof(uint64_t)));
+            }
+
+            Packer::Store(this->bytes.data() + this->size, this->bits);
+
+            auto wholeBytes = this->count >> 3;
+
+            this->size += wholeBytes;
+            this->bits = Packer::Drop(this->bits, wholeBytes * 8);
+            this->count -= wholeBytes * 8;
+        }
+    };
+
+    typedef OutputBitStream<MsbFirst> MsbOutputBitStream;
+
+    typedef OutputBitStream<LsbFirst> LsbOutputBitStream;
+} }
@@ -0,0 +1,256 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include <ccb/binary/Endianness.hpp>
+
+namespace ccb { namespace binary
+{
+    /// Longest LEB128 encoding of a 64-bit value.
+    const size_t MAX_VARINT_SIZE = 10;
+
+    inline uint64_t ZigZagEncode(int64_t value)
+    {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    inline int64_t ZigZagDecode(uint64_t value)
+    {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    /// Writes value as an unsigned LEB128 varint; dest must have room for MAX_VARINT_SIZE bytes.
+    /// Returns the number of bytes written.
+    inline size_t EncodeVarint(uint64_t value, uint8_t* dest)
+    {
+        size_t size = 0;
+
+        while (value >= 0x80)
+        {
+            dest[size++] = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+
+        dest[size++] = static_cast<uint8_t>(value);
+
+        return size;
+    }
+
+    inline size_t GetVarintSize(uint64_t value)
+    {
+        size_t size = 1;
+
+        while (value >= 0x80)
+        {
+            value >>= 7;
+            size++;
+        }
+
+        return size;
+    }
+
+    namespace details
+    {
+        inline unsigned CountTrailingZeros(uint64_t value)
+        {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward64(&index, value);
+            return static_cast<unsigned>(index);
+#else
+            return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+        }
+
+        // Decodes a varint with at least MAX_VARINT_SIZE readable bytes at src. Up to 8 bytes are
+        // handled without a branch per byte: the first byte without the continuation bit is found in
+        // a whole word and the 7-bit groups are squeezed together with three shift/mask steps.
+        inline const uint8_t* DecodeVarintUnchecked(const uint8_t* src, uint64_t& value)
+        {
+            auto word = LoadLE<uint64_t>(src);
+            auto stops = ~word & 0x8080808080808080ull;
+
+            if (stops != 0)
+            {
+                // All bits up to and including the first stop bit.
+                auto bits = word & (stops ^ (stops - 1)) & 0x7f7f7f7f7f7f7f7full;
+
+                bits = ((bits & 0x7f007f007f007f00ull) >> 1) | (bits & 0x007f007f007f007full);
+                bits = ((bits & 0x3fff00003fff0000ull) >> 2) | (bits & 0x00003fff00003fffull);
+                bits = ((bits & 0x0fffffff00000000ull) >> 4) | (bits & 0x000000000fffffffull);
+
+                value = bits;
+                return src + (CountTrailingZeros(stops) + 1) / 8;
+            }
+
+            auto bits = word & 0x7f7f7f7f7f7f7f7full;
+
+            bits = ((bits & 0x7f007f007f007f00ull) >> 1) | (bits & 0x007f007f007f007full);
+            bits = ((bits & 0x3fff00003fff0000ull) >> 2) | (bits & 0x00003fff00003fffull);
+            bits = ((bits & 0x0fffffff00000000ull) >> 4) | (bits & 0x000000000fffffffull);
+
+            value = bits | (static_cast<uint64_t>(src[8] & 0x7f) << 56);
+
+            if ((src[8] & 0x80) == 0)
+            {
+                return src + 9;
+            }
+
+            if (src[9] > 1)
+            {
+                throw std::runtime_error("Varint is too long");
+            }
+
+            value |= static_cast<uint64_t>(src[9]) << 63;
+
+            return src + 10;
+        }
+
+        template<typename T>
+        T NarrowVarint(uint64_t value)
+        {
+            if (value > std::numeric_limits<T>::max())
+            {
+                throw std::runtime_error("Varint value does not fit into the target type");
+            }
+
+            return static_cast<T>(value);
+        }
+    }
+
+    /// Decodes an unsigned LEB128 varint from [src, end); returns the position past it. Throws
+    /// std::runtime_error on truncated or overlong input.
+    inline const uint8_t* DecodeVarint(const uint8_t* src, const uint8_t* end, uint64_t& value)
+    {
+        if (end - src >= static_cast<ptrdiff_t>(MAX_VARINT_SIZE))
+        {
+            return details::DecodeVarintUnchecked(src, value);
+        }
+
+        value = 0;
+
+        for (unsigned shift = 0; src < end; shift += 7)
+        {
+            auto byte = *src++;
+
+            if ((shift == 63) && (byte > 1))
+            {
+                throw std::runtime_error("Varint is too long");
+            }
+
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+
+            if ((byte & 0x80) == 0)
+            {
+                return src;
+            }
+        }
+
+        throw std::runtime_error("Unexpected end of varint");
+    }
+
+    /// Decodes count consecutive varints into dest; returns the position past the last one. Runs of
+    /// single-byte values, common in integer columns, are found a block at a time from the continuation
+    /// bits (16 bytes with SSE2, 8 bytes otherwise) and widened without a branch per value.
+    template<typename T>
+    const uint8_t* DecodeVarints(const uint8_t* src, const uint8_t* end, T* dest, size_t count)
+    {
+        static_assert(std::is_unsigned<T>::value, "Varints decode into unsigned types, use ZigZagDecode for signed ones");
+
+#if defined(__SSE2__) || defined(_M_X64)
+        // Single-byte values before the first continuation bit of a 16-byte block are copied
+        // straight away, then one longer value is decoded. Keep clear of the end for the 16-byte
+        // load and the up to 10-byte read of the value after the copied run.
+        while ((count >= 16) && (end - src >= 32))
+        {
+            auto continuation = static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src))));
+            auto singles = (continuation == 0) ? 16 : details::CountTrailingZeros(continuation);
+
+            for (unsigned i = 0; i < singles; i++)
+            {
+                dest[i] = src[i];
+            }
+
+            src += singles;
+            dest += singles;
+            count -= singles;
+
+            if (singles < 16)
+            {
+                uint64_t value;
+                src = details::DecodeVarintUnchecked(src, value);
+                *dest++ = details::NarrowVarint<T>(value);
+                count--;
+            }
+        }
+#endif
+
+        // Same with 8-byte blocks checked with plain integer arithmetic.
+        while ((count >= 8) && (end - src >= 16))
+        {
+            auto continuation = LoadLE<uint64_t>(src) & 0x8080808080808080ull;
+            auto singles = (continuation == 0) ? 8 : details::CountTrailingZeros(continuation) / 8;
+
+            for (unsigned i = 0; i < singles; i++)
+            {
+                dest[i] = src[i];
+            }
+
+            src += singles;
+            dest += singles;
+            count -= singles;
+
+            if (singles < 8)
+            {
+                uint64_t value;
+                src = details::DecodeVarintUnchecked(src, value);
+                *dest++ = details::NarrowVarint<T>(value);
+                count--;
+            }
+        }
+
+        while (count > 0)
+        {
+            uint64_t value;
+            src = DecodeVarint(src, end, value);
+            *dest++ = details::NarrowVarint<T>(value);
+            count--;
+        }
+
+        return src;
+    }
+} }
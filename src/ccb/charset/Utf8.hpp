@@ -0,0 +1,74 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <string>
+
+#include <ccb/charset/CharsetConverter.hpp>
+
+namespace ccb { namespace charset
+{
+    /// Converts UTF-8 to a wide string. Pure ASCII input is copied without decoding.
+    inline void Utf8ToWide(const char* data, size_t size, std::wstring& result)
+    {
+        result.clear();
+
+        size_t i = 0;
+        while ((i < size) && (static_cast<uint8_t>(data[i]) < 0x80))
+        {
+            i++;
+        }
+
+        if (i == size)
+        {
+            result.assign(data, data + size);
+        }
+        else
+        {
+            CharsetConverter<Encoding::UTF32LE, Encoding::UTF8>().Convert(data, data + size, std::back_inserter(result));
+        }
+    }
+
+    /// Converts a wide string to UTF-8. Pure ASCII input is copied without encoding.
+    inline void WideToUtf8(const wchar_t* data, size_t size, std::string& result)
+    {
+        result.clear();
+
+        size_t i = 0;
+        while ((i < size) && (static_cast<uint32_t>(data[i]) < 0x80))
+        {
+            i++;
+        }
+
+        if (i == size)
+        {
+            result.assign(data, data + size);
+        }
+        else
+        {
+            CharsetConverter<Encoding::UTF8, Encoding::UTF32LE>().Convert(data, data + size, std::back_inserter(result));
+        }
+    }
+} }
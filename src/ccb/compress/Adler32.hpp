@@ -0,0 +1,91 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ccb { namespace compress
+{
+    /// Adler-32 checksum, as used by the zlib format.
+    class Adler32
+    {
+    private:
+
+        static const uint32_t MOD = 65521;
+
+        /// Largest number of bytes that can be summed before the 32-bit sums may overflow.
+        static const size_t NMAX = 5552;
+
+        uint32_t a = 1;
+
+        uint32_t b = 0;
+
+    public:
+
+        void Update(const uint8_t* data, size_t length)
+        {
+            uint32_t a = this->a;
+            uint32_t b = this->b;
+
+            while (length > 0)
+            {
+                auto chunk = (length < NMAX) ? length : NMAX;
+                length -= chunk;
+
+                while (chunk >= 8)
+                {
+                    a += data[0]; b += a;
+                    a += data[1]; b += a;
+                    a += data[2]; b += a;
+                    a += data[3]; b += a;
+                    a += data[4]; b += a;
+                    a += data[5]; b += a;
+                    a += data[6]; b += a;
+                    a += data[7]; b += a;
+
+                    data += 8;
+                    chunk -= 8;
+                }
+
+                while (chunk > 0)
+                {
+                    a += *data++;
+                    b += a;
+                    chunk--;
+                }
+
+                a %= MOD;
+                b %= MOD;
+            }
+
+            this->a = a;
+            this->b = b;
+        }
+
+        uint32_t GetValue() const
+        {
+            return (this->b << 16) | this->a;
+        }
+    };
+} }
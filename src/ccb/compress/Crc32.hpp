@@ -0,0 +1,123 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <ccb/binary/Endianness.hpp>
+
+namespace ccb { namespace compress
+{
+    /// CRC-32 (IEEE 802.3, reflected), as used by the gzip format. Processes 8 bytes per step
+    /// with the slicing-by-8 tables.
+    class Crc32
+    {
+    private:
+
+        uint32_t crc = 0xffffffff;
+
+    public:
+
+        void Update(const uint8_t* data, size_t length)
+        {
+            const auto& tables = GetTables();
+
+            uint32_t crc = this->crc;
+
+            while ((length > 0) && ((reinterpret_cast<uintptr_t>(data) & 7) != 0))
+            {
+                crc = tables[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+                length--;
+            }
+
+            while (length >= 8)
+            {
+                auto lo = binary::LoadLE<uint32_t>(data) ^ crc;
+                auto hi = binary::LoadLE<uint32_t>(data + 4);
+
+                crc =
+                    tables[7][lo & 0xff] ^
+                    tables[6][(lo >> 8) & 0xff] ^
+                    tables[5][(lo >> 16) & 0xff] ^
+                    tables[4][lo >> 24] ^
+                    tables[3][hi & 0xff] ^
+                    tables[2][(hi >> 8) & 0xff] ^
+                    tables[1][(hi >> 16) & 0xff] ^
+                    tables[0][hi >> 24];
+
+                data += 8;
+                length -= 8;
+            }
+
+            while (length > 0)
+            {
+                crc = tables[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+                length--;
+            }
+
+            this->crc = crc;
+        }
+
+        uint32_t GetValue() const
+        {
+            return this->crc ^ 0xffffffff;
+        }
+
+    private:
+
+        struct Tables
+        {
+            uint32_t values[8][256];
+
+            Tables()
+            {
+                for (uint32_t i = 0; i < 256; i++)
+                {
+                    uint32_t c = i;
+                    for (int k = 0; k < 8; k++)
+                    {
+                        c = (c & 1) ? (0xedb88320 ^ (c >> 1)) : (c >> 1);
+                    }
+
+                    this->values[0][i] = c;
+                }
+
+                for (uint32_t i = 0; i < 256; i++)
+                {
+                    for (int t = 1; t < 8; t++)
+                    {
+                        auto prev = this->values[t - 1][i];
+                        this->values[t][i] = this->values[0][prev & 0xff] ^ (prev >> 8);
+                    }
+                }
+            }
+        };
+
+        static const uint32_t (&GetTables())[8][256]
+        {
+            static const Tables tables;
+            return tables.values;
+        }
+    };
+} }
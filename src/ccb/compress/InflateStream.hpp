@@ -0,0 +1,130 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <istream>
+#include <streambuf>
+#include <vector>
+
+#include <ccb/compress/Inflater.hpp>
+
+namespace ccb { namespace compress
+{
+    class InflateStreambuf : public std::streambuf
+    {
+    private:
+
+        static const size_t BUFFER_SIZE = 65536;
+
+        Inflater inflater;
+
+        std::vector<char> buffer;
+
+    public:
+
+        InflateStreambuf(std::istream& source, InflateFormat format = InflateFormat::Auto)
+            : inflater(source, format)
+            , buffer(BUFFER_SIZE)
+        {
+            this->setg(this->buffer.data(), this->buffer.data(), this->buffer.data());
+        }
+
+        InflateStreambuf(const void* data, size_t size, InflateFormat format = InflateFormat::Auto)
+            : inflater(data, size, format)
+            , buffer(BUFFER_SIZE)
+        {
+            this->setg(this->buffer.data(), this->buffer.data(), this->buffer.data());
+        }
+
+    protected:
+
+        virtual int_type underflow() override
+        {
+            if (this->gptr() < this->egptr())
+            {
+                return traits_type::to_int_type(*this->gptr());
+            }
+
+            auto count = this->inflater.Read(this->buffer.data(), this->buffer.size());
+            if (count == 0)
+            {
+                return traits_type::eof();
+            }
+
+            this->setg(this->buffer.data(), this->buffer.data(), this->buffer.data() + count);
+
+            return traits_type::to_int_type(*this->gptr());
+        }
+
+        // Large reads bypass the buffer and go straight to the destination.
+        virtual std::streamsize xsgetn(char_type* s, std::streamsize n) override
+        {
+            std::streamsize total = std::min(n, static_cast<std::streamsize>(this->egptr() - this->gptr()));
+
+            memcpy(s, this->gptr(), static_cast<size_t>(total));
+            this->gbump(static_cast<int>(total));
+
+            if (total < n)
+            {
+                total += static_cast<std::streamsize>(this->inflater.Read(s + total, static_cast<size_t>(n - total)));
+            }
+
+            return total;
+        }
+    };
+
+    /// Input stream with decompressed contents of a DEFLATE, zlib or gzip source.
+    class InflateIStream : public std::istream
+    {
+    private:
+
+        InflateStreambuf streambuf;
+
+    public:
+#ifdef _MSC_VER
+        InflateIStream(std::istream& source, InflateFormat format = InflateFormat::Auto)
+            : std::istream(std::_Noinit)
+            , streambuf(source, format)
+#else
+        InflateIStream(std::istream& source, InflateFormat format = InflateFormat::Auto)
+            : streambuf(source, format)
+#endif
+        {
+            this->init(&this->streambuf);
+        }
+
+#ifdef _MSC_VER
+        InflateIStream(const void* data, size_t size, InflateFormat format = InflateFormat::Auto)
+            : std::istream(std::_Noinit)
+            , streambuf(data, size, format)
+#else
+        InflateIStream(const void* data, size_t size, InflateFormat format = InflateFormat::Auto)
+            : streambuf(data, size, format)
+#endif
+        {
+            this->init(&this->streambuf);
+        }
+
+        InflateIStream(const InflateIStream& other) = delete;
+    };
+} }
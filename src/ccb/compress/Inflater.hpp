@@ -0,0 +1,875 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <stdexcept>
+#include <vector>
+
+#include <ccb/binary/HuffmanDecoder.hpp>
+#include <ccb/binary/InputBitReader.hpp>
+#include <ccb/compress/Adler32.hpp>
+#include <ccb/compress/Crc32.hpp>
+
+namespace ccb { namespace compress
+{
+    enum class InflateFormat
+    {
+        /// Bare DEFLATE stream (RFC 1951).
+        Raw = 0,
+
+        /// DEFLATE with zlib header and Adler-32 trailer (RFC 1950).
+        Zlib = 1,
+
+        /// One or more gzip members (RFC 1952).
+        Gzip = 2,
+
+        /// zlib or gzip, detected from the header; anything else is taken as raw DEFLATE.
+        Auto = 3
+    };
+
+    namespace details
+    {
+        struct InflateTables
+        {
+            static const uint16_t* LengthBase()
+            {
+                static const uint16_t values[] =
+                {
+                    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+                };
+                return values;
+            }
+
+            static const uint8_t* LengthExtra()
+            {
+                static const uint8_t values[] =
+                {
+                    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+                };
+                return values;
+            }
+
+            static const uint16_t* DistanceBase()
+            {
+                static const uint16_t values[] =
+                {
+                    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+                };
+                return values;
+            }
+
+            static const uint8_t* DistanceExtra()
+            {
+                static const uint8_t values[] =
+                {
+                    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+                };
+                return values;
+            }
+
+            static const uint8_t* CodeLengthOrder()
+            {
+                static const uint8_t values[] =
+                {
+                    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+                };
+                return values;
+            }
+
+            static const binary::HuffmanDecoder<uint16_t>& FixedLiterals()
+            {
+                static const binary::HuffmanDecoder<uint16_t> decoder(FixedLiteralLengths());
+                return decoder;
+            }
+
+            static const binary::HuffmanDecoder<uint16_t>& FixedDistances()
+            {
+                static const binary::HuffmanDecoder<uint16_t> decoder(std::vector<uint32_t>(30, 5));
+                return decoder;
+            }
+
+        private:
+
+            static std::vector<uint32_t> FixedLiteralLengths()
+            {
+                std::vector<uint32_t> lengths(288);
+
+                std::fill(lengths.begin(), lengths.begin() + 144, 8);
+                std::fill(lengths.begin() + 144, lengths.begin() + 256, 9);
+                std::fill(lengths.begin() + 256, lengths.begin() + 280, 7);
+                std::fill(lengths.begin() + 280, lengths.end(), 8);
+
+                return lengths;
+            }
+        };
+    }
+
+    /// Streaming DEFLATE decompressor. Input is either a memory block or an std::istream, which is
+    /// read in large chunks; output is pulled with Read().
+    class Inflater
+    {
+    private:
+
+        enum class State
+        {
+            StreamHeader,
+            BlockHeader,
+            StoredBlock,
+            HuffmanBlock,
+            StreamTrailer,
+            Done
+        };
+
+        static const size_t WINDOW_SIZE = 32768;
+
+        /// Bytes decoded per Read() refill before older history is slid out of the window.
+        static const size_t OUTPUT_CHUNK = 65536;
+
+        /// Room past the output limit for the longest match plus the overshoot of 16-byte copies.
+        static const size_t OUTPUT_MARGIN = 258 + 16;
+
+        static const size_t INPUT_CHUNK = 65536;
+
+        /// A single literal/length/distance triple never takes more than 48 bits; dynamic block headers
+        /// are refilled for separately.
+        static const int64_t MIN_INPUT_BITS = 64;
+
+        static const int64_t MIN_HEADER_BITS = 8 * 1024;
+
+        std::istream* source;
+
+        bool sourceEnd;
+
+        std::vector<uint8_t> input;
+
+        binary::LsbInputBitReader reader;
+
+        InflateFormat format;
+
+        State state = State::StreamHeader;
+
+        bool lastBlock = false;
+
+        size_t storedLeft = 0;
+
+        binary::HuffmanDecoder<uint16_t> dynamicLiterals;
+
+        binary::HuffmanDecoder<uint16_t> dynamicDistances;
+
+        const binary::HuffmanDecoder<uint16_t>* literals = nullptr;
+
+        const binary::HuffmanDecoder<uint16_t>* distances = nullptr;
+
+        std::vector<uint8_t> window;
+
+        size_t outPos = 0;
+
+        size_t deliverPos = 0;
+
+        size_t checkedPos = 0;
+
+        uint64_t memberSize = 0;
+
+        Adler32 adler;
+
+        Crc32 crc;
+
+    public:
+
+        Inflater(std::istream& source, InflateFormat format = InflateFormat::Auto)
+            : source(&source)
+            , sourceEnd(false)
+            , input(INPUT_CHUNK)
+            , reader(static_cast<const uint8_t*>(nullptr), static_cast<const uint8_t*>(nullptr))
+            , format(format)
+            , window(WINDOW_SIZE + OUTPUT_CHUNK + OUTPUT_MARGIN)
+        {
+            this->RefillInput();
+        }
+
+        Inflater(const void* data, size_t size, InflateFormat format = InflateFormat::Auto)
+            : source(nullptr)
+            , sourceEnd(true)
+            , reader(data, size)
+            , format(format)
+            , window(WINDOW_SIZE + OUTPUT_CHUNK + OUTPUT_MARGIN)
+        {
+        }
+
+        Inflater(const Inflater& other) = delete;
+
+        Inflater& operator = (const Inflater& other) = delete;
+
+    public:
+
+        /// Decompresses up to size bytes into dest. Returns 0 only at the end of the compressed stream.
+        size_t Read(void* dest, size_t size)
+        {
+            auto out = static_cast<uint8_t*>(dest);
+            size_t total = 0;
+
+            while (total < size)
+            {
+                if (this->deliverPos == this->outPos)
+                {
+                    if (this->state == State::Done)
+                    {
+                        break;
+                    }
+
+                    this->Decode();
+                    continue;
+                }
+
+                auto chunk = std::min(size - total, this->outPos - this->deliverPos);
+                memcpy(out + total, this->window.data() + this->deliverPos, chunk);
+
+                this->deliverPos += chunk;
+                total += chunk;
+            }
+
+            return total;
+        }
+
+        bool IsFinished() const
+        {
+            return (this->state == State::Done) && (this->deliverPos == this->outPos);
+        }
+
+        static std::vector<uint8_t> Inflate(const void* data, size_t size, InflateFormat format = InflateFormat::Auto)
+        {
+            Inflater inflater(data, size, format);
+
+            std::vector<uint8_t> result;
+
+            while (!inflater.IsFinished())
+            {
+                inflater.Decode();
+
+                result.insert(
+                    result.end(),
+                    inflater.window.begin() + inflater.deliverPos,
+                    inflater.window.begin() + inflater.outPos);
+
+                inflater.deliverPos = inflater.outPos;
+            }
+
+            return result;
+        }
+
+        static std::vector<uint8_t> Inflate(const std::vector<uint8_t>& data, InflateFormat format = InflateFormat::Auto)
+        {
+            return Inflate(data.data(), data.size(), format);
+        }
+
+    private:
+
+        /// Produces the next portion of output into the window.
+        void Decode()
+        {
+            this->SlideWindow();
+
+            auto limit = WINDOW_SIZE + OUTPUT_CHUNK;
+
+            while ((this->outPos < limit) && (this->state != State::Done))
+            {
+                switch (this->state)
+                {
+                case State::StreamHeader:
+                    this->ReadStreamHeader();
+                    break;
+
+                case State::BlockHeader:
+                    this->ReadBlockHeader();
+                    break;
+
+                case State::StoredBlock:
+                    this->DecodeStored(limit);
+                    break;
+
+                case State::HuffmanBlock:
+                    this->DecodeHuffman(limit);
+                    break;
+
+                case State::StreamTrailer:
+                    this->ReadStreamTrailer();
+                    break;
+
+                case State::Done:
+                    break;
+                }
+            }
+
+            this->UpdateChecksum();
+        }
+
+        void SlideWindow()
+        {
+            if (this->outPos < WINDOW_SIZE + OUTPUT_CHUNK)
+            {
+                return;
+            }
+
+            memmove(this->window.data(), this->window.data() + this->outPos - WINDOW_SIZE, WINDOW_SIZE);
+
+            this->outPos = WINDOW_SIZE;
+            this->deliverPos = WINDOW_SIZE;
+            this->checkedPos = WINDOW_SIZE;
+        }
+
+        void DecodeStored(size_t limit)
+        {
+            while ((this->storedLeft > 0) && (this->outPos < limit))
+            {
+                this->EnsureInput(8);
+
+                auto chunk = std::min(this->storedLeft, limit - this->outPos);
+                auto copied = this->reader.ReadBytes(this->window.data() + this->outPos, chunk);
+
+                if (copied == 0)
+                {
+                    throw std::runtime_error("Unexpected end of compressed data");
+                }
+
+                this->outPos += copied;
+                this->storedLeft -= copied;
+            }
+
+            if (this->storedLeft == 0)
+            {
+                this->EndBlock();
+            }
+        }
+
+        void DecodeHuffman(size_t limit)
+        {
+            const auto lengthBase = details::InflateTables::LengthBase();
+            const auto lengthExtra = details::InflateTables::LengthExtra();
+            const auto distanceBase = details::InflateTables::DistanceBase();
+            const auto distanceExtra = details::InflateTables::DistanceExtra();
+
+            auto& reader = this->reader;
+            auto out = this->window.data();
+            auto outPos = this->outPos;
+
+            while (outPos < limit)
+            {
+                if ((reader.GetBitsLeft() < MIN_INPUT_BITS) && !this->sourceEnd)
+                {
+                    this->RefillInput();
+                }
+
+                auto symbol = this->literals->Next(reader);
+
+                if (symbol < 256)
+                {
+                    out[outPos++] = static_cast<uint8_t>(symbol);
+                    continue;
+                }
+
+                if (symbol == 256)
+                {
+                    this->outPos = outPos;
+                    this->EndBlock();
+                    break;
+                }
+
+                symbol -= 257;
+                if (symbol >= 29)
+                {
+                    throw std::runtime_error("Invalid literal/length symbol");
+                }
+
+                size_t length = lengthBase[symbol] + static_cast<size_t>(reader.Read(lengthExtra[symbol]));
+
+                auto distanceSymbol = this->distances->Next(reader);
+                if (distanceSymbol >= 30)
+                {
+                    throw std::runtime_error("Invalid distance symbol");
+                }
+
+                size_t distance = distanceBase[distanceSymbol] + static_cast<size_t>(reader.Read(distanceExtra[distanceSymbol]));
+                if (distance > outPos)
+                {
+                    throw std::runtime_error("Distance is too far back");
+                }
+
+                CopyMatch(out + outPos, distance, length);
+                outPos += length;
+            }
+
+            if (reader.GetBitsLeft() < 0)
+            {
+                throw std::runtime_error("Unexpected end of compressed data");
+            }
+
+            this->outPos = outPos;
+        }
+
+        /// Copies a match with wide loads and stores. Writes up to 15 bytes past dest + length, which the
+        /// window margin makes room for; they are overwritten by the following output.
+        static void CopyMatch(uint8_t* dest, size_t distance, size_t length)
+        {
+            const uint8_t* src = dest - distance;
+            auto end = dest + length;
+
+            if (distance >= 16)
+            {
+                do
+                {
+                    memcpy(dest, src, 16);
+                    dest += 16;
+                    src += 16;
+                } while (dest < end);
+            }
+            else if (distance >= 8)
+            {
+                do
+                {
+                    memcpy(dest, src, 8);
+                    dest += 8;
+                    src += 8;
+                } while (dest < end);
+            }
+            else if (distance == 1)
+            {
+                memset(dest, *src, length);
+            }
+            else
+            {
+                // Repeat the short pattern until it spans 8 bytes; from there on the pattern repeats
+                // with a period that allows non-overlapping 8-byte copies.
+                auto period = distance * ((8 + distance - 1) / distance);
+                auto head = std::min(length, period);
+
+                for (size_t i = 0; i < head; i++)
+                {
+                    *dest++ = *src++;
+                }
+
+                src = dest - period;
+
+                while (dest < end)
+                {
+                    memcpy(dest, src, 8);
+                    dest += 8;
+                    src += 8;
+                }
+            }
+        }
+
+        void EndBlock()
+        {
+            this->state = this->lastBlock ? State::StreamTrailer : State::BlockHeader;
+        }
+
+        void ReadBlockHeader()
+        {
+            this->EnsureInput(MIN_HEADER_BITS);
+
+            this->lastBlock = this->reader.Read(1) != 0;
+            auto type = this->reader.Read(2);
+
+            if (type == 0)
+            {
+                this->reader.AlignToByte();
+
+                auto length = this->reader.Read(16);
+                auto complement = this->reader.Read(16);
+
+                if ((length ^ 0xffff) != complement)
+                {
+                    throw std::runtime_error("Corrupted stored block length");
+                }
+
+                this->storedLeft = static_cast<size_t>(length);
+                this->state = State::StoredBlock;
+            }
+            else if (type == 1)
+            {
+                this->literals = &details::InflateTables::FixedLiterals();
+                this->distances = &details::InflateTables::FixedDistances();
+                this->state = State::HuffmanBlock;
+            }
+            else if (type == 2)
+            {
+                this->ReadDynamicTables();
+                this->state = State::HuffmanBlock;
+            }
+            else
+            {
+                throw std::runtime_error("Invalid block type");
+            }
+
+            this->CheckInput();
+        }
+
+        /// Corrupt headers can describe more codes of some length than fit; incomplete codes are allowed.
+        static void CheckCodeLengths(std::vector<uint32_t>::const_iterator begin, std::vector<uint32_t>::const_iterator end)
+        {
+            uint32_t counts[16] = {};
+
+            for (auto pos = begin; pos != end; ++pos)
+            {
+                counts[*pos]++;
+            }
+
+            int32_t left = 1;
+
+            for (size_t length = 1; length < 16; length++)
+            {
+                left = (left << 1) - static_cast<int32_t>(counts[length]);
+                if (left < 0)
+                {
+                    throw std::runtime_error("Over-subscribed code lengths");
+                }
+            }
+        }
+
+        void ReadDynamicTables()
+        {
+            auto literalCount = static_cast<size_t>(this->reader.Read(5)) + 257;
+            auto distanceCount = static_cast<size_t>(this->reader.Read(5)) + 1;
+            auto codeLengthCount = static_cast<size_t>(this->reader.Read(4)) + 4;
+
+            if ((literalCount > 286) || (distanceCount > 30))
+            {
+                throw std::runtime_error("Too many length or distance symbols");
+            }
+
+            std::vector<uint32_t> codeLengthLengths(19, 0);
+            for (size_t i = 0; i < codeLengthCount; i++)
+            {
+                codeLengthLengths[details::InflateTables::CodeLengthOrder()[i]] = static_cast<uint32_t>(this->reader.Read(3));
+            }
+
+            CheckCodeLengths(codeLengthLengths.begin(), codeLengthLengths.end());
+            binary::HuffmanDecoder<uint16_t> codeLengthDecoder(codeLengthLengths);
+
+            std::vector<uint32_t> lengths;
+            lengths.reserve(literalCount + distanceCount);
+
+            while (lengths.size() < literalCount + distanceCount)
+            {
+                auto symbol = codeLengthDecoder.Next(this->reader);
+
+                if (symbol < 16)
+                {
+                    lengths.push_back(symbol);
+                    continue;
+                }
+
+                uint32_t value = 0;
+                size_t repeat;
+
+                if (symbol == 16)
+                {
+                    if (lengths.empty())
+                    {
+                        throw std::runtime_error("Repeated code length without a previous one");
+                    }
+
+                    value = lengths.back();
+                    repeat = 3 + static_cast<size_t>(this->reader.Read(2));
+                }
+                else if (symbol == 17)
+                {
+                    repeat = 3 + static_cast<size_t>(this->reader.Read(3));
+                }
+                else
+                {
+                    repeat = 11 + static_cast<size_t>(this->reader.Read(7));
+                }
+
+                if (lengths.size() + repeat > literalCount + distanceCount)
+                {
+                    throw std::runtime_error("Code lengths overflow the table");
+                }
+
+                lengths.insert(lengths.end(), repeat, value);
+            }
+
+            if (lengths[256] == 0)
+            {
+                throw std::runtime_error("Missing end-of-block code");
+            }
+
+            CheckCodeLengths(lengths.begin(), lengths.begin() + literalCount);
+            CheckCodeLengths(lengths.begin() + literalCount, lengths.end());
+
+            this->dynamicLiterals = binary::HuffmanDecoder<uint16_t>(
+                std::vector<uint32_t>(lengths.begin(), lengths.begin() + literalCount));
+            this->dynamicDistances = binary::HuffmanDecoder<uint16_t>(
+                std::vector<uint32_t>(lengths.begin() + literalCount, lengths.end()));
+
+            this->literals = &this->dynamicLiterals;
+            this->distances = &this->dynamicDistances;
+        }
+
+        void ReadStreamHeader()
+        {
+            this->EnsureInput(MIN_HEADER_BITS);
+
+            if (this->format == InflateFormat::Auto)
+            {
+                this->format = this->DetectFormat();
+            }
+
+            if (this->format == InflateFormat::Zlib)
+            {
+                auto cmf = this->reader.Read(8);
+                auto flg = this->reader.Read(8);
+
+                if (((cmf & 0x0f) != 8) || (((cmf << 8) | flg) % 31 != 0))
+                {
+                    throw std::runtime_error("Not a zlib stream");
+                }
+
+                if ((flg & 0x20) != 0)
+                {
+                    throw std::runtime_error("zlib preset dictionaries are not supported");
+                }
+
+                this->adler = Adler32();
+            }
+            else if (this->format == InflateFormat::Gzip)
+            {
+                this->ReadGzipHeader();
+                this->crc = Crc32();
+            }
+
+            this->memberSize = 0;
+            this->checkedPos = this->outPos;
+            this->state = State::BlockHeader;
+
+            this->CheckInput();
+        }
+
+        void ReadGzipHeader()
+        {
+            if ((this->reader.Read(8) != 0x1f) || (this->reader.Read(8) != 0x8b) || (this->reader.Read(8) != 8))
+            {
+                throw std::runtime_error("Not a gzip stream");
+            }
+
+            auto flags = this->reader.Read(8);
+
+            // MTIME, XFL and OS.
+            this->SkipBytes(6);
+
+            if ((flags & 0x04) != 0)
+            {
+                auto extraLength = this->reader.Read(16);
+                this->SkipBytes(static_cast<size_t>(extraLength));
+            }
+
+            if ((flags & 0x08) != 0)
+            {
+                this->SkipZeroTerminated();
+            }
+
+            if ((flags & 0x10) != 0)
+            {
+                this->SkipZeroTerminated();
+            }
+
+            if ((flags & 0x02) != 0)
+            {
+                this->SkipBytes(2);
+            }
+        }
+
+        void ReadStreamTrailer()
+        {
+            this->UpdateChecksum();
+
+            this->reader.AlignToByte();
+            this->EnsureInput(64);
+
+            if (this->format == InflateFormat::Zlib)
+            {
+                uint32_t expected = 0;
+                for (int i = 0; i < 4; i++)
+                {
+                    expected = (expected << 8) | static_cast<uint32_t>(this->reader.Read(8));
+                }
+
+                this->CheckInput();
+
+                if (expected != this->adler.GetValue())
+                {
+                    throw std::runtime_error("Adler-32 checksum mismatch");
+                }
+            }
+            else if (this->format == InflateFormat::Gzip)
+            {
+                auto expectedCrc = static_cast<uint32_t>(this->reader.Read(32));
+                auto expectedSize = static_cast<uint32_t>(this->reader.Read(32));
+
+                this->CheckInput();
+
+                if (expectedCrc != this->crc.GetValue())
+                {
+                    throw std::runtime_error("CRC-32 checksum mismatch");
+                }
+
+                if (expectedSize != static_cast<uint32_t>(this->memberSize))
+                {
+                    throw std::runtime_error("Uncompressed size mismatch");
+                }
+
+                // Concatenated members decompress to the concatenation of their contents.
+                this->EnsureInput(16);
+                if (this->reader.HasBits(16) && (this->reader.Peek(16) == 0x8b1f))
+                {
+                    this->state = State::StreamHeader;
+                    return;
+                }
+            }
+
+            this->state = State::Done;
+        }
+
+        InflateFormat DetectFormat()
+        {
+            if (!this->reader.HasBits(16))
+            {
+                return InflateFormat::Raw;
+            }
+
+            auto header = this->reader.Peek(16);
+            auto b0 = header & 0xff;
+            auto b1 = header >> 8;
+
+            if ((b0 == 0x1f) && (b1 == 0x8b))
+            {
+                return InflateFormat::Gzip;
+            }
+
+            if (((b0 & 0x0f) == 8) && ((b0 >> 4) <= 7) && (((b0 << 8) | b1) % 31 == 0))
+            {
+                return InflateFormat::Zlib;
+            }
+
+            return InflateFormat::Raw;
+        }
+
+        void UpdateChecksum()
+        {
+            auto size = this->outPos - this->checkedPos;
+            auto data = this->window.data() + this->checkedPos;
+
+            if (this->format == InflateFormat::Zlib)
+            {
+                this->adler.Update(data, size);
+            }
+            else if (this->format == InflateFormat::Gzip)
+            {
+                this->crc.Update(data, size);
+            }
+
+            this->memberSize += size;
+            this->checkedPos = this->outPos;
+        }
+
+        void SkipBytes(size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                this->EnsureInput(8);
+                this->reader.Skip(8);
+            }
+
+            this->CheckInput();
+        }
+
+        void SkipZeroTerminated()
+        {
+            do
+            {
+                this->EnsureInput(8);
+                this->CheckInput();
+            } while (this->reader.Read(8) != 0);
+        }
+
+        void CheckInput() const
+        {
+            if (this->reader.GetBitsLeft() < 0)
+            {
+                throw std::runtime_error("Unexpected end of compressed data");
+            }
+        }
+
+        void EnsureInput(int64_t bits)
+        {
+            if ((this->reader.GetBitsLeft() < bits) && !this->sourceEnd)
+            {
+                this->RefillInput();
+            }
+        }
+
+        /// Moves unread input to the front of the buffer and tops it up from the source.
+        void RefillInput()
+        {
+            size_t available = 0;
+            unsigned bitOffset = 0;
+
+            if (this->reader.GetBitsLeft() > 0)
+            {
+                auto position = this->reader.GetBitPosition();
+                auto consumed = static_cast<size_t>(position / 8);
+
+                bitOffset = static_cast<unsigned>(position % 8);
+                available = static_cast<size_t>((this->reader.GetBitsLeft() + bitOffset) / 8);
+
+                memmove(this->input.data(), this->input.data() + consumed, available);
+            }
+
+            while ((available < this->input.size()) && !this->sourceEnd)
+            {
+                this->source->read(
+                    reinterpret_cast<char*>(this->input.data() + available),
+                    static_cast<std::streamsize>(this->input.size() - available));
+
+                auto count = this->source->gcount();
+                available += static_cast<size_t>(count);
+
+                if (!*this->source || (count == 0))
+                {
+                    this->sourceEnd = true;
+                }
+            }
+
+            this->reader = binary::LsbInputBitReader(this->input.data(), available);
+            this->reader.Skip(bitOffset);
+        }
+    };
+} }
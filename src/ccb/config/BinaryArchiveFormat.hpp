@@ -0,0 +1,134 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include <ccb/binary/Endianness.hpp>
+#include <ccb/binary/Varint.hpp>
+
+namespace ccb { namespace config
+{
+    /// Binary archives store every field as a 32-bit tag (hash of the field name), a type byte and a
+    /// payload. Variable-size payloads start with their varint byte length, so unknown or skipped fields
+    /// can be stepped over without understanding them.
+    enum class BinaryFieldType : uint8_t
+    {
+        /// One byte, 0 or 1.
+        Bool = 0,
+
+        /// Unsigned varint.
+        UInt = 1,
+
+        /// Zigzag-encoded signed varint.
+        Int = 2,
+
+        /// 4 bytes, little-endian.
+        Float = 3,
+
+        /// 8 bytes, little-endian.
+        Double = 4,
+
+        /// Varint length followed by the bytes.
+        String = 5,
+
+        /// Varint byte length followed by the code units, each as a varint.
+        WideString = 6,
+
+        /// Varint byte length followed by the nested fields.
+        Map = 7
+    };
+
+    namespace details
+    {
+        const size_t BINARY_FIELD_HEADER_SIZE = 5;
+
+        /// FNV-1a over the code units of the name.
+        inline uint32_t BinaryFieldTag(const std::wstring& name)
+        {
+            uint32_t hash = 2166136261u;
+
+            for (auto c : name)
+            {
+                hash = (hash ^ static_cast<uint32_t>(c)) * 16777619u;
+            }
+
+            return hash;
+        }
+
+        /// Returns the end of the payload starting at pos.
+        inline const uint8_t* SkipBinaryPayload(BinaryFieldType type, const uint8_t* pos, const uint8_t* end)
+        {
+            size_t size;
+
+            switch (type)
+            {
+            case BinaryFieldType::Bool:
+                size = 1;
+                break;
+
+            case BinaryFieldType::UInt:
+            case BinaryFieldType::Int:
+                {
+                    uint64_t value;
+                    return binary::DecodeVarint(pos, end, value);
+                }
+
+            case BinaryFieldType::Float:
+                size = 4;
+                break;
+
+            case BinaryFieldType::Double:
+                size = 8;
+                break;
+
+            case BinaryFieldType::String:
+            case BinaryFieldType::WideString:
+            case BinaryFieldType::Map:
+                {
+                    uint64_t length;
+                    pos = binary::DecodeVarint(pos, end, length);
+
+                    if (length > static_cast<uint64_t>(end - pos))
+                    {
+                        throw std::runtime_error("Field is longer than the archive");
+                    }
+
+                    return pos + length;
+                }
+
+            default:
+                throw std::runtime_error("Unknown field type in binary archive");
+            }
+
+            if (size > static_cast<size_t>(end - pos))
+            {
+                throw std::runtime_error("Field is longer than the archive");
+            }
+
+            return pos + size;
+        }
+    }
+} }
@@ -0,0 +1,292 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#include <ccb/binary/InputBinaryStream.hpp>
+#include <ccb/config/BinaryArchiveFormat.hpp>
+#include <ccb/config/ConfigSerialization.hpp>
+
+namespace ccb { namespace config
+{
+    namespace details
+    {
+        template<typename U>
+        U CheckedIntegerCast(BinaryFieldType type, binary::InputBinaryStream& stream)
+        {
+            if (type == BinaryFieldType::UInt)
+            {
+                auto value = stream.ReadVarint();
+
+                if (value > static_cast<uint64_t>(std::numeric_limits<U>::max()))
+                {
+                    throw std::runtime_error("Field value is out of range");
+                }
+
+                return static_cast<U>(value);
+            }
+
+            if (type == BinaryFieldType::Int)
+            {
+                auto value = stream.ReadSignedVarint();
+
+                if (std::is_unsigned<U>::value
+                    ? ((value < 0) || (static_cast<uint64_t>(value) > static_cast<uint64_t>(std::numeric_limits<U>::max())))
+                    : ((value < static_cast<int64_t>(std::numeric_limits<U>::min())) || (value > static_cast<int64_t>(std::numeric_limits<U>::max()))))
+                {
+                    throw std::runtime_error("Field value is out of range");
+                }
+
+                return static_cast<U>(value);
+            }
+
+            throw std::runtime_error("Expected field to be an integer");
+        }
+
+        template<typename Archive, typename T, class Enable = void>
+        struct BinaryInputSerialize
+        {
+            void operator () (BinaryFieldType type, binary::InputBinaryStream& stream, T& value)
+            {
+                if (type != BinaryFieldType::Map)
+                {
+                    throw std::runtime_error("Expected field to be a map");
+                }
+
+                Access access;
+
+                auto size = static_cast<size_t>(stream.ReadVarint());
+                Archive subArchive(stream.ReadSpan(size), size);
+
+                access.Serialize(subArchive, value);
+            }
+        };
+
+        template<typename Archive>
+        struct BinaryInputSerialize<Archive, bool, void>
+        {
+            void operator () (BinaryFieldType type, binary::InputBinaryStream& stream, bool& value)
+            {
+                if (type != BinaryFieldType::Bool)
+                {
+                    throw std::runtime_error("Expected field to be a bool");
+                }
+
+                value = stream.ReadLE<uint8_t>() != 0;
+            }
+        };
+
+        template<typename Archive, typename U>
+        struct BinaryInputSerialize<
+            Archive,
+            U,
+            typename std::enable_if<std::is_integral<U>::value && !std::is_same<U, bool>::value>::type>
+        {
+            void operator () (BinaryFieldType type, binary::InputBinaryStream& stream, U& value)
+            {
+                value = CheckedIntegerCast<U>(type, stream);
+            }
+        };
+
+        template<typename Archive, typename U>
+        struct BinaryInputSerialize<
+            Archive,
+            U,
+            typename std::enable_if<std::is_floating_point<U>::value>::type>
+        {
+            void operator () (BinaryFieldType type, binary::InputBinaryStream& stream, U& value)
+            {
+                switch (type)
+                {
+                case BinaryFieldType::Float:
+                    value = static_cast<U>(stream.ReadLE<float>());
+                    break;
+
+                case BinaryFieldType::Double:
+                    value = static_cast<U>(stream.ReadLE<double>());
+                    break;
+
+                case BinaryFieldType::UInt:
+                    value = static_cast<U>(stream.ReadVarint());
+                    break;
+
+                case BinaryFieldType::Int:
+                    value = static_cast<U>(stream.ReadSignedVarint());
+                    break;
+
+                default:
+                    throw std::runtime_error("Expected field to be a number");
+                }
+            }
+        };
+
+        // Narrow and wide strings convert into each other unit by unit, as in the tree archives.
+        template<typename Archive, typename Char>
+        struct BinaryInputSerialize<Archive, std::basic_string<Char>, void>
+        {
+            void operator () (BinaryFieldType type, binary::InputBinaryStream& stream, std::basic_string<Char>& value)
+            {
+                if (type == BinaryFieldType::String)
+                {
+                    auto size = static_cast<size_t>(stream.ReadVarint());
+                    auto data = stream.ReadSpan(size);
+
+                    value.assign(data, data + size);
+                }
+                else if (type == BinaryFieldType::WideString)
+                {
+                    auto size = static_cast<size_t>(stream.ReadVarint());
+                    binary::InputBinaryStream units(stream.ReadSpan(size), size);
+
+                    value.clear();
+
+                    while (!units.End())
+                    {
+                        value.push_back(static_cast<Char>(units.ReadVarint()));
+                    }
+                }
+                else
+                {
+                    throw std::runtime_error("Expected field to be a string");
+                }
+            }
+        };
+    }
+
+    /// Reads config objects written by BinaryOutputArchive straight from the buffer. Fields are
+    /// looked up by tag, starting after the previously read one, so reading in the order of writing
+    /// is a single pass; fields in another order or missing ones cost a scan over the object.
+    class BinaryInputArchive
+    {
+    private:
+
+        const uint8_t* begin;
+
+        const uint8_t* end;
+
+        const uint8_t* next;
+
+    public:
+
+        BinaryInputArchive(const void* data, size_t size)
+            : begin(static_cast<const uint8_t*>(data))
+            , end(static_cast<const uint8_t*>(data) + size)
+            , next(static_cast<const uint8_t*>(data))
+        {
+        }
+
+        /// Takes the rest of the stream as the archive; the stream data must outlive the archive.
+        BinaryInputArchive(binary::InputBinaryStream& stream)
+        {
+            auto size = stream.GetRemaining();
+
+            this->begin = stream.ReadSpan(size);
+            this->end = this->begin + size;
+            this->next = this->begin;
+        }
+
+    public:
+
+        bool IsOutput() const
+        {
+            return false;
+        }
+
+        template<typename T>
+        void Serialize(T& value, const std::wstring& name)
+        {
+            auto field = this->FindField(details::BinaryFieldTag(name));
+
+            if (field == nullptr)
+            {
+                throw std::runtime_error("Field not found: " + std::string(name.begin(), name.end()));
+            }
+
+            this->Read(field, value);
+        }
+
+        template<typename T>
+        void Serialize(T& value, const std::wstring& name, const T& defaultValue)
+        {
+            auto field = this->FindField(details::BinaryFieldTag(name));
+
+            if (field == nullptr)
+            {
+                value = defaultValue;
+                return;
+            }
+
+            this->Read(field, value);
+        }
+
+    private:
+
+        template<typename T>
+        void Read(const uint8_t* field, T& value)
+        {
+            auto type = static_cast<BinaryFieldType>(field[4]);
+            auto payload = field + details::BINARY_FIELD_HEADER_SIZE;
+
+            binary::InputBinaryStream stream(payload, this->end - payload);
+
+            details::BinaryInputSerialize<BinaryInputArchive, T>()(type, stream, value);
+
+            this->next = payload + stream.GetPosition();
+        }
+
+        const uint8_t* FindField(uint32_t tag) const
+        {
+            auto field = this->FindField(tag, this->next, this->end);
+
+            if ((field == nullptr) && (this->next != this->begin))
+            {
+                field = this->FindField(tag, this->begin, this->next);
+            }
+
+            return field;
+        }
+
+        const uint8_t* FindField(uint32_t tag, const uint8_t* pos, const uint8_t* last) const
+        {
+            while (pos < last)
+            {
+                if (this->end - pos < static_cast<ptrdiff_t>(details::BINARY_FIELD_HEADER_SIZE))
+                {
+                    throw std::runtime_error("Truncated field in binary archive");
+                }
+
+                if (binary::LoadLE<uint32_t>(pos) == tag)
+                {
+                    return pos;
+                }
+
+                pos = details::SkipBinaryPayload(static_cast<BinaryFieldType>(pos[4]), pos + details::BINARY_FIELD_HEADER_SIZE, this->end);
+            }
+
+            return nullptr;
+        }
+    };
+} }
@@ -0,0 +1,218 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+#include <ccb/binary/OutputBinaryStream.hpp>
+#include <ccb/charset/Utf8.hpp>
+#include <ccb/config/BinaryArchiveFormat.hpp>
+#include <ccb/config/ConfigSerialization.hpp>
+
+namespace ccb { namespace config
+{
+    namespace details
+    {
+        template<typename Archive, typename T, class Enable = void>
+        struct BinaryOutputSerialize
+        {
+            void operator () (binary::OutputBinaryStream& stream, T& value)
+            {
+                Access access;
+
+                // Nested fields go through a buffer first, the map is prefixed with their total size.
+                binary::OutputBinaryStream buffer;
+                Archive subArchive(buffer);
+
+                access.Serialize(subArchive, value);
+
+                stream.WriteLE(static_cast<uint8_t>(BinaryFieldType::Map));
+                stream.WriteString(buffer.Data(), static_cast<size_t>(buffer.GetSize()));
+            }
+        };
+
+        template<typename Archive>
+        struct BinaryOutputSerialize<Archive, bool, void>
+        {
+            void operator () (binary::OutputBinaryStream& stream, bool& value)
+            {
+                stream.WriteLE(static_cast<uint8_t>(BinaryFieldType::Bool));
+                stream.WriteLE(static_cast<uint8_t>(value ? 1 : 0));
+            }
+        };
+
+        template<typename Archive, typename U>
+        struct BinaryOutputSerialize<
+            Archive,
+            U,
+            typename std::enable_if<std::is_integral<U>::value && std::is_unsigned<U>::value && !std::is_same<U, bool>::value>::type>
+        {
+            void operator () (binary::OutputBinaryStream& stream, U& value)
+            {
+                stream.WriteLE(static_cast<uint8_t>(BinaryFieldType::UInt));
+                stream.WriteVarint(static_cast<uint64_t>(value));
+            }
+        };
+
+        template<typename Archive, typename U>
+        struct BinaryOutputSerialize<
+            Archive,
+            U,
+            typename std::enable_if<std::is_integral<U>::value && std::is_signed<U>::value>::type>
+        {
+            void operator () (binary::OutputBinaryStream& stream, U& value)
+            {
+                stream.WriteLE(static_cast<uint8_t>(BinaryFieldType::Int));
+                stream.WriteSignedVarint(static_cast<int64_t>(value));
+            }
+        };
+
+        template<typename Archive>
+        struct BinaryOutputSerialize<Archive, float, void>
+        {
+            void operator () (binary::OutputBinaryStream& stream, float& value)
+            {
+                stream.WriteLE(static_cast<uint8_t>(BinaryFieldType::Float));
+                stream.WriteLE(value);
+            }
+        };
+
+        template<typename Archive, typename U>
+        struct BinaryOutputSerialize<
+            Archive,
+            U,
+            typename std::enable_if<std::is_floating_point<U>::value && !std::is_same<U, float>::value>::type>
+        {
+            void operator () (binary::OutputBinaryStream& stream, U& value)
+            {
+                stream.WriteLE(static_cast<uint8_t>(BinaryFieldType::Double));
+                stream.WriteLE(static_cast<double>(value));
+            }
+        };
+
+        template<typename Archive>
+        struct BinaryOutputSerialize<Archive, std::string, void>
+        {
+            void operator () (binary::OutputBinaryStream& stream, std::string& value)
+            {
+                stream.WriteLE(static_cast<uint8_t>(BinaryFieldType::String));
+                stream.WriteString(value);
+            }
+        };
+
+        template<typename Archive, typename Char>
+        struct BinaryOutputSerialize<
+            Archive,
+            std::basic_string<Char>,
+            typename std::enable_if<(sizeof(Char) > 1)>::type>
+        {
+            void operator () (binary::OutputBinaryStream& stream, std::basic_string<Char>& value)
+            {
+                size_t size = 0;
+                for (auto c : value)
+                {
+                    size += binary::GetVarintSize(static_cast<uint64_t>(c));
+                }
+
+                stream.WriteLE(static_cast<uint8_t>(BinaryFieldType::WideString));
+                stream.WriteVarint(size);
+
+                for (auto c : value)
+                {
+                    stream.WriteVarint(static_cast<uint64_t>(c));
+                }
+            }
+        };
+    }
+
+    /// Writes config objects in a compact tagged binary form, read back by BinaryInputArchive. Fields
+    /// are written straight into the stream; only nested objects are buffered to learn their size.
+    /// Names are only stored as hashes, so two fields of one map hashing alike are rejected.
+    class BinaryOutputArchive
+    {
+    private:
+
+        std::unique_ptr<binary::OutputBinaryStream> ownStream;
+
+        binary::OutputBinaryStream* stream;
+
+        /// Names of the fields written to this map, by their tag.
+        std::unordered_map<uint32_t, std::wstring> tags;
+
+    public:
+
+        BinaryOutputArchive()
+            : ownStream(new binary::OutputBinaryStream())
+            , stream(ownStream.get())
+        {
+        }
+
+        BinaryOutputArchive(binary::OutputBinaryStream& stream)
+            : stream(&stream)
+        {
+        }
+
+    public:
+
+        bool IsOutput() const
+        {
+            return true;
+        }
+
+        template<typename T>
+        void Serialize(T& value, const std::wstring& name)
+        {
+            auto tag = details::BinaryFieldTag(name);
+
+            auto inserted = this->tags.emplace(tag, name);
+            if (!inserted.second)
+            {
+                std::string utf8Name;
+                charset::WideToUtf8(name.data(), name.size(), utf8Name);
+
+                throw std::logic_error((inserted.first->second == name)
+                    ? "Duplicate field: " + utf8Name
+                    : "Field tag collision: " + utf8Name);
+            }
+
+            this->stream->WriteLE(tag);
+
+            details::BinaryOutputSerialize<BinaryOutputArchive, T>()(*this->stream, value);
+        }
+
+        template<typename T>
+        void Serialize(T& value, const std::wstring& name, const T& defaultValue)
+        {
+            this->Serialize(value, name);
+        }
+
+        binary::OutputBinaryStream& GetStream()
+        {
+            return *this->stream;
+        }
+    };
+} }
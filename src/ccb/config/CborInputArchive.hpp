@@ -0,0 +1,103 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <ccb/config/TreeInputArchive.hpp>
+#include <ccb/tree/CborTreeSerializer.hpp>
+
+namespace ccb { namespace config
+{
+    /// Reads configuration from a node of a CborDocument, straight from the encoded bytes.
+    class CborNodeInputArchive
+    {
+    private:
+
+        CborNode node;
+
+    public:
+
+        CborNodeInputArchive(const CborNode& node)
+        {
+            this->SetNode(node);
+        }
+
+    protected:
+
+        CborNodeInputArchive()
+        {
+        }
+
+    public:
+
+        bool IsOutput() const
+        {
+            return false;
+        }
+
+        template<typename T>
+        void Serialize(T& value, const std::wstring& name)
+        {
+            details::InputSerialize<CborNodeInputArchive, T>()(this->node, value, name);
+        }
+
+        template<typename T>
+        void Serialize(T& value, const std::wstring& name, const T& defaultValue)
+        {
+            if (this->node.HasNode(name))
+            {
+                return this->Serialize<T>(value, name);
+            }
+
+            value = defaultValue;
+        }
+
+    protected:
+
+        void SetNode(const CborNode& node)
+        {
+            if (node.GetType() != TreeNodeType::Map)
+            {
+                throw std::runtime_error("Expected field to be a map");
+            }
+
+            this->node = node;
+        }
+    };
+
+    /// Reads configuration from a memory mapped CBOR file, for example a cache written by
+    /// CborTreeSerializer, without building a tree first.
+    class CborInputArchive : public CborNodeInputArchive
+    {
+    private:
+
+        CborDocument document;
+
+    public:
+
+        CborInputArchive(const std::string& filename)
+            : document(filesystem::Path(filename))
+        {
+            this->SetNode(this->document.GetRoot());
+        }
+    };
+} }
@@ -0,0 +1,388 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <ccb/config/TreeInputArchive.hpp>
+#include <ccb/crypt/Md5.hpp>
+#include <ccb/filesystem/FileSystem.hpp>
+#include <ccb/tree/JsonTreeSerializer.hpp>
+#include <ccb/tree/TreeDiff.hpp>
+#include <ccb/tree/TreePath.hpp>
+
+namespace ccb { namespace config
+{
+    namespace details
+    {
+        /// Reports writes to one file through inotify on Linux. Other platforms have no notifier and
+        /// fall back to comparing the file status.
+        class FileNotifier
+        {
+        private:
+
+            int descriptor = -1;
+
+            std::string filename;
+
+        public:
+
+            FileNotifier(const filesystem::Path& path)
+            {
+#ifdef __linux__
+                auto directory = path.GetContainingPath();
+
+                this->filename = path.GetFilename().ToShortString();
+                this->descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+                // Editors often replace the file, so the directory is watched rather than the file.
+                if ((this->descriptor >= 0) &&
+                    (inotify_add_watch(this->descriptor, directory.IsEmpty() ? "." : directory.ToShortString().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0))
+                {
+                    this->Close();
+                }
+#endif
+            }
+
+            FileNotifier(const FileNotifier& other) = delete;
+
+            FileNotifier& operator = (const FileNotifier& other) = delete;
+
+            ~FileNotifier()
+            {
+                this->Close();
+            }
+
+        public:
+
+            bool IsOpen() const
+            {
+                return this->descriptor >= 0;
+            }
+
+            /// Reads the pending events, true if any of them is for the file.
+            bool ReadEvents()
+            {
+                bool touched = false;
+
+#ifdef __linux__
+                alignas(inotify_event) char buffer[4096];
+
+                while (this->descriptor >= 0)
+                {
+                    auto size = read(this->descriptor, buffer, sizeof(buffer));
+                    if (size <= 0)
+                    {
+                        break;
+                    }
+
+                    for (auto pos = buffer; pos < buffer + size; )
+                    {
+                        auto event = reinterpret_cast<const inotify_event*>(pos);
+
+                        if ((event->mask & IN_Q_OVERFLOW) != 0)
+                        {
+                            touched = true;
+                        }
+                        else if ((event->mask & IN_IGNORED) != 0)
+                        {
+                            // The directory is gone, the status is compared from now on.
+                            touched = true;
+                            this->Close();
+                            break;
+                        }
+                        else if ((event->len != 0) && (this->filename == event->name))
+                        {
+                            touched = true;
+                        }
+
+                        pos += sizeof(inotify_event) + event->len;
+                    }
+                }
+#endif
+
+                return touched;
+            }
+
+        private:
+
+            void Close()
+            {
+#ifdef __linux__
+                if (this->descriptor >= 0)
+                {
+                    close(this->descriptor);
+                    this->descriptor = -1;
+                }
+#endif
+            }
+        };
+
+        /// Configuration object or callback attached to a pointer into the watched tree.
+        struct ConfigBinding
+        {
+            std::wstring pointer;
+
+            tree::TreePath path;
+
+            std::function<void(tree::TreeMap&)> load;
+
+            std::function<void(const std::vector<tree::TreeChange>&)> callback;
+        };
+    }
+
+    /// Keeps configuration objects in sync with a JSON file. Poll() is cheap when nothing happened:
+    /// on Linux it only reads pending inotify events, elsewhere it compares the file size and
+    /// modification time. Touched files are hashed and only parsed when the content changed. The new
+    /// tree is compared with the previous one, and only bindings whose subtree changed are read again
+    /// and notified.
+    class ConfigWatcher
+    {
+    public:
+
+        typedef std::function<void(const std::vector<tree::TreeChange>&)> Callback;
+
+    private:
+
+        filesystem::Path path;
+
+        details::FileNotifier notifier;
+
+        filesystem::FileStatus status;
+
+        std::vector<uint8_t> digest;
+
+        std::unique_ptr<tree::TreeNode> tree;
+
+        std::vector<details::ConfigBinding> bindings;
+
+    public:
+
+        ConfigWatcher(const filesystem::Path& path)
+            : path(path)
+            , notifier(path)
+        {
+            auto status = filesystem::FileSystem().GetStatus(this->path);
+            if (!status.exists)
+            {
+                throw std::runtime_error("Cannot open config file");
+            }
+
+            this->tree = this->Read(status);
+        }
+
+    public:
+
+        const tree::TreeNode& GetTree() const
+        {
+            return *this->tree;
+        }
+
+        /// Reads the map at the pointer into the object now and again whenever the map changes. The
+        /// object must outlive the watcher.
+        template<typename T>
+        void Bind(const std::wstring& pointer, T& value, const Callback& callback = Callback())
+        {
+            auto binding = this->CreateBinding(pointer, callback);
+
+            binding.load = [&value] (tree::TreeMap& map)
+            {
+                TreeInputArchive archive(map);
+
+                Access access;
+                access.Serialize(archive, value);
+            };
+
+            this->Load(binding);
+            this->bindings.push_back(std::move(binding));
+        }
+
+        /// Calls back with the changes at, below or above the pointer.
+        void Subscribe(const std::wstring& pointer, const Callback& callback)
+        {
+            this->bindings.push_back(this->CreateBinding(pointer, callback));
+        }
+
+        /// Reloads the file if it changed, true if the tree differs from the previous one. Bindings
+        /// are updated in the order they were made. A binding that fails to load is not called back;
+        /// the others are still updated, and the first exception is rethrown afterwards.
+        bool Poll()
+        {
+            auto status = filesystem::FileSystem().GetStatus(this->path);
+
+            if (this->notifier.IsOpen())
+            {
+                if (!this->notifier.ReadEvents())
+                {
+                    return false;
+                }
+            }
+            else if (status == this->status)
+            {
+                return false;
+            }
+
+            if (!status.exists)
+            {
+                // Kept until the file is back, for example while it is being replaced.
+                return false;
+            }
+
+            auto next = this->Read(status);
+            if (next == nullptr)
+            {
+                return false;
+            }
+
+            auto changes = tree::TreeDiff().Compare(*this->tree, *next);
+            this->tree = std::move(next);
+
+            if (changes.empty())
+            {
+                return false;
+            }
+
+            std::exception_ptr error;
+
+            for (auto& binding : this->bindings)
+            {
+                std::vector<tree::TreeChange> affected;
+
+                for (const auto& change : changes)
+                {
+                    if (change.Affects(binding.pointer))
+                    {
+                        affected.push_back(change);
+                    }
+                }
+
+                if (affected.empty())
+                {
+                    continue;
+                }
+
+                try
+                {
+                    if (binding.load)
+                    {
+                        this->Load(binding);
+                    }
+
+                    if (binding.callback)
+                    {
+                        binding.callback(affected);
+                    }
+                }
+                catch (...)
+                {
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+            }
+
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+
+            return true;
+        }
+
+    private:
+
+        details::ConfigBinding CreateBinding(const std::wstring& pointer, const Callback& callback) const
+        {
+            details::ConfigBinding binding;
+            binding.path = tree::TreePath(pointer);
+            binding.pointer = binding.path.ToString();
+            binding.callback = callback;
+
+            if (binding.path.HasWildcards())
+            {
+                throw std::invalid_argument("Config bindings cannot have wildcards");
+            }
+
+            return binding;
+        }
+
+        void Load(const details::ConfigBinding& binding)
+        {
+            auto node = binding.path.Find(*this->tree);
+            if (node == nullptr)
+            {
+                throw std::runtime_error("No such node");
+            }
+
+            if (node->GetType() != tree::TreeNodeType::Map)
+            {
+                throw std::runtime_error("Expected field to be a map");
+            }
+
+            // The watcher owns the tree, the archive only reads it.
+            binding.load(const_cast<tree::TreeMap&>(static_cast<const tree::TreeMap&>(*node)));
+        }
+
+        /// Parses the file, or returns nullptr if its content is the same as last time. The status is
+        /// only taken once the file parses, so a file caught half written is read again on the next
+        /// poll.
+        std::unique_ptr<tree::TreeNode> Read(const filesystem::FileStatus& status)
+        {
+            std::ifstream stream(this->path.ToShortString(), std::ios::binary);
+            if (!stream)
+            {
+                throw std::runtime_error("Cannot open config file");
+            }
+
+            std::string text((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+            crypt::Md5 md5;
+            md5.Update(text);
+            auto digest = md5.Finish();
+
+            if (digest == this->digest)
+            {
+                this->status = status;
+                return nullptr;
+            }
+
+            auto node = tree::JsonTreeSerializer().Deserialize(text.data(), text.size());
+            this->digest = digest;
+            this->status = status;
+
+            return node;
+        }
+    };
+} }
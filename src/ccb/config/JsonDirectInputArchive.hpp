@@ -0,0 +1,544 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <ccb/charset/Utf8.hpp>
+#include <ccb/config/ConfigSerialization.hpp>
+#include <ccb/filesystem/MappedFile.hpp>
+#include <ccb/tree/JsonReader.hpp>
+#include <ccb/tree/TreeValue.hpp>
+
+namespace ccb { namespace config
+{
+    namespace details
+    {
+        /// Names a type passes to the archive in its Serialize method, in call order, with a perfect
+        /// hash from UTF-8 names to their position.
+        class ConfigFieldTable
+        {
+        private:
+
+            std::vector<std::wstring> names;
+
+            std::vector<std::string> utf8Names;
+
+            uint32_t seed = 0;
+
+            /// Position of the name plus one for each hash value, zero for none.
+            std::vector<uint32_t> buckets;
+
+        public:
+
+            ConfigFieldTable(const std::vector<std::wstring>& names)
+                : names(names)
+            {
+                for (const auto& name : names)
+                {
+                    this->utf8Names.emplace_back();
+                    charset::WideToUtf8(name.data(), name.size(), this->utf8Names.back());
+                }
+
+                this->BuildHash();
+            }
+
+        public:
+
+            size_t GetSize() const
+            {
+                return this->names.size();
+            }
+
+            const std::wstring& GetName(size_t idx) const
+            {
+                return this->names[idx];
+            }
+
+            /// Position of the name, or -1.
+            int Find(const char* name, size_t size) const
+            {
+                if (this->buckets.empty())
+                {
+                    return -1;
+                }
+
+                auto slot = this->buckets[Hash(name, size, this->seed) & (this->buckets.size() - 1)];
+                if (slot == 0)
+                {
+                    return -1;
+                }
+
+                const auto& candidate = this->utf8Names[slot - 1];
+                if ((candidate.size() != size) || (memcmp(candidate.data(), name, size) != 0))
+                {
+                    return -1;
+                }
+
+                return static_cast<int>(slot - 1);
+            }
+
+        private:
+
+            static uint32_t Hash(const char* name, size_t size, uint32_t seed)
+            {
+                uint32_t hash = 2166136261u ^ (seed * 0x9e3779b9u);
+
+                for (size_t i = 0; i < size; i++)
+                {
+                    hash = (hash ^ static_cast<uint8_t>(name[i])) * 16777619u;
+                }
+
+                return hash ^ (hash >> 15);
+            }
+
+            /// Tries seeds until every name gets its own bucket, growing the table now and then.
+            void BuildHash()
+            {
+                if (this->names.empty())
+                {
+                    return;
+                }
+
+                size_t capacity = 1;
+                while (capacity < 2 * this->names.size())
+                {
+                    capacity *= 2;
+                }
+
+                for (uint32_t attempt = 0; ; attempt++)
+                {
+                    if ((attempt != 0) && (attempt % 64 == 0))
+                    {
+                        capacity *= 2;
+                    }
+
+                    this->seed = attempt;
+                    this->buckets.assign(capacity, 0);
+
+                    bool collision = false;
+
+                    for (size_t i = 0; (i < this->names.size()) && !collision; i++)
+                    {
+                        auto& slot = this->buckets[Hash(this->utf8Names[i].data(), this->utf8Names[i].size(), this->seed) & (capacity - 1)];
+
+                        if (slot == 0)
+                        {
+                            slot = static_cast<uint32_t>(i + 1);
+                        }
+                        else if (this->utf8Names[slot - 1] != this->utf8Names[i])
+                        {
+                            // A name serialized twice keeps its first position.
+                            collision = true;
+                        }
+                    }
+
+                    if (!collision)
+                    {
+                        return;
+                    }
+                }
+            }
+        };
+
+        /// Collects the field names of a type. It acts as the input archive the table is used with, so
+        /// types serializing differently in each direction report the fields they read.
+        class ConfigFieldRecorder
+        {
+        public:
+
+            std::vector<std::wstring> names;
+
+        public:
+
+            bool IsOutput() const
+            {
+                return false;
+            }
+
+            template<typename T>
+            void Serialize(T& /*value*/, const std::wstring& name)
+            {
+                this->names.push_back(name);
+            }
+
+            template<typename T>
+            void Serialize(T& /*value*/, const std::wstring& name, const T& /*defaultValue*/)
+            {
+                this->names.push_back(name);
+            }
+        };
+
+        /// Proxy fields assign converted defaults to the object while recording, and the object about to
+        /// be read is usually not initialized yet, so the names are taken from a value-initialized one.
+        /// A type that can't be recorded gets an empty table, and its fields are looked up by name.
+        template<typename T>
+        typename std::enable_if<std::is_default_constructible<T>::value, std::vector<std::wstring>>::type RecordConfigFields()
+        {
+            T scratch = T();
+            ConfigFieldRecorder recorder;
+
+            try
+            {
+                Access access;
+                access.Serialize(recorder, scratch);
+            }
+            catch (const std::exception&)
+            {
+                return std::vector<std::wstring>();
+            }
+
+            return recorder.names;
+        }
+
+        template<typename T>
+        typename std::enable_if<!std::is_default_constructible<T>::value, std::vector<std::wstring>>::type RecordConfigFields()
+        {
+            return std::vector<std::wstring>();
+        }
+
+        /// Field table of T, recorded once per type.
+        template<typename T>
+        const ConfigFieldTable& GetConfigFieldTable()
+        {
+            static const ConfigFieldTable table(RecordConfigFields<T>());
+            return table;
+        }
+
+        /// Object member with the range of its value text.
+        struct JsonConfigMember
+        {
+            size_t nameOffset;
+
+            size_t nameSize;
+
+            const char* value;
+
+            const char* valueEnd;
+        };
+    }
+
+    /// Reads configuration straight from JSON text into objects, without a tree in between. An
+    /// object's members are listed once: names are matched to the fields of the type through its
+    /// field table, and values are only parsed when their field is read, numbers right from the text.
+    /// Nested objects and arrays are skipped by the structural index until they are read.
+    class JsonDirectInputArchive
+    {
+    private:
+
+        std::unique_ptr<filesystem::MappedFile> file;
+
+        const details::ConfigFieldTable* table = nullptr;
+
+        std::vector<details::JsonConfigMember> members;
+
+        /// Member index for each field of the table, -1 if the field is missing.
+        std::vector<int> fields;
+
+        /// Unescaped UTF-8 member names.
+        std::string names;
+
+        /// Member indices ordered by name, built on the first lookup of a name the table does not have.
+        std::vector<uint32_t> sorted;
+
+        /// Position in the table expected to be read next.
+        size_t nextField = 0;
+
+    public:
+
+        JsonDirectInputArchive(const std::string& filename)
+            : file(new filesystem::MappedFile(filesystem::Path(filename)))
+        {
+            auto data = reinterpret_cast<const char*>(this->file->GetData());
+            this->ReadRoot(data, this->file->GetSize());
+        }
+
+        JsonDirectInputArchive(const char* data, size_t size)
+        {
+            this->ReadRoot(data, size);
+        }
+
+    private:
+
+        JsonDirectInputArchive(const char* begin, const char* end, const details::ConfigFieldTable& table)
+            : table(&table)
+        {
+            this->fields.assign(table.GetSize(), -1);
+            this->ReadMembers(begin, static_cast<size_t>(end - begin));
+        }
+
+    public:
+
+        bool IsOutput() const
+        {
+            return false;
+        }
+
+        template<typename T>
+        void Serialize(T& value, const std::wstring& name)
+        {
+            auto member = this->FindMember(name);
+            if (member == nullptr)
+            {
+                throw std::runtime_error("No such node");
+            }
+
+            this->Read(value, *member);
+        }
+
+        template<typename T>
+        void Serialize(T& value, const std::wstring& name, const T& defaultValue)
+        {
+            auto member = this->FindMember(name);
+            if (member == nullptr)
+            {
+                value = defaultValue;
+                return;
+            }
+
+            this->Read(value, *member);
+        }
+
+    private:
+
+        void ReadRoot(const char* data, size_t size)
+        {
+            tree::JsonReader reader(data, size);
+            if (reader.Next() != tree::JsonEvent::StartObject)
+            {
+                throw std::runtime_error("Not a JSON map");
+            }
+
+            this->ReadMembers(data, size);
+        }
+
+        static bool IsSpace(char c)
+        {
+            return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r');
+        }
+
+        void ReadMembers(const char* data, size_t size)
+        {
+            tree::JsonReader reader(data, size);
+            reader.Next();
+
+            while (true)
+            {
+                auto event = reader.Next();
+                if (event == tree::JsonEvent::EndObject)
+                {
+                    break;
+                }
+
+                details::JsonConfigMember member;
+                member.nameOffset = this->names.size();
+                member.nameSize = reader.GetSize();
+                this->names.append(reader.GetData(), reader.GetSize());
+
+                member.value = data + reader.GetOffset();
+                while (IsSpace(*member.value))
+                {
+                    member.value++;
+                }
+
+                reader.SkipValue(reader.Next());
+                member.valueEnd = data + reader.GetOffset();
+                while (IsSpace(member.valueEnd[-1]))
+                {
+                    member.valueEnd--;
+                }
+
+                if (this->table != nullptr)
+                {
+                    auto field = this->table->Find(this->names.data() + member.nameOffset, member.nameSize);
+                    if (field >= 0)
+                    {
+                        if (this->fields[field] >= 0)
+                        {
+                            throw std::runtime_error("Duplicate field: " + std::string(this->names, member.nameOffset, member.nameSize));
+                        }
+
+                        this->fields[field] = static_cast<int>(this->members.size());
+                    }
+                }
+
+                this->members.push_back(member);
+            }
+
+            // Fails if anything follows the object.
+            reader.Next();
+        }
+
+        const details::JsonConfigMember* FindMember(const std::wstring& name)
+        {
+            if (this->table != nullptr)
+            {
+                // Fields are usually read in the order the table was recorded in.
+                int field = -1;
+
+                if ((this->nextField < this->table->GetSize()) && (this->table->GetName(this->nextField) == name))
+                {
+                    field = static_cast<int>(this->nextField++);
+                }
+                else
+                {
+                    std::string utf8Name;
+                    charset::WideToUtf8(name.data(), name.size(), utf8Name);
+                    field = this->table->Find(utf8Name.data(), utf8Name.size());
+                }
+
+                if (field >= 0)
+                {
+                    return (this->fields[field] >= 0) ? &this->members[this->fields[field]] : nullptr;
+                }
+            }
+
+            std::string utf8Name;
+            charset::WideToUtf8(name.data(), name.size(), utf8Name);
+
+            // Names outside the table, as in the root object, are looked up by binary search.
+            if (this->sorted.size() != this->members.size())
+            {
+                this->sorted.resize(this->members.size());
+                for (size_t i = 0; i < this->sorted.size(); i++)
+                {
+                    this->sorted[i] = static_cast<uint32_t>(i);
+                }
+
+                std::sort(this->sorted.begin(), this->sorted.end(), [this] (uint32_t left, uint32_t right)
+                {
+                    return this->CompareName(this->members[left], this->names.data() + this->members[right].nameOffset, this->members[right].nameSize) < 0;
+                });
+            }
+
+            auto pos = std::lower_bound(this->sorted.begin(), this->sorted.end(), utf8Name, [this] (uint32_t idx, const std::string& name)
+            {
+                return this->CompareName(this->members[idx], name.data(), name.size()) < 0;
+            });
+
+            if ((pos == this->sorted.end()) || (this->CompareName(this->members[*pos], utf8Name.data(), utf8Name.size()) != 0))
+            {
+                return nullptr;
+            }
+
+            if ((pos + 1 != this->sorted.end()) && (this->CompareName(this->members[*(pos + 1)], utf8Name.data(), utf8Name.size()) == 0))
+            {
+                throw std::runtime_error("Duplicate field: " + utf8Name);
+            }
+
+            return &this->members[*pos];
+        }
+
+        int CompareName(const details::JsonConfigMember& member, const char* name, size_t size) const
+        {
+            return this->names.compare(member.nameOffset, member.nameSize, name, size);
+        }
+
+        /// Same conversions as TreeInputArchive, which goes through TreeValue as well.
+        static tree::TreeValue ReadScalar(const details::JsonConfigMember& member)
+        {
+            auto text = member.value;
+            auto size = static_cast<size_t>(member.valueEnd - member.value);
+
+            tree::TreeValue value;
+
+            switch (*text)
+            {
+            case '"':
+            {
+                std::wstring str;
+
+                if (memchr(text, '\\', size) == nullptr)
+                {
+                    charset::Utf8ToWide(text + 1, size - 2, str);
+                }
+                else
+                {
+                    tree::JsonReader reader(text, size);
+                    reader.Next();
+                    charset::Utf8ToWide(reader.GetData(), reader.GetSize(), str);
+                }
+
+                value.SetString(str);
+                break;
+            }
+
+            case 't':
+                value.SetValue(true);
+                break;
+
+            case 'f':
+                value.SetValue(false);
+                break;
+
+            case 'n':
+                value.SetNull();
+                break;
+
+            case '{':
+            case '[':
+                throw std::runtime_error("Is not of requested type");
+
+            default:
+                value.SetNumber(text, size);
+            }
+
+            return value;
+        }
+
+        template<typename U>
+        typename std::enable_if<std::is_arithmetic<U>::value>::type Read(U& value, const details::JsonConfigMember& member)
+        {
+            value = ReadScalar(member).GetValue<U>();
+        }
+
+        template<typename Char>
+        void Read(std::basic_string<Char>& value, const details::JsonConfigMember& member)
+        {
+            auto scalar = ReadScalar(member);
+            const auto& str = scalar.GetString();
+            value = std::basic_string<Char>(str.begin(), str.end());
+        }
+
+        template<typename T>
+        typename std::enable_if<!std::is_arithmetic<T>::value>::type Read(T& value, const details::JsonConfigMember& member)
+        {
+            if (*member.value != '{')
+            {
+                throw std::runtime_error("Expected field to be a map");
+            }
+
+            JsonDirectInputArchive subArchive(member.value, member.valueEnd, details::GetConfigFieldTable<T>());
+
+            Access access;
+            access.Serialize(subArchive, value);
+        }
+    };
+} }
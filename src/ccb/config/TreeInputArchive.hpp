@@ -32,82 +32,89 @@ namespace ccb { namespace config
 
     namespace details
     {
-        template<typename Archive, typename T, class Enable = void>
-        struct InputSerialize
+        // Node access for the serializers below, which work both on TreeMap and on read-only node
+        // handles such as TreeDocumentNode and LazyJsonNode.
+
+        inline TreeMap& GetMapNode(TreeMap& map, const std::wstring& name)
         {
-            void operator () (TreeMap& map, T& value, const std::wstring& name)
-            {
-                Access access;
+            auto& subNode = map.GetNode(name);
 
-                auto& subNode = map.GetNode(name);
+            if (subNode.GetType() != TreeNodeType::Map)
+            {
+                throw std::runtime_error("Expected field to be a map");
+            }
 
-                if (subNode.GetType() != TreeNodeType::Map)
-                {
-                    throw std::runtime_error("Expected field to be a map");
-                }
+            return static_cast<TreeMap&>(subNode);
+        }
 
-                Archive subArchive(static_cast<TreeMap&>(subNode));
+        template<typename Node>
+        Node GetMapNode(const Node& map, const std::wstring& name)
+        {
+            auto subNode = map.GetNode(name);
 
-                access.Serialize(subArchive, value);
+            if (subNode.GetType() != TreeNodeType::Map)
+            {
+                throw std::runtime_error("Expected field to be a map");
             }
-        };
 
-        template<typename Archive>
-        struct InputSerialize<Archive, bool, void>
+            return subNode;
+        }
+
+        inline std::wstring GetValueString(TreeMap& map, const std::wstring& name)
         {
-            void operator () (TreeMap& map, bool& value, const std::wstring& name)
-            {
-                value = map.Get<TreeValue>(name).GetString() == L"true";
-            }
-        };
+            return map.Get<TreeValue>(name).GetString();
+        }
 
-        template<typename Archive>
-        struct InputSerialize<Archive, int8_t, void>
+        template<typename Node>
+        std::wstring GetValueString(const Node& map, const std::wstring& name)
         {
-            void operator () (TreeMap& map, int8_t& value, const std::wstring& name)
-            {
-                int32_t v;
+            return map.GetNode(name).GetString();
+        }
 
-                std::wistringstream stream(map.Get<TreeValue>(name).GetString());
-                stream >> v;
+        template<typename U>
+        U GetValue(TreeMap& map, const std::wstring& name)
+        {
+            return map.Get<TreeValue>(name).GetValue<U>();
+        }
 
-                value = static_cast<int8_t>(v);
-            }
-        };
+        template<typename U, typename Node>
+        U GetValue(const Node& map, const std::wstring& name)
+        {
+            return map.GetNode(name).template GetValue<U>();
+        }
 
-        template<typename Archive>
-        struct InputSerialize<Archive, uint8_t, void>
+        template<typename Archive, typename T, class Enable = void>
+        struct InputSerialize
         {
-            void operator () (TreeMap& map, uint8_t& value, const std::wstring& name)
+            template<typename Map>
+            void operator () (Map& map, T& value, const std::wstring& name)
             {
-                uint32_t v;
+                Access access;
 
-                std::wistringstream stream(map.Get<TreeValue>(name).GetString());
-                stream >> v;
+                Archive subArchive(GetMapNode(map, name));
 
-                value = static_cast<uint8_t>(v);
+                access.Serialize(subArchive, value);
             }
         };
 
+        /// Numbers and booleans are taken from the native value when the tree has one.
         template<typename Archive, typename U>
-        struct InputSerialize<
-            Archive,
-            U,
-            typename std::enable_if<std::is_arithmetic<U>::value && !std::is_same<U, int8_t>::value && !std::is_same<U, uint8_t>::value>::type>
+        struct InputSerialize<Archive, U, typename std::enable_if<std::is_arithmetic<U>::value>::type>
         {
-            void operator () (TreeMap& map, U& value, const std::wstring& name)
+            template<typename Map>
+            void operator () (Map& map, U& value, const std::wstring& name)
             {
-                std::wistringstream stream(map.Get<TreeValue>(name).GetString());
-                stream >> value;
+                value = GetValue<U>(map, name);
             }
         };
 
         template<typename Archive, typename Char>
         struct InputSerialize<Archive, std::basic_string<Char>, void>
         {
-            void operator () (TreeMap& map, std::basic_string<Char>& value, const std::wstring& name)
+            template<typename Map>
+            void operator () (Map& map, std::basic_string<Char>& value, const std::wstring& name)
             {
-                const auto& str = map.Get<TreeValue>(name).GetString();
+                const auto& str = GetValueString(map, name);
                 value = std::basic_string<Char>(str.begin(), str.end());
             }
         };
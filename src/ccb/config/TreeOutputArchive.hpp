@@ -45,51 +45,12 @@ namespace ccb { namespace config
             }
         };
 
-        template<typename Archive>
-        struct OutputSerialize<Archive, bool>
-        {
-            void operator () (TreeMap& map, bool& value, const std::wstring& name)
-            {
-                map.Set<TreeValue>(name).SetString(value ? L"true" : L"false");
-            }
-        };
-
-        template<typename Archive>
-        struct OutputSerialize<Archive, int8_t>
-        {
-            void operator () (TreeMap& map, int8_t& value, const std::wstring& name)
-            {
-                std::wostringstream stream;
-                stream << static_cast<int32_t>(value);
-
-                map.Set<TreeValue>(name).SetString(stream.str());
-            }
-        };
-
-        template<typename Archive>
-        struct OutputSerialize<Archive, uint8_t>
-        {
-            void operator () (TreeMap& map, uint8_t& value, const std::wstring& name)
-            {
-                std::wostringstream stream;
-                stream << static_cast<int32_t>(value);
-
-                map.Set<TreeValue>(name).SetString(stream.str());
-            }
-        };
-
         template<typename Archive, typename U>
-        struct OutputSerialize<
-            Archive,
-            U,
-            typename std::enable_if<std::is_arithmetic<U>::value && !std::is_same<U, int8_t>::value && !std::is_same<U, uint8_t>::value>::type>
+        struct OutputSerialize<Archive, U, typename std::enable_if<std::is_arithmetic<U>::value>::type>
         {
             void operator () (TreeMap& map, U& value, const std::wstring& name)
             {
-                std::wostringstream stream;
-                stream << value;
-
-                map.Set<TreeValue>(name).SetString(stream.str());
+                map.Set<TreeValue>(name).SetValue(value);
             }
         };
 
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <regex>
 
 #ifdef _WIN32
@@ -38,6 +39,27 @@
 
 namespace ccb { namespace filesystem
 {
+    /// Size and modification time of a file, compared to notice changes.
+    struct FileStatus
+    {
+        bool exists = false;
+
+        uint64_t size = 0;
+
+        /// Modification time in the platform's units.
+        int64_t modified = 0;
+
+        bool operator == (const FileStatus& other) const
+        {
+            return (this->exists == other.exists) && (this->size == other.size) && (this->modified == other.modified);
+        }
+
+        bool operator != (const FileStatus& other) const
+        {
+            return !(*this == other);
+        }
+    };
+
     class FileSystem
     {
     public:
@@ -140,6 +162,37 @@ namespace ccb { namespace filesystem
 #endif
         }
 
+        FileStatus GetStatus(const Path& path) const
+        {
+            FileStatus status;
+
+#ifdef _WIN32
+            WIN32_FILE_ATTRIBUTE_DATA data;
+
+            if (GetFileAttributesEx(path.ToString().c_str(), GetFileExInfoStandard, &data) != 0)
+            {
+                status.exists = true;
+                status.size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+                status.modified = static_cast<int64_t>((static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime);
+            }
+#else
+            struct stat st;
+
+            if (stat(path.ToShortString().c_str(), &st) == 0)
+            {
+                status.exists = true;
+                status.size = static_cast<uint64_t>(st.st_size);
+#ifdef __APPLE__
+                status.modified = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+                status.modified = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+            }
+#endif
+
+            return status;
+        }
+
         std::vector<Path> ReadDirectoryFilter(const Path& path, const std::wregex& regex, bool includeFiles = true, bool includeDirs = true)
         {
 #ifdef _WIN32
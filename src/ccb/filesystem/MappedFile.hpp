@@ -0,0 +1,175 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <ccb/filesystem/Path.hpp>
+
+namespace ccb { namespace filesystem
+{
+    /// Read-only memory mapping of a whole file. The mapping lives as long as the object.
+    class MappedFile
+    {
+    private:
+
+        const uint8_t* data = nullptr;
+
+        size_t size = 0;
+
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+
+        HANDLE mapping = nullptr;
+#endif
+
+    public:
+
+        MappedFile(const Path& path)
+        {
+#ifdef _WIN32
+            this->file = CreateFileW(path.ToString().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (this->file == INVALID_HANDLE_VALUE)
+            {
+                throw std::runtime_error("Cannot open file " + path.ToShortString());
+            }
+
+            LARGE_INTEGER fileSize;
+            if (GetFileSizeEx(this->file, &fileSize) == 0)
+            {
+                this->Close();
+                throw std::runtime_error("Cannot get size of file " + path.ToShortString());
+            }
+
+            this->size = static_cast<size_t>(fileSize.QuadPart);
+
+            if (this->size > 0)
+            {
+                this->mapping = CreateFileMappingW(this->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (this->mapping != nullptr)
+                {
+                    this->data = static_cast<const uint8_t*>(MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0));
+                }
+
+                if (this->data == nullptr)
+                {
+                    this->Close();
+                    throw std::runtime_error("Cannot map file " + path.ToShortString());
+                }
+            }
+#else
+            auto fd = open(path.ToShortString().c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                throw std::runtime_error("Cannot open file " + path.ToShortString());
+            }
+
+            struct stat st;
+            if (fstat(fd, &st) != 0)
+            {
+                close(fd);
+                throw std::runtime_error("Cannot get size of file " + path.ToShortString());
+            }
+
+            this->size = static_cast<size_t>(st.st_size);
+
+            if (this->size > 0)
+            {
+                auto mapped = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped == MAP_FAILED)
+                {
+                    close(fd);
+                    throw std::runtime_error("Cannot map file " + path.ToShortString());
+                }
+
+                // Data is usually scanned front to back, let the kernel read ahead aggressively.
+                madvise(mapped, this->size, MADV_SEQUENTIAL);
+
+                this->data = static_cast<const uint8_t*>(mapped);
+            }
+
+            close(fd);
+#endif
+        }
+
+        MappedFile(const MappedFile& other) = delete;
+
+        MappedFile& operator = (const MappedFile& other) = delete;
+
+        ~MappedFile()
+        {
+            this->Close();
+        }
+
+    public:
+
+        const uint8_t* GetData() const
+        {
+            return this->data;
+        }
+
+        size_t GetSize() const
+        {
+            return this->size;
+        }
+
+    private:
+
+        void Close()
+        {
+#ifdef _WIN32
+            if (this->data != nullptr)
+            {
+                UnmapViewOfFile(this->data);
+            }
+
+            if (this->mapping != nullptr)
+            {
+                CloseHandle(this->mapping);
+            }
+
+            if (this->file != INVALID_HANDLE_VALUE)
+            {
+                CloseHandle(this->file);
+            }
+#else
+            if (this->data != nullptr)
+            {
+                munmap(const_cast<uint8_t*>(this->data), this->size);
+            }
+#endif
+
+            this->data = nullptr;
+        }
+    };
+} }
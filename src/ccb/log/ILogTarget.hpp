@@ -23,9 +23,11 @@
 #pragma once
 
 #include <chrono>
+#include <sstream>
 #include <string>
 
 #include <ccb/Time.hpp>
+#include <ccb/log/LogField.hpp>
 #include <ccb/log/LogLevel.hpp>
 
 namespace ccb { namespace log
@@ -39,6 +41,36 @@ namespace ccb { namespace log
             LogLevel level,
             const std::wstring& source,
             const std::wstring& message) = 0;
+
+        // Targets which understand typed fields override this; the rest get the fields appended to the message text.
+        virtual void LogStructuredMessage(
+            const Time& time,
+            LogLevel level,
+            const std::wstring& source,
+            const std::wstring& message,
+            const LogFields& fields)
+        {
+            if (fields.empty())
+            {
+                this->LogMessage(time, level, source, message);
+                return;
+            }
+
+            std::wostringstream stream;
+            stream << message;
+
+            for (const auto& field : fields)
+            {
+                stream << L' ' << field;
+            }
+
+            this->LogMessage(time, level, source, stream.str());
+        }
+
+        // Called by LogSink after each batch of messages, so buffered targets write out once per batch.
+        virtual void Flush()
+        {
+        }
     };
 } }
 
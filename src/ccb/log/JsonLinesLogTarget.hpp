@@ -0,0 +1,311 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#include <ccb/filesystem/FileSystem.hpp>
+#include <ccb/log/ILogTarget.hpp>
+
+namespace ccb { namespace log
+{
+    // Writes one JSON object per line: time, level, source, message and then every field with its native type.
+    class JsonLinesLogTarget : public ILogTarget
+    {
+    private:
+
+        std::ofstream file;
+
+        std::ostream* stream;
+
+        std::mutex streamMutex;
+
+        std::string line;
+
+    public:
+
+        JsonLinesLogTarget(const std::string& fileName)
+            : stream(&this->file)
+        {
+            this->Open(fileName);
+        }
+
+        JsonLinesLogTarget(const std::wstring& fileName)
+            : stream(&this->file)
+        {
+            this->Open(std::string(fileName.begin(), fileName.end()));
+        }
+
+        JsonLinesLogTarget(std::ostream& stream)
+            : stream(&stream)
+        {
+        }
+
+    public:
+
+        virtual void LogMessage(
+            const Time& time,
+            LogLevel level,
+            const std::wstring& source,
+            const std::wstring& message) override
+        {
+            this->LogStructuredMessage(time, level, source, message, LogFields());
+        }
+
+        virtual void LogStructuredMessage(
+            const Time& time,
+            LogLevel level,
+            const std::wstring& source,
+            const std::wstring& message,
+            const LogFields& fields) override
+        {
+            std::lock_guard<std::mutex> lock(this->streamMutex);
+
+            this->line.clear();
+
+            this->line += "{\"time\":\"";
+            this->AppendTime(time);
+            this->line += "\",\"level\":\"";
+            this->line += LevelName(level);
+            this->line += "\",\"source\":";
+            this->AppendString(source);
+            this->line += ",\"message\":";
+            this->AppendString(message);
+
+            for (const auto& field : fields)
+            {
+                this->line += ',';
+                this->AppendString(field.GetName());
+                this->line += ':';
+                this->AppendValue(field);
+            }
+
+            this->line += "}\n";
+
+            this->stream->write(this->line.data(), this->line.size());
+        }
+
+        virtual void Flush() override
+        {
+            std::lock_guard<std::mutex> lock(this->streamMutex);
+
+            this->stream->flush();
+        }
+
+    private:
+
+        void Open(const std::string& fileName)
+        {
+            filesystem::FileSystem fileSystem;
+
+            fileSystem.CreateDirectories(filesystem::Path(fileName).GetContainingPath());
+
+            this->file.open(fileName, std::ios_base::out | std::ios_base::app | std::ios_base::binary);
+        }
+
+        void AppendTime(const Time& time)
+        {
+            auto sinceEpoch = time.GetTimePoint().time_since_epoch();
+            auto seconds = std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch);
+            auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(sinceEpoch - seconds).count();
+
+            std::time_t t = static_cast<std::time_t>(seconds.count());
+            std::tm fields;
+            gmtime_r(&t, &fields);
+
+            char buffer[32];
+            auto length = snprintf(
+                buffer,
+                sizeof(buffer),
+                "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                fields.tm_year + 1900,
+                fields.tm_mon + 1,
+                fields.tm_mday,
+                fields.tm_hour,
+                fields.tm_min,
+                fields.tm_sec,
+                static_cast<int>(millis));
+
+            this->line.append(buffer, length);
+        }
+
+        void AppendValue(const LogField& field)
+        {
+            char buffer[32];
+            int length = 0;
+
+            switch (field.GetType())
+            {
+            case LogFieldType::Bool:
+                this->line += field.GetBool() ? "true" : "false";
+                return;
+
+            case LogFieldType::Int:
+                length = snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(field.GetInt()));
+                break;
+
+            case LogFieldType::UInt:
+                length = snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(field.GetUInt()));
+                break;
+
+            case LogFieldType::Double:
+                // JSON has no representation for NaN and infinities.
+                if (field.GetDouble() != field.GetDouble() || (field.GetDouble() - field.GetDouble() != 0))
+                {
+                    this->line += "null";
+                    return;
+                }
+
+                length = snprintf(buffer, sizeof(buffer), "%.17g", field.GetDouble());
+                break;
+
+            case LogFieldType::String:
+                this->AppendString(field.GetString());
+                return;
+
+            case LogFieldType::WideString:
+                this->AppendString(field.GetWideString());
+                return;
+            }
+
+            this->line.append(buffer, length);
+        }
+
+        // Narrow strings are expected to already be UTF-8.
+        void AppendString(const std::string& value)
+        {
+            this->line += '"';
+
+            for (char c : value)
+            {
+                this->AppendCodeUnit(static_cast<uint8_t>(c));
+            }
+
+            this->line += '"';
+        }
+
+        void AppendString(const std::wstring& value)
+        {
+            this->line += '"';
+
+            for (wchar_t c : value)
+            {
+                auto codePoint = static_cast<uint32_t>(c);
+
+                if (codePoint < 0x80)
+                {
+                    this->AppendCodeUnit(static_cast<uint8_t>(codePoint));
+                }
+                else if (codePoint < 0x800)
+                {
+                    this->line += static_cast<char>(((codePoint >> 6) & 0x1f) | 0xc0);
+                    this->line += static_cast<char>((codePoint & 0x3f) | 0x80);
+                }
+                else if (codePoint < 0x10000)
+                {
+                    this->line += static_cast<char>(((codePoint >> 12) & 0x0f) | 0xe0);
+                    this->line += static_cast<char>(((codePoint >> 6) & 0x3f) | 0x80);
+                    this->line += static_cast<char>((codePoint & 0x3f) | 0x80);
+                }
+                else
+                {
+                    this->line += static_cast<char>(((codePoint >> 18) & 0x07) | 0xf0);
+                    this->line += static_cast<char>(((codePoint >> 12) & 0x3f) | 0x80);
+                    this->line += static_cast<char>(((codePoint >> 6) & 0x3f) | 0x80);
+                    this->line += static_cast<char>((codePoint & 0x3f) | 0x80);
+                }
+            }
+
+            this->line += '"';
+        }
+
+        void AppendCodeUnit(uint8_t c)
+        {
+            static const char HEX[] = "0123456789abcdef";
+
+            switch (c)
+            {
+            case '"':
+                this->line += "\\\"";
+                break;
+
+            case '\\':
+                this->line += "\\\\";
+                break;
+
+            case '\n':
+                this->line += "\\n";
+                break;
+
+            case '\r':
+                this->line += "\\r";
+                break;
+
+            case '\t':
+                this->line += "\\t";
+                break;
+
+            default:
+                if (c < 0x20)
+                {
+                    this->line += "\\u00";
+                    this->line += HEX[c >> 4];
+                    this->line += HEX[c & 0xf];
+                }
+                else
+                {
+                    this->line += static_cast<char>(c);
+                }
+            }
+        }
+
+        static const char* LevelName(LogLevel level)
+        {
+            switch (level)
+            {
+            case LogLevel::Trace:
+                return "Trace";
+
+            case LogLevel::Info:
+                return "Info";
+
+            case LogLevel::Warning:
+                return "Warning";
+
+            case LogLevel::Error:
+                return "Error";
+
+            case LogLevel::Critical:
+                return "Critical";
+
+            default:
+                return "Unknown";
+            }
+        }
+    };
+} }
@@ -0,0 +1,193 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#ifdef __linux__
+#include <time.h>
+#endif
+
+#include <ccb/log/LogLevel.hpp>
+
+namespace ccb { namespace log
+{
+    class LogSink;
+
+    // Per-callsite admission state: a token bucket (kept as a GCRA "theoretical arrival time", so that
+    // a single CAS updates it) combined with probabilistic sampling. Checks never touch LogSink locks.
+    class LogCallSite
+    {
+    private:
+
+        static const uint32_t SAMPLE_ALL = 0xffffffff;
+
+        int64_t interval;
+
+        int64_t tolerance;
+
+        uint32_t sampleThreshold;
+
+        std::atomic<int64_t> theoreticalArrival;
+
+        std::atomic<uint64_t> suppressed;
+
+        // Set once a LogSink reports the suppressed count of this call site on its own.
+        std::atomic<bool> attached;
+
+        std::wstring source;
+
+        LogLevel level = LogLevel::Info;
+
+        std::function<void(LogCallSite*)> detach;
+
+    public:
+
+        // messagesPerSecond <= 0 disables rate limiting; sampleRate is the fraction of calls to keep.
+        LogCallSite(double messagesPerSecond, unsigned burst = 1, double sampleRate = 1.0)
+            : interval((messagesPerSecond > 0) ? static_cast<int64_t>(1e9 / messagesPerSecond) : 0)
+            , tolerance(0)
+            , sampleThreshold(SAMPLE_ALL)
+            , theoreticalArrival(0)
+            , suppressed(0)
+            , attached(false)
+        {
+            if (burst > 1)
+            {
+                this->tolerance = this->interval * (burst - 1);
+            }
+
+            if (sampleRate < 1.0)
+            {
+                this->sampleThreshold = (sampleRate <= 0.0)
+                    ? 0
+                    : static_cast<uint32_t>(sampleRate * SAMPLE_ALL);
+            }
+        }
+
+        LogCallSite(const LogCallSite& other) = delete;
+
+        LogCallSite& operator = (const LogCallSite& other) = delete;
+
+        ~LogCallSite()
+        {
+            if (this->detach)
+            {
+                this->detach(this);
+            }
+        }
+
+    public:
+
+        bool Allow()
+        {
+            return this->Allow(Now());
+        }
+
+        // Same as Allow(), with the current time given in nanoseconds of a monotonic clock.
+        bool Allow(int64_t now)
+        {
+            if ((this->sampleThreshold != SAMPLE_ALL) && (NextRandom() >= this->sampleThreshold))
+            {
+                this->suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            if (this->interval == 0)
+            {
+                return true;
+            }
+
+            auto arrival = this->theoreticalArrival.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                if (arrival - this->tolerance > now)
+                {
+                    this->suppressed.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+
+                auto next = ((arrival > now) ? arrival : now) + this->interval;
+
+                if (this->theoreticalArrival.compare_exchange_weak(arrival, next, std::memory_order_relaxed))
+                {
+                    return true;
+                }
+            }
+        }
+
+        // Returns the number of calls suppressed since the previous call and resets the counter.
+        uint64_t TakeSuppressed()
+        {
+            if (this->suppressed.load(std::memory_order_relaxed) == 0)
+            {
+                return 0;
+            }
+
+            return this->suppressed.exchange(0, std::memory_order_relaxed);
+        }
+
+        bool IsAttached() const
+        {
+            return this->attached.load(std::memory_order_acquire);
+        }
+
+    private:
+
+        static int64_t Now()
+        {
+#ifdef __linux__
+            // Coarse clock is read from vDSO without a syscall and is precise enough for rate limiting.
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+            return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+
+        static uint32_t NextRandom()
+        {
+            static thread_local uint64_t state = 0;
+
+            if (state == 0)
+            {
+                state = reinterpret_cast<uintptr_t>(&state) ^ static_cast<uint64_t>(Now()) ^ 0x9e3779b97f4a7c15ull;
+            }
+
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+
+            return static_cast<uint32_t>(state >> 32);
+        }
+
+        friend class LogSink;
+    };
+} }
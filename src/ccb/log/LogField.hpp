@@ -0,0 +1,261 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <ccb/log/IsStreamable.hpp>
+
+namespace ccb { namespace log
+{
+    enum class LogFieldType
+    {
+        Bool = 0,
+
+        Int = 1,
+
+        UInt = 2,
+
+        Double = 3,
+
+        String = 4,
+
+        WideString = 5
+    };
+
+    // Named log parameter, which keeps its native type all the way to the log targets.
+    class LogField
+    {
+    private:
+
+        std::string name;
+
+        LogFieldType type;
+
+        union
+        {
+            bool boolValue;
+
+            int64_t intValue;
+
+            uint64_t uintValue;
+
+            double doubleValue;
+        };
+
+        std::string stringValue;
+
+        std::wstring wideStringValue;
+
+    public:
+
+        LogField(const std::string& name, bool value)
+            : name(name)
+            , type(LogFieldType::Bool)
+            , boolValue(value)
+        {
+        }
+
+        LogField(const std::string& name, int64_t value)
+            : name(name)
+            , type(LogFieldType::Int)
+            , intValue(value)
+        {
+        }
+
+        LogField(const std::string& name, uint64_t value)
+            : name(name)
+            , type(LogFieldType::UInt)
+            , uintValue(value)
+        {
+        }
+
+        LogField(const std::string& name, double value)
+            : name(name)
+            , type(LogFieldType::Double)
+            , doubleValue(value)
+        {
+        }
+
+        LogField(const std::string& name, std::string value)
+            : name(name)
+            , type(LogFieldType::String)
+            , uintValue(0)
+            , stringValue(std::move(value))
+        {
+        }
+
+        LogField(const std::string& name, std::wstring value)
+            : name(name)
+            , type(LogFieldType::WideString)
+            , uintValue(0)
+            , wideStringValue(std::move(value))
+        {
+        }
+
+    public:
+
+        const std::string& GetName() const
+        {
+            return this->name;
+        }
+
+        LogFieldType GetType() const
+        {
+            return this->type;
+        }
+
+        bool GetBool() const
+        {
+            return this->boolValue;
+        }
+
+        int64_t GetInt() const
+        {
+            return this->intValue;
+        }
+
+        uint64_t GetUInt() const
+        {
+            return this->uintValue;
+        }
+
+        double GetDouble() const
+        {
+            return this->doubleValue;
+        }
+
+        const std::string& GetString() const
+        {
+            return this->stringValue;
+        }
+
+        const std::wstring& GetWideString() const
+        {
+            return this->wideStringValue;
+        }
+
+        friend std::wostream& operator << (std::wostream& stream, const LogField& field)
+        {
+            stream << std::wstring(field.name.begin(), field.name.end()) << L'=';
+
+            switch (field.type)
+            {
+            case LogFieldType::Bool:
+                return stream << (field.boolValue ? L"true" : L"false");
+
+            case LogFieldType::Int:
+                return stream << field.intValue;
+
+            case LogFieldType::UInt:
+                return stream << field.uintValue;
+
+            case LogFieldType::Double:
+                return stream << field.doubleValue;
+
+            case LogFieldType::String:
+                return stream << std::wstring(field.stringValue.begin(), field.stringValue.end());
+
+            case LogFieldType::WideString:
+                return stream << field.wideStringValue;
+
+            default:
+                return stream;
+            }
+        }
+    };
+
+    typedef std::vector<LogField> LogFields;
+
+    inline LogField Field(const std::string& name, bool value)
+    {
+        return LogField(name, value);
+    }
+
+    inline LogField Field(const std::string& name, const char* value)
+    {
+        return LogField(name, std::string(value));
+    }
+
+    inline LogField Field(const std::string& name, const std::string& value)
+    {
+        return LogField(name, value);
+    }
+
+    inline LogField Field(const std::string& name, const wchar_t* value)
+    {
+        return LogField(name, std::wstring(value));
+    }
+
+    inline LogField Field(const std::string& name, const std::wstring& value)
+    {
+        return LogField(name, value);
+    }
+
+    template<typename T>
+    inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, LogField>::type
+    Field(const std::string& name, T value)
+    {
+        return LogField(name, static_cast<int64_t>(value));
+    }
+
+    template<typename T>
+    inline typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value, LogField>::type
+    Field(const std::string& name, T value)
+    {
+        return LogField(name, static_cast<uint64_t>(value));
+    }
+
+    template<typename T>
+    inline typename std::enable_if<std::is_floating_point<T>::value, LogField>::type
+    Field(const std::string& name, T value)
+    {
+        return LogField(name, static_cast<double>(value));
+    }
+
+    // Anything else is captured as text, using the same stream operators as the plain log messages.
+    template<typename T>
+    inline typename std::enable_if<!std::is_arithmetic<T>::value && is_streamable<std::wostream, T>::value, LogField>::type
+    Field(const std::string& name, const T& value)
+    {
+        std::wostringstream stream;
+        stream << value;
+        return LogField(name, stream.str());
+    }
+
+    template<typename T>
+    inline typename std::enable_if<
+        !std::is_arithmetic<T>::value && !is_streamable<std::wostream, T>::value && is_streamable<std::ostream, T>::value,
+        LogField>::type
+    Field(const std::string& name, const T& value)
+    {
+        std::ostringstream stream;
+        stream << value;
+        return LogField(name, stream.str());
+    }
+} }
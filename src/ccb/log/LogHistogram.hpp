@@ -0,0 +1,202 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ccb { namespace log
+{
+    namespace details
+    {
+        // Log-linear bucketing in the style of HDR histograms: every power of two is split into
+        // 16 linear sub-buckets, which bounds the relative error by ~6% for any magnitude.
+        struct HistogramBuckets
+        {
+            static const unsigned SUB_BUCKET_BITS = 4;
+
+            static const unsigned SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+            static const size_t COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+            static size_t Index(uint64_t value)
+            {
+                if (value < SUB_BUCKETS)
+                {
+                    return static_cast<size_t>(value);
+                }
+
+                unsigned msb = 63 - __builtin_clzll(value);
+                unsigned shift = msb - SUB_BUCKET_BITS;
+
+                return (shift + 1) * SUB_BUCKETS + ((value >> shift) & (SUB_BUCKETS - 1));
+            }
+
+            static uint64_t UpperBound(size_t index)
+            {
+                if (index < SUB_BUCKETS)
+                {
+                    return index;
+                }
+
+                unsigned shift = static_cast<unsigned>(index / SUB_BUCKETS - 1);
+                uint64_t mantissa = SUB_BUCKETS + (index % SUB_BUCKETS);
+
+                return ((mantissa + 1) << shift) - 1;
+            }
+        };
+    }
+
+    class LogHistogramSnapshot
+    {
+    private:
+
+        std::vector<uint64_t> counts;
+
+        uint64_t count = 0;
+
+        uint64_t sum = 0;
+
+        uint64_t max = 0;
+
+    public:
+
+        LogHistogramSnapshot()
+        {
+        }
+
+        LogHistogramSnapshot(std::vector<uint64_t>&& counts, uint64_t sum, uint64_t max)
+            : counts(std::move(counts))
+            , sum(sum)
+            , max(max)
+        {
+            for (auto c : this->counts)
+            {
+                this->count += c;
+            }
+        }
+
+    public:
+
+        uint64_t GetCount() const
+        {
+            return this->count;
+        }
+
+        uint64_t GetSum() const
+        {
+            return this->sum;
+        }
+
+        uint64_t GetMax() const
+        {
+            return this->max;
+        }
+
+        double GetMean() const
+        {
+            return (this->count == 0) ? 0.0 : static_cast<double>(this->sum) / this->count;
+        }
+
+        // Returns the highest value equivalent to the one at the given percentile (0..100).
+        uint64_t GetPercentile(double percentile) const
+        {
+            if (this->count == 0)
+            {
+                return 0;
+            }
+
+            auto rank = static_cast<uint64_t>(std::max(1.0, percentile / 100.0 * this->count + 0.5));
+            uint64_t seen = 0;
+
+            for (size_t i = 0; i < this->counts.size(); i++)
+            {
+                seen += this->counts[i];
+                if (seen >= rank)
+                {
+                    return std::min(this->max, details::HistogramBuckets::UpperBound(i));
+                }
+            }
+
+            return this->max;
+        }
+    };
+
+    // Histogram with a single writer and any number of concurrent snapshot readers.
+    class LogHistogram
+    {
+    private:
+
+        std::unique_ptr<std::atomic<uint64_t>[]> counts;
+
+        std::atomic<uint64_t> sum;
+
+        std::atomic<uint64_t> max;
+
+    public:
+
+        LogHistogram()
+            : counts(new std::atomic<uint64_t>[details::HistogramBuckets::COUNT])
+            , sum(0)
+            , max(0)
+        {
+            for (size_t i = 0; i < details::HistogramBuckets::COUNT; i++)
+            {
+                this->counts[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+    public:
+
+        void Record(uint64_t value)
+        {
+            auto& bucket = this->counts[details::HistogramBuckets::Index(value)];
+
+            bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            this->sum.store(this->sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+
+            if (value > this->max.load(std::memory_order_relaxed))
+            {
+                this->max.store(value, std::memory_order_relaxed);
+            }
+        }
+
+        LogHistogramSnapshot GetSnapshot() const
+        {
+            std::vector<uint64_t> result(details::HistogramBuckets::COUNT);
+
+            for (size_t i = 0; i < result.size(); i++)
+            {
+                result[i] = this->counts[i].load(std::memory_order_relaxed);
+            }
+
+            return LogHistogramSnapshot(
+                std::move(result),
+                this->sum.load(std::memory_order_relaxed),
+                this->max.load(std::memory_order_relaxed));
+        }
+    };
+} }
@@ -27,13 +27,20 @@
 #include <condition_variable>
 #include <iostream>
 #include <list>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <thread>
+#include <vector>
 
 #include <ccb/Time.hpp>
 #include <ccb/log/ILogTarget.hpp>
+#include <ccb/log/LogCallSite.hpp>
+#include <ccb/log/LogField.hpp>
+#include <ccb/log/LogHistogram.hpp>
 #include <ccb/log/LogLevel.hpp>
+#include <ccb/log/LogSinkStatistics.hpp>
 
 namespace ccb { namespace log
 {
@@ -51,11 +58,17 @@ namespace ccb { namespace log
 
             std::wstring message;
 
-            LogEntry(LogLevel level, const std::wstring& source, const std::wstring& message)
+            LogFields fields;
+
+            std::chrono::steady_clock::time_point enqueueTime;
+
+            LogEntry(LogLevel level, const std::wstring& source, const std::wstring& message, LogFields&& fields)
                 : time(std::chrono::system_clock::now())
                 , level(level)
                 , source(source)
                 , message(message)
+                , fields(std::move(fields))
+                , enqueueTime(std::chrono::steady_clock::now())
             {
             }
         };
@@ -72,14 +85,43 @@ namespace ccb { namespace log
 
         std::atomic<bool> exitDispatcher;
 
-        std::thread dispatchThread;
-
         std::set<ILogTarget*> targets;
 
+        size_t maxQueueSize = 0;
+
+        std::atomic<uint64_t> enqueued;
+
+        std::atomic<uint64_t> delivered;
+
+        std::atomic<uint64_t> dropped;
+
+        std::atomic<uint64_t> queueDepth;
+
+        LogHistogram latency;
+
+        LogHistogram batchSize;
+
+        std::map<ILogTarget*, std::unique_ptr<LogHistogram>> targetTimes;
+
+        std::mutex callSiteMutex;
+
+        // Rate limited call sites whose suppressed counts are reported every summaryInterval.
+        std::set<LogCallSite*> callSites;
+
+        std::chrono::milliseconds summaryInterval;
+
+        // Started last, once everything the dispatcher touches is constructed.
+        std::thread dispatchThread;
+
     public:
 
         LogSink()
             : exitDispatcher(false)
+            , enqueued(0)
+            , delivered(0)
+            , dropped(0)
+            , queueDepth(0)
+            , summaryInterval(1000)
             , dispatchThread(&LogSink::DispatchThread, this)
         {
         }
@@ -90,6 +132,13 @@ namespace ccb { namespace log
             this->entriesUpdated.notify_all();
 
             this->dispatchThread.join();
+
+            std::lock_guard<std::mutex> lock(this->callSiteMutex);
+
+            for (auto callSite : this->callSites)
+            {
+                callSite->detach = nullptr;
+            }
         }
 
     public:
@@ -99,6 +148,7 @@ namespace ccb { namespace log
             std::lock_guard<std::mutex> lock(this->targetMutex);
 
             this->targets.insert(target);
+            this->targetTimes[target] = std::unique_ptr<LogHistogram>(new LogHistogram());
         }
 
         void RemoveTarget(ILogTarget* target)
@@ -106,18 +156,136 @@ namespace ccb { namespace log
             std::lock_guard<std::mutex> lock(this->targetMutex);
 
             this->targets.erase(target);
+            this->targetTimes.erase(target);
+        }
+
+        // Entries written while this many are already waiting for dispatch are dropped. Zero means no limit.
+        void SetMaxQueueSize(size_t size)
+        {
+            std::lock_guard<std::mutex> lock(this->dispatchMutex);
+
+            this->maxQueueSize = size;
+        }
+
+        // How often the dispatcher reports messages suppressed by rate limited call sites.
+        void SetSummaryInterval(std::chrono::milliseconds interval)
+        {
+            std::lock_guard<std::mutex> lock(this->dispatchMutex);
+
+            this->summaryInterval = interval;
+        }
+
+        // Registers the call site for suppressed count summaries, written with its source and level.
+        void AttachCallSite(LogCallSite& callSite, const std::wstring& source, LogLevel level)
+        {
+            std::lock_guard<std::mutex> lock(this->callSiteMutex);
+
+            if (callSite.IsAttached())
+            {
+                return;
+            }
+
+            callSite.source = source;
+            callSite.level = level;
+            callSite.detach = [this](LogCallSite* site)
+            {
+                std::lock_guard<std::mutex> lock(this->callSiteMutex);
+
+                this->callSites.erase(site);
+            };
+
+            this->callSites.insert(&callSite);
+            callSite.attached.store(true, std::memory_order_release);
+        }
+
+        // Writes a summary entry for every attached call site that suppressed messages since the last
+        // report, so counts are not lost when a storm stops. Called by the dispatcher periodically.
+        void ReportSuppressed()
+        {
+            struct Summary
+            {
+                std::wstring source;
+
+                LogLevel level;
+
+                uint64_t count;
+            };
+
+            std::vector<Summary> summaries;
+
+            {
+                std::lock_guard<std::mutex> lock(this->callSiteMutex);
+
+                for (auto callSite : this->callSites)
+                {
+                    auto count = callSite->TakeSuppressed();
+                    if (count > 0)
+                    {
+                        summaries.push_back(Summary{callSite->source, callSite->level, count});
+                    }
+                }
+            }
+
+            for (const auto& summary : summaries)
+            {
+                LogFields fields;
+                fields.push_back(Field("suppressed", summary.count));
+
+                this->WriteMessage(summary.level, summary.source, L"Messages suppressed", std::move(fields));
+            }
+        }
+
+        LogSinkStatistics GetStatistics()
+        {
+            LogSinkStatistics result;
+
+            result.enqueued = this->enqueued.load(std::memory_order_relaxed);
+            result.delivered = this->delivered.load(std::memory_order_relaxed);
+            result.dropped = this->dropped.load(std::memory_order_relaxed);
+            result.queueDepth = this->queueDepth.load(std::memory_order_relaxed);
+            result.latency = this->latency.GetSnapshot();
+            result.batchSize = this->batchSize.GetSnapshot();
+
+            std::lock_guard<std::mutex> lock(this->targetMutex);
+
+            for (const auto& pair : this->targetTimes)
+            {
+                result.targetTimes[pair.first] = pair.second->GetSnapshot();
+            }
+
+            return result;
         }
 
         void WriteMessage(LogLevel level, const std::wstring& source, const std::wstring& message)
+        {
+            this->WriteMessage(level, source, message, LogFields());
+        }
+
+        void WriteMessage(LogLevel level, const std::wstring& source, const std::wstring& message, LogFields&& fields)
         {
             if ((level == LogLevel::Error) || (level == LogLevel::Critical))
             {
-                std::wcerr << source << " L[" << level << "]: " << message << std::endl;
+                std::wcerr << source << " L[" << level << "]: " << message;
+
+                for (const auto& field : fields)
+                {
+                    std::wcerr << L' ' << field;
+                }
+
+                std::wcerr << std::endl;
             }
 
             std::lock_guard<std::mutex> lock(this->dispatchMutex);
 
-            this->entries.emplace_back(level, source, message);
+            if ((this->maxQueueSize > 0) && (this->queueDepth.load(std::memory_order_relaxed) >= this->maxQueueSize))
+            {
+                this->dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            this->entries.emplace_back(level, source, message, std::move(fields));
+            this->enqueued.fetch_add(1, std::memory_order_relaxed);
+            this->queueDepth.fetch_add(1, std::memory_order_relaxed);
             this->entriesUpdated.notify_all();
         }
 
@@ -133,13 +301,45 @@ namespace ccb { namespace log
 
         void DispatchThread()
         {
+            auto lastSummary = std::chrono::steady_clock::now();
+
             while (!this->exitDispatcher.load())
             {
                 auto entries = this->GetAllEntries();
+
+                if (std::chrono::steady_clock::now() - lastSummary >= this->GetSummaryInterval())
+                {
+                    this->ReportSuppressed();
+                    lastSummary = std::chrono::steady_clock::now();
+                }
+
+                if (entries.empty())
+                {
+                    continue;
+                }
+
+                this->batchSize.Record(entries.size());
+
                 for (auto& entry : entries)
                 {
                     this->DeliverEntry(entry);
+
+                    this->latency.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - entry.enqueueTime).count());
+                    this->delivered.fetch_add(1, std::memory_order_relaxed);
                 }
+
+                this->FlushTargets();
+            }
+        }
+
+        void FlushTargets()
+        {
+            std::lock_guard<std::mutex> lock(this->targetMutex);
+
+            for (auto target : this->targets)
+            {
+                target->Flush();
             }
         }
 
@@ -149,10 +349,22 @@ namespace ccb { namespace log
 
             for (auto target : this->targets)
             {
-                target->LogMessage(entry.time, entry.level, entry.source, entry.message);
+                auto start = std::chrono::steady_clock::now();
+
+                target->LogStructuredMessage(entry.time, entry.level, entry.source, entry.message, entry.fields);
+
+                this->targetTimes[target]->Record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count());
             }
         }
 
+        std::chrono::milliseconds GetSummaryInterval()
+        {
+            std::lock_guard<std::mutex> lock(this->dispatchMutex);
+
+            return this->summaryInterval;
+        }
+
         std::list<LogEntry> GetAllEntries()
         {
             std::list<LogEntry> result;
@@ -161,8 +373,10 @@ namespace ccb { namespace log
 
             if (this->entries.size() == 0)
             {
-                this->entriesUpdated.wait(
+                // Wakes up on time for the suppressed count summaries.
+                this->entriesUpdated.wait_for(
                     lock,
+                    this->summaryInterval,
                     [this]()
                     {
                         return (this->entries.size() > 0) || this->exitDispatcher.load();
@@ -170,6 +384,7 @@ namespace ccb { namespace log
             }
 
             this->entries.swap(result);
+            this->queueDepth.store(0, std::memory_order_relaxed);
 
             return result;
         }
@@ -0,0 +1,53 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+#include <ccb/log/ILogTarget.hpp>
+#include <ccb/log/LogHistogram.hpp>
+
+namespace ccb { namespace log
+{
+    // Point-in-time view of the LogSink counters. Durations are in nanoseconds.
+    struct LogSinkStatistics
+    {
+        uint64_t enqueued = 0;
+
+        uint64_t delivered = 0;
+
+        uint64_t dropped = 0;
+
+        uint64_t queueDepth = 0;
+
+        // Time from WriteMessage to the entry being handed to all targets.
+        LogHistogramSnapshot latency;
+
+        // Number of entries picked up by the dispatcher at once.
+        LogHistogramSnapshot batchSize;
+
+        // Time spent in each target's LogMessage call.
+        std::map<ILogTarget*, LogHistogramSnapshot> targetTimes;
+    };
+} }
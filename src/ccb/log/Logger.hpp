@@ -25,8 +25,30 @@
 #include <sstream>
 
 #include <ccb/log/IsStreamable.hpp>
+#include <ccb/log/LogCallSite.hpp>
+#include <ccb/log/LogField.hpp>
 #include <ccb/log/LogSink.hpp>
 
+#define CCB_LOG_LIMITED(logger, level, messagesPerSecond, burst, ...) \
+    do \
+    { \
+        static ccb::log::LogCallSite ccbLogCallSite((messagesPerSecond), (burst)); \
+        if (ccbLogCallSite.Allow()) \
+        { \
+            (logger).WriteAdmitted(ccbLogCallSite, (level), __VA_ARGS__); \
+        } \
+    } while (false)
+
+#define CCB_LOG_SAMPLED(logger, level, sampleRate, ...) \
+    do \
+    { \
+        static ccb::log::LogCallSite ccbLogCallSite(0, 1, (sampleRate)); \
+        if (ccbLogCallSite.Allow()) \
+        { \
+            (logger).WriteAdmitted(ccbLogCallSite, (level), __VA_ARGS__); \
+        } \
+    } while (false)
+
 namespace ccb { namespace log
 {
     class Logger
@@ -76,39 +98,77 @@ namespace ccb { namespace log
     public:
 
         template<typename... Params>
-        void Write(LogLevel level, Params... params)
+        void Write(LogLevel level, const Params&... params)
         {
             std::wostringstream stream;
-            this->Write(stream, level, params...);
-            this->sink->WriteMessage(level, this->name, stream.str());
+            LogFields fields;
+            this->Write(stream, fields, level, params...);
+            this->sink->WriteMessage(level, this->name, stream.str(), std::move(fields));
+        }
+
+        // Writes the message only if the call site admits it. The CCB_LOG_LIMITED and CCB_LOG_SAMPLED
+        // macros check the call site before the arguments are evaluated, which is cheaper.
+        template<typename... Params>
+        bool Write(LogCallSite& callSite, LogLevel level, const Params&... params)
+        {
+            if (!callSite.Allow())
+            {
+                return false;
+            }
+
+            this->WriteAdmitted(callSite, level, params...);
+
+            return true;
         }
 
+        // Writes a message the call site has admitted. The first message written after some were
+        // suppressed carries their count in the "suppressed" field; counts of storms that stop are
+        // reported by the sink.
         template<typename... Params>
-        void Trace(Params... params)
+        void WriteAdmitted(LogCallSite& callSite, LogLevel level, const Params&... params)
+        {
+            if (!callSite.IsAttached())
+            {
+                this->sink->AttachCallSite(callSite, this->name, level);
+            }
+
+            auto suppressed = callSite.TakeSuppressed();
+            if (suppressed > 0)
+            {
+                this->Write(level, params..., Field("suppressed", suppressed));
+            }
+            else
+            {
+                this->Write(level, params...);
+            }
+        }
+
+        template<typename... Params>
+        void Trace(const Params&... params)
         {
             this->Write(LogLevel::Trace, params...);
         }
 
         template<typename... Params>
-        void Info(Params... params)
+        void Info(const Params&... params)
         {
             this->Write(LogLevel::Info, params...);
         }
 
         template<typename... Params>
-        void Warn(Params... params)
+        void Warn(const Params&... params)
         {
             this->Write(LogLevel::Warning, params...);
         }
 
         template<typename... Params>
-        void Error(Params... params)
+        void Error(const Params&... params)
         {
             this->Write(LogLevel::Error, params...);
         }
 
         template<typename... Params>
-        void Critical(Params... params)
+        void Critical(const Params&... params)
         {
             this->Write(LogLevel::Critical, params...);
         }
@@ -116,21 +176,29 @@ namespace ccb { namespace log
     private:
 
         template<typename Arg0, typename... Params>
-        void Write(std::wostream& stream, LogLevel level, Arg0 arg0, Params... params)
+        void Write(std::wostream& stream, LogFields& fields, LogLevel level, const Arg0& arg0, const Params&... params)
         {
             this->WriteValue(stream, arg0);
 
-            this->Write(stream, level, params...);
+            this->Write(stream, fields, level, params...);
         }
 
-        void Write(std::wostream& stream, LogLevel level)
+        template<typename... Params>
+        void Write(std::wostream& stream, LogFields& fields, LogLevel level, const LogField& field, const Params&... params)
+        {
+            fields.push_back(field);
+
+            this->Write(stream, fields, level, params...);
+        }
+
+        void Write(std::wostream& stream, LogFields& fields, LogLevel level)
         {
         }
 
         template<typename T>
         void WriteValue(
             std::wostream& stream,
-            T value,
+            const T& value,
             typename std::enable_if<PreferWide<T>::value, T>::type* dummyPtr = nullptr)
         {
             stream << value;
@@ -139,7 +207,7 @@ namespace ccb { namespace log
         template<typename T>
         void WriteValue(
             std::wostream& stream,
-            T value,
+            const T& value,
             typename std::enable_if<PreferShort<T>::value, T>::type* dummyPtr = nullptr)
         {
             std::ostringstream substream;
@@ -0,0 +1,807 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <ccb/binary/Endianness.hpp>
+#include <ccb/charset/Utf8.hpp>
+#include <ccb/filesystem/MappedFile.hpp>
+#include <ccb/tree/TreeArray.hpp>
+#include <ccb/tree/TreeMap.hpp>
+#include <ccb/tree/TreeValue.hpp>
+
+namespace ccb { namespace tree
+{
+    namespace details
+    {
+        enum CborMajorType
+        {
+            CBOR_UNSIGNED = 0,
+            CBOR_NEGATIVE = 1,
+            CBOR_BYTES = 2,
+            CBOR_TEXT = 3,
+            CBOR_ARRAY = 4,
+            CBOR_MAP = 5,
+            CBOR_TAG = 6,
+            CBOR_SIMPLE = 7
+        };
+
+        enum
+        {
+            CBOR_FALSE = 0xf4,
+            CBOR_TRUE = 0xf5,
+            CBOR_NULL = 0xf6,
+            CBOR_UNDEFINED = 0xf7,
+            CBOR_HALF = 0xf9,
+            CBOR_FLOAT = 0xfa,
+            CBOR_DOUBLE = 0xfb,
+
+            /// Tag of a byte string that holds an encoded CBOR item (RFC 8949, 3.4.5.1).
+            CBOR_EMBEDDED_TAG = 24,
+
+            /// Deeper data is rejected rather than risking the stack.
+            CBOR_MAX_DEPTH = 1024
+        };
+
+        /// Initial byte of an item and the argument that follows it.
+        struct CborHead
+        {
+            uint8_t major;
+
+            uint8_t initial;
+
+            uint64_t argument;
+
+            /// First byte after the head.
+            const uint8_t* payload;
+        };
+
+        inline CborHead ReadCborHead(const uint8_t* pos, const uint8_t* end)
+        {
+            if (pos >= end)
+            {
+                throw std::runtime_error("Truncated CBOR data");
+            }
+
+            CborHead head;
+            head.initial = *pos;
+            head.major = static_cast<uint8_t>(head.initial >> 5);
+
+            auto info = head.initial & 0x1f;
+            pos++;
+
+            if (info < 24)
+            {
+                head.argument = info;
+            }
+            else if (info <= 27)
+            {
+                auto size = static_cast<size_t>(1) << (info - 24);
+                if (static_cast<size_t>(end - pos) < size)
+                {
+                    throw std::runtime_error("Truncated CBOR data");
+                }
+
+                switch (size)
+                {
+                case 1:
+                    head.argument = *pos;
+                    break;
+
+                case 2:
+                    head.argument = binary::LoadBE<uint16_t>(pos);
+                    break;
+
+                case 4:
+                    head.argument = binary::LoadBE<uint32_t>(pos);
+                    break;
+
+                default:
+                    head.argument = binary::LoadBE<uint64_t>(pos);
+                }
+
+                pos += size;
+            }
+            else
+            {
+                throw std::runtime_error("Indefinite length CBOR items are not supported");
+            }
+
+            head.payload = pos;
+
+            if (((head.major == CBOR_BYTES) || (head.major == CBOR_TEXT)) && (static_cast<uint64_t>(end - pos) < head.argument))
+            {
+                throw std::runtime_error("Truncated CBOR data");
+            }
+
+            return head;
+        }
+
+        /// Returns the end of the item at pos.
+        inline const uint8_t* SkipCborItem(const uint8_t* pos, const uint8_t* end, size_t depth = 0)
+        {
+            if (depth > CBOR_MAX_DEPTH)
+            {
+                throw std::runtime_error("CBOR data is nested too deeply");
+            }
+
+            auto head = ReadCborHead(pos, end);
+
+            switch (head.major)
+            {
+            case CBOR_BYTES:
+            case CBOR_TEXT:
+                return head.payload + head.argument;
+
+            case CBOR_ARRAY:
+            case CBOR_MAP:
+            {
+                auto count = (head.major == CBOR_MAP) ? 2 * head.argument : head.argument;
+
+                pos = head.payload;
+                for (uint64_t i = 0; i < count; i++)
+                {
+                    pos = SkipCborItem(pos, end, depth + 1);
+                }
+
+                return pos;
+            }
+
+            case CBOR_TAG:
+                return SkipCborItem(head.payload, end, depth + 1);
+
+            default:
+                return head.payload;
+            }
+        }
+
+        inline double DecodeHalfFloat(uint16_t bits)
+        {
+            auto exponent = (bits >> 10) & 0x1f;
+            auto mantissa = bits & 0x3ff;
+
+            double value;
+            if (exponent == 0)
+            {
+                value = std::ldexp(mantissa, -24);
+            }
+            else if (exponent != 31)
+            {
+                value = std::ldexp(mantissa + 1024, exponent - 25);
+            }
+            else
+            {
+                value = (mantissa == 0) ? INFINITY : NAN;
+            }
+
+            return (bits & 0x8000) ? -value : value;
+        }
+
+        /// Encodes trees. Maps and arrays below the root are wrapped into embedded CBOR byte strings, so
+        /// that readers can step over them without looking inside.
+        class CborTreeWriter
+        {
+        private:
+
+            std::vector<uint8_t>& output;
+
+            std::string buffer;
+
+        public:
+
+            CborTreeWriter(std::vector<uint8_t>& output)
+                : output(output)
+            {
+            }
+
+        public:
+
+            void Write(const TreeNode& node, bool wrap)
+            {
+                if (node.GetType() == TreeNodeType::Value)
+                {
+                    this->WriteValue(static_cast<const TreeValue&>(node));
+                    return;
+                }
+
+                size_t sizePos = 0;
+
+                if (wrap)
+                {
+                    // Tag and a byte string with a four byte length, filled in once the contents are written.
+                    uint8_t header[] = { 0xd8, CBOR_EMBEDDED_TAG, (CBOR_BYTES << 5) | 26, 0, 0, 0, 0 };
+                    this->output.insert(this->output.end(), header, header + sizeof(header));
+                    sizePos = this->output.size() - 4;
+                }
+
+                if (node.GetType() == TreeNodeType::Map)
+                {
+                    const auto& nodes = static_cast<const TreeMap&>(node).GetNodes();
+                    this->WriteHead(CBOR_MAP, nodes.size());
+
+                    for (const auto& pair : nodes)
+                    {
+                        this->WriteText(pair.first);
+                        this->Write(*pair.second, true);
+                    }
+                }
+                else
+                {
+                    const auto& nodes = static_cast<const TreeArray&>(node).GetNodes();
+                    this->WriteHead(CBOR_ARRAY, nodes.size());
+
+                    for (const auto& item : nodes)
+                    {
+                        this->Write(*item, true);
+                    }
+                }
+
+                if (wrap)
+                {
+                    auto size = this->output.size() - sizePos - 4;
+                    if (size > UINT32_MAX)
+                    {
+                        throw std::runtime_error("CBOR container is too large");
+                    }
+
+                    binary::StoreBE(&this->output[sizePos], static_cast<uint32_t>(size));
+                }
+            }
+
+        private:
+
+            void WriteHead(uint8_t major, uint64_t argument)
+            {
+                uint8_t head[9];
+                size_t size;
+
+                if (argument < 24)
+                {
+                    head[0] = static_cast<uint8_t>((major << 5) | argument);
+                    size = 1;
+                }
+                else if (argument <= UINT8_MAX)
+                {
+                    head[0] = static_cast<uint8_t>((major << 5) | 24);
+                    head[1] = static_cast<uint8_t>(argument);
+                    size = 2;
+                }
+                else if (argument <= UINT16_MAX)
+                {
+                    head[0] = static_cast<uint8_t>((major << 5) | 25);
+                    binary::StoreBE(head + 1, static_cast<uint16_t>(argument));
+                    size = 3;
+                }
+                else if (argument <= UINT32_MAX)
+                {
+                    head[0] = static_cast<uint8_t>((major << 5) | 26);
+                    binary::StoreBE(head + 1, static_cast<uint32_t>(argument));
+                    size = 5;
+                }
+                else
+                {
+                    head[0] = static_cast<uint8_t>((major << 5) | 27);
+                    binary::StoreBE(head + 1, argument);
+                    size = 9;
+                }
+
+                this->output.insert(this->output.end(), head, head + size);
+            }
+
+            void WriteText(const std::wstring& text)
+            {
+                charset::WideToUtf8(text.data(), text.size(), this->buffer);
+
+                this->WriteHead(CBOR_TEXT, this->buffer.size());
+                this->output.insert(this->output.end(), this->buffer.begin(), this->buffer.end());
+            }
+
+            void WriteValue(const TreeValue& value)
+            {
+                switch (value.GetValueType())
+                {
+                case TreeValueType::Null:
+                    this->output.push_back(CBOR_NULL);
+                    break;
+
+                case TreeValueType::Bool:
+                    this->output.push_back(value.GetValue<bool>() ? CBOR_TRUE : CBOR_FALSE);
+                    break;
+
+                case TreeValueType::Int:
+                {
+                    auto number = value.GetValue<int64_t>();
+
+                    if (number >= 0)
+                    {
+                        this->WriteHead(CBOR_UNSIGNED, static_cast<uint64_t>(number));
+                    }
+                    else
+                    {
+                        this->WriteHead(CBOR_NEGATIVE, ~static_cast<uint64_t>(number));
+                    }
+                    break;
+                }
+
+                case TreeValueType::Double:
+                {
+                    auto number = value.GetValue<double>();
+                    auto single = static_cast<float>(number);
+
+                    // Floats are used when they hold the value exactly, as preferred serialization asks.
+                    if ((static_cast<double>(single) == number) || std::isnan(number))
+                    {
+                        uint8_t bytes[5] = { CBOR_FLOAT };
+                        binary::StoreBE(bytes + 1, single);
+                        this->output.insert(this->output.end(), bytes, bytes + 5);
+                    }
+                    else
+                    {
+                        uint8_t bytes[9] = { CBOR_DOUBLE };
+                        binary::StoreBE(bytes + 1, number);
+                        this->output.insert(this->output.end(), bytes, bytes + 9);
+                    }
+                    break;
+                }
+
+                default:
+                    this->WriteText(value.GetString());
+                }
+            }
+        };
+    }
+
+    /// Handle to an item of CBOR data that is read in place, without building TreeNode objects.
+    /// Cheap to copy, stays valid while the data exists. Map members are found by a linear scan
+    /// that compares the UTF-8 names as they are stored.
+    class CborNode
+    {
+    private:
+
+        const uint8_t* item = nullptr;
+
+        /// End of the enclosing data; an embedded item ends with its byte string.
+        const uint8_t* end = nullptr;
+
+        size_t depth = 0;
+
+    public:
+
+        CborNode()
+        {
+        }
+
+        /// Item starting at data; embedded CBOR byte strings and other tags are looked through.
+        CborNode(const uint8_t* data, const uint8_t* end, size_t depth = 0)
+            : item(data)
+            , end(end)
+            , depth(depth)
+        {
+            if (depth > details::CBOR_MAX_DEPTH)
+            {
+                throw std::runtime_error("CBOR data is nested too deeply");
+            }
+
+            while (true)
+            {
+                auto head = details::ReadCborHead(this->item, this->end);
+                if (head.major != details::CBOR_TAG)
+                {
+                    break;
+                }
+
+                if (++this->depth > details::CBOR_MAX_DEPTH)
+                {
+                    throw std::runtime_error("CBOR data is nested too deeply");
+                }
+
+                auto inner = details::ReadCborHead(head.payload, this->end);
+                if ((head.argument == details::CBOR_EMBEDDED_TAG) && (inner.major == details::CBOR_BYTES))
+                {
+                    this->item = inner.payload;
+                    this->end = inner.payload + inner.argument;
+                }
+                else
+                {
+                    this->item = head.payload;
+                }
+            }
+        }
+
+    public:
+
+        TreeNodeType GetType() const
+        {
+            switch (*this->item >> 5)
+            {
+            case details::CBOR_MAP:
+                return TreeNodeType::Map;
+
+            case details::CBOR_ARRAY:
+                return TreeNodeType::Array;
+
+            default:
+                return TreeNodeType::Value;
+            }
+        }
+
+        TreeValueType GetValueType() const
+        {
+            auto head = details::ReadCborHead(this->item, this->end);
+
+            switch (head.major)
+            {
+            case details::CBOR_UNSIGNED:
+            case details::CBOR_NEGATIVE:
+                return (head.argument <= static_cast<uint64_t>(INT64_MAX)) ? TreeValueType::Int : TreeValueType::String;
+
+            case details::CBOR_TEXT:
+                return TreeValueType::String;
+
+            case details::CBOR_SIMPLE:
+                switch (head.initial)
+                {
+                case details::CBOR_FALSE:
+                case details::CBOR_TRUE:
+                    return TreeValueType::Bool;
+
+                case details::CBOR_NULL:
+                case details::CBOR_UNDEFINED:
+                    return TreeValueType::Null;
+
+                case details::CBOR_HALF:
+                case details::CBOR_FLOAT:
+                case details::CBOR_DOUBLE:
+                    return TreeValueType::Double;
+                }
+            }
+
+            throw std::runtime_error("Unsupported CBOR item");
+        }
+
+        /// Number of children of a map or an array.
+        size_t GetSize() const
+        {
+            if (this->GetType() == TreeNodeType::Value)
+            {
+                throw std::runtime_error("Is not of requested type");
+            }
+
+            return static_cast<size_t>(details::ReadCborHead(this->item, this->end).argument);
+        }
+
+        /// Child of a map or an array by position.
+        CborNode Get(size_t idx) const
+        {
+            auto size = this->GetSize();
+            if (size <= idx)
+            {
+                throw std::runtime_error("Index out of range");
+            }
+
+            auto isMap = (this->GetType() == TreeNodeType::Map);
+            auto pos = details::ReadCborHead(this->item, this->end).payload;
+
+            for (size_t i = 0; i < idx; i++)
+            {
+                if (isMap)
+                {
+                    pos = this->Skip(pos);
+                }
+
+                pos = this->Skip(pos);
+            }
+
+            if (isMap)
+            {
+                pos = this->Skip(pos);
+            }
+
+            return CborNode(pos, this->end, this->depth + 1);
+        }
+
+        bool HasNode(const std::wstring& name) const
+        {
+            return this->FindMember(name) != nullptr;
+        }
+
+        CborNode GetNode(const std::wstring& name) const
+        {
+            auto member = this->FindMember(name);
+            if (member == nullptr)
+            {
+                throw std::runtime_error("No such node");
+            }
+
+            return CborNode(member, this->end, this->depth + 1);
+        }
+
+        TreeValue GetTreeValue() const
+        {
+            auto head = details::ReadCborHead(this->item, this->end);
+            TreeValue value;
+
+            switch (this->GetValueType())
+            {
+            case TreeValueType::Null:
+                value.SetNull();
+                break;
+
+            case TreeValueType::Bool:
+                value.SetValue(head.initial == details::CBOR_TRUE);
+                break;
+
+            case TreeValueType::Double:
+                if (head.initial == details::CBOR_HALF)
+                {
+                    value.SetValue(details::DecodeHalfFloat(static_cast<uint16_t>(head.argument)));
+                }
+                else if (head.initial == details::CBOR_FLOAT)
+                {
+                    value.SetValue(static_cast<double>(binary::LoadBE<float>(head.payload - 4)));
+                }
+                else
+                {
+                    value.SetValue(binary::LoadBE<double>(head.payload - 8));
+                }
+                break;
+
+            default:
+                if (head.major == details::CBOR_UNSIGNED)
+                {
+                    value.SetValue(head.argument);
+                }
+                else if (head.major == details::CBOR_NEGATIVE)
+                {
+                    if (head.argument > static_cast<uint64_t>(INT64_MAX))
+                    {
+                        throw std::runtime_error("CBOR integer is out of range");
+                    }
+
+                    value.SetValue(-1 - static_cast<int64_t>(head.argument));
+                }
+                else
+                {
+                    std::wstring text;
+                    charset::Utf8ToWide(reinterpret_cast<const char*>(head.payload), static_cast<size_t>(head.argument), text);
+                    value.SetString(text);
+                }
+            }
+
+            return value;
+        }
+
+        std::wstring GetString() const
+        {
+            return this->GetTreeValue().GetString();
+        }
+
+        template<typename ValueType>
+        ValueType GetValue() const
+        {
+            return this->GetTreeValue().GetValue<ValueType>();
+        }
+
+        /// Copies the item into a TreeNode hierarchy.
+        std::unique_ptr<TreeNode> ToTreeNode() const
+        {
+            auto type = this->GetType();
+
+            if (type == TreeNodeType::Value)
+            {
+                return std::unique_ptr<TreeNode>(new TreeValue(this->GetTreeValue()));
+            }
+
+            auto head = details::ReadCborHead(this->item, this->end);
+            auto pos = head.payload;
+
+            if (type == TreeNodeType::Array)
+            {
+                auto array = std::unique_ptr<TreeArray>(new TreeArray());
+
+                for (uint64_t i = 0; i < head.argument; i++)
+                {
+                    array->Add(CborNode(pos, this->end, this->depth + 1).ToTreeNode());
+                    pos = this->Skip(pos);
+                }
+
+                return std::move(array);
+            }
+
+            auto map = std::unique_ptr<TreeMap>(new TreeMap());
+            map->Reserve(static_cast<size_t>(head.argument));
+
+            std::wstring name;
+
+            for (uint64_t i = 0; i < head.argument; i++)
+            {
+                auto key = this->ReadKey(pos);
+                charset::Utf8ToWide(reinterpret_cast<const char*>(key.payload), static_cast<size_t>(key.argument), name);
+                pos = key.payload + key.argument;
+
+                if (!map->Add(name, CborNode(pos, this->end, this->depth + 1).ToTreeNode()))
+                {
+                    throw std::runtime_error("Duplicate field: " + std::string(reinterpret_cast<const char*>(key.payload), static_cast<size_t>(key.argument)));
+                }
+
+                pos = this->Skip(pos);
+            }
+
+            return std::move(map);
+        }
+
+    private:
+
+        const uint8_t* Skip(const uint8_t* pos) const
+        {
+            return details::SkipCborItem(pos, this->end, this->depth + 1);
+        }
+
+        details::CborHead ReadKey(const uint8_t* pos) const
+        {
+            auto key = details::ReadCborHead(pos, this->end);
+            if (key.major != details::CBOR_TEXT)
+            {
+                throw std::runtime_error("CBOR map keys must be text");
+            }
+
+            return key;
+        }
+
+        /// Returns the value of the member, or nullptr.
+        const uint8_t* FindMember(const std::wstring& name) const
+        {
+            if (this->GetType() != TreeNodeType::Map)
+            {
+                throw std::runtime_error("Expected field to be a map");
+            }
+
+            std::string utf8Name;
+            charset::WideToUtf8(name.data(), name.size(), utf8Name);
+
+            auto head = details::ReadCborHead(this->item, this->end);
+            auto pos = head.payload;
+
+            for (uint64_t i = 0; i < head.argument; i++)
+            {
+                auto key = this->ReadKey(pos);
+                pos = key.payload + key.argument;
+
+                if ((key.argument == utf8Name.size()) && (memcmp(key.payload, utf8Name.data(), utf8Name.size()) == 0))
+                {
+                    return pos;
+                }
+
+                pos = this->Skip(pos);
+            }
+
+            return nullptr;
+        }
+    };
+
+    /// CBOR data read in place, from a memory mapped file or from memory.
+    class CborDocument
+    {
+    private:
+
+        std::unique_ptr<filesystem::MappedFile> file;
+
+        std::vector<uint8_t> bytes;
+
+        CborNode root;
+
+    public:
+
+        CborDocument(const filesystem::Path& path)
+            : file(new filesystem::MappedFile(path))
+        {
+            this->Init(this->file->GetData(), this->file->GetSize());
+        }
+
+        CborDocument(std::vector<uint8_t>&& bytes)
+            : bytes(std::move(bytes))
+        {
+            this->Init(this->bytes.data(), this->bytes.size());
+        }
+
+        CborDocument(const CborDocument&) = delete;
+
+        CborDocument& operator = (const CborDocument&) = delete;
+
+    public:
+
+        CborNode GetRoot() const
+        {
+            return this->root;
+        }
+
+    private:
+
+        void Init(const uint8_t* data, size_t size)
+        {
+            if (details::SkipCborItem(data, data + size) != data + size)
+            {
+                throw std::runtime_error("Unexpected data after CBOR item");
+            }
+
+            this->root = CborNode(data, data + size);
+        }
+    };
+
+    /// Stores trees as CBOR (RFC 8949). Nested maps and arrays are wrapped into embedded CBOR byte
+    /// strings (tag 24), which any CBOR decoder understands and which let CborNode skip them in
+    /// constant time.
+    class CborTreeSerializer
+    {
+    public:
+
+        void Serialize(const TreeNode& node, std::ostream& stream)
+        {
+            auto bytes = this->Serialize(node);
+            stream.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        }
+
+        std::vector<uint8_t> Serialize(const TreeNode& node)
+        {
+            std::vector<uint8_t> bytes;
+
+            details::CborTreeWriter writer(bytes);
+            writer.Write(node, false);
+
+            return bytes;
+        }
+
+        std::unique_ptr<TreeNode> Deserialize(std::istream& stream)
+        {
+            std::vector<uint8_t> bytes;
+            char buffer[65536];
+
+            while (stream)
+            {
+                stream.read(buffer, sizeof(buffer));
+                bytes.insert(bytes.end(), buffer, buffer + stream.gcount());
+            }
+
+            return this->Deserialize(bytes.data(), bytes.size());
+        }
+
+        std::unique_ptr<TreeNode> Deserialize(const uint8_t* data, size_t size)
+        {
+            if (details::SkipCborItem(data, data + size) != data + size)
+            {
+                throw std::runtime_error("Unexpected data after CBOR item");
+            }
+
+            return CborNode(data, data + size).ToTreeNode();
+        }
+    };
+} }
@@ -0,0 +1,180 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <ccb/tree/JsonReader.hpp>
+#include <ccb/tree/JsonTreeSerializer.hpp>
+#include <ccb/tree/TreePath.hpp>
+
+namespace ccb { namespace tree
+{
+    /// Extracts the values of several paths from JSON text in a single pass. Only the containers
+    /// on the way to a path are parsed, everything else is skipped by the structural index. A value
+    /// a path refers to is built into a TreeNode and passed to the callback.
+    class JsonPathExtractor
+    {
+    private:
+
+        std::vector<TreePath> paths;
+
+        /// Paths still matching at each depth, reused between values.
+        std::vector<std::vector<size_t>> candidates;
+
+    public:
+
+        /// Returns the number the callback gets for values of this path.
+        size_t Add(const TreePath& path)
+        {
+            this->paths.push_back(path);
+            return this->paths.size() - 1;
+        }
+
+        /// Calls callback(pathNumber, const TreeNode& node) for every value a path refers to. Values of
+        /// each path come in document order; the node lives until the callback returns.
+        template<typename Callback>
+        void Extract(const char* data, size_t size, Callback callback)
+        {
+            JsonReader reader(data, size);
+
+            this->candidates.resize(1);
+            this->candidates[0].clear();
+
+            for (size_t i = 0; i < this->paths.size(); i++)
+            {
+                this->candidates[0].push_back(i);
+            }
+
+            this->ReadValue(reader, reader.Next(), 0, callback);
+
+            // Fails if anything follows the root value.
+            reader.Next();
+        }
+
+    private:
+
+        /// Handles a value whose path matches the first depth steps of the paths in candidates[depth].
+        template<typename Callback>
+        void ReadValue(JsonReader& reader, JsonEvent first, size_t depth, Callback& callback)
+        {
+            bool matched = false;
+            bool deeper = false;
+
+            for (auto path : this->candidates[depth])
+            {
+                matched = matched || (this->paths[path].GetSize() == depth);
+                deeper = deeper || (this->paths[path].GetSize() > depth);
+            }
+
+            if (matched)
+            {
+                this->ReadMatch(reader, first, depth, callback);
+                return;
+            }
+
+            if (!deeper || ((first != JsonEvent::StartObject) && (first != JsonEvent::StartArray)))
+            {
+                reader.SkipValue(first);
+                return;
+            }
+
+            if (this->candidates.size() <= depth + 1)
+            {
+                this->candidates.resize(depth + 2);
+            }
+
+            size_t item = 0;
+
+            while (true)
+            {
+                auto event = reader.Next();
+                if ((event == JsonEvent::EndObject) || (event == JsonEvent::EndArray))
+                {
+                    return;
+                }
+
+                // Taken anew for every item, deeper calls may reallocate the vectors.
+                auto& next = this->candidates[depth + 1];
+                next.clear();
+
+                if (first == JsonEvent::StartObject)
+                {
+                    for (auto path : this->candidates[depth])
+                    {
+                        if ((this->paths[path].GetSize() > depth) && this->paths[path].GetStep(depth).Matches(reader.GetData(), reader.GetSize()))
+                        {
+                            next.push_back(path);
+                        }
+                    }
+
+                    event = reader.Next();
+                }
+                else
+                {
+                    for (auto path : this->candidates[depth])
+                    {
+                        if ((this->paths[path].GetSize() > depth) && this->paths[path].GetStep(depth).Matches(item))
+                        {
+                            next.push_back(path);
+                        }
+                    }
+
+                    item++;
+                }
+
+                if (next.empty())
+                {
+                    reader.SkipValue(event);
+                }
+                else
+                {
+                    this->ReadValue(reader, event, depth + 1, callback);
+                }
+            }
+        }
+
+        /// Builds the value into a tree, reports it and resolves longer paths inside it.
+        template<typename Callback>
+        void ReadMatch(JsonReader& reader, JsonEvent first, size_t depth, Callback& callback)
+        {
+            details::JsonTreeBuilder builder;
+            reader.ParseValue(first, builder);
+
+            auto node = builder.Release();
+            std::vector<const TreeNode*> nodes;
+
+            for (auto path : this->candidates[depth])
+            {
+                nodes.clear();
+                this->paths[path].FindAll(*node, depth, nodes);
+
+                for (auto found : nodes)
+                {
+                    callback(path, *found);
+                }
+            }
+        }
+    };
+} }
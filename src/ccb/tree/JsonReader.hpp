@@ -0,0 +1,708 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <ccb/tree/JsonStructuralIndex.hpp>
+
+namespace ccb { namespace tree
+{
+    enum class JsonEvent
+    {
+        StartObject,
+        EndObject,
+        StartArray,
+        EndArray,
+
+        /// Object member name, available through GetData()/GetSize().
+        Key,
+
+        /// String value, unescaped UTF-8 in GetData()/GetSize().
+        String,
+
+        /// Number value, its JSON text in GetData()/GetSize().
+        Number,
+
+        /// true or false, see GetBool().
+        Bool,
+
+        Null,
+
+        /// End of the document.
+        End
+    };
+
+    /// Pull parser over a contiguous UTF-8 buffer. Each Next() call returns one event; strings without
+    /// escapes are not copied, GetData() points right into the buffer. Trailing commas in arrays and
+    /// objects are tolerated, since older JsonTreeSerializer output has them.
+    ///
+    /// Tokens are located by JsonStructuralIndex, so whitespace and string contents are never
+    /// scanned byte by byte here.
+    class JsonReader
+    {
+    private:
+
+        enum class State
+        {
+            Value,
+            ValueOrEnd,
+            KeyOrEnd,
+            CommaOrEnd,
+            Done
+        };
+
+        const char* begin;
+
+        const char* pos;
+
+        const char* end;
+
+        JsonStructuralIndex index;
+
+        State state = State::Value;
+
+        /// Open containers, '{' or '['.
+        std::vector<char> stack;
+
+        const char* data = nullptr;
+
+        size_t size = 0;
+
+        bool boolValue = false;
+
+        /// Unescaped string when the source has escapes.
+        std::string scratch;
+
+    public:
+
+        JsonReader(const char* data, size_t size)
+            : begin(data)
+            , pos(data + GetBomSize(data, size))
+            , end(data + size)
+            , index(this->pos, this->end - this->pos)
+        {
+        }
+
+    public:
+
+        JsonEvent Next()
+        {
+            while (true)
+            {
+                this->pos = this->index.Next();
+
+                if (this->state == State::Done)
+                {
+                    if (this->pos != this->end)
+                    {
+                        this->Fail("Unexpected data after JSON value");
+                    }
+
+                    return JsonEvent::End;
+                }
+
+                if (this->pos == this->end)
+                {
+                    this->Fail("Unexpected end of JSON");
+                }
+
+                auto c = *this->pos;
+
+                switch (this->state)
+                {
+                case State::KeyOrEnd:
+                    if (c == '}')
+                    {
+                        this->pos++;
+                        return this->CloseContainer('{', JsonEvent::EndObject);
+                    }
+
+                    if (c != '"')
+                    {
+                        this->Fail("Missing field name");
+                    }
+
+                    this->ReadString();
+                    this->pos = this->index.Next();
+
+                    if ((this->pos == this->end) || (*this->pos != ':'))
+                    {
+                        this->Fail("Missing colon after field name");
+                    }
+
+                    this->pos++;
+                    this->state = State::Value;
+
+                    return JsonEvent::Key;
+
+                case State::CommaOrEnd:
+                    if (c == ',')
+                    {
+                        this->pos++;
+                        this->state = (this->stack.back() == '{') ? State::KeyOrEnd : State::ValueOrEnd;
+                        continue;
+                    }
+
+                    if (c == '}')
+                    {
+                        this->pos++;
+                        return this->CloseContainer('{', JsonEvent::EndObject);
+                    }
+
+                    if (c == ']')
+                    {
+                        this->pos++;
+                        return this->CloseContainer('[', JsonEvent::EndArray);
+                    }
+
+                    this->Fail("Missing comma");
+
+                case State::ValueOrEnd:
+                    if (c == ']')
+                    {
+                        this->pos++;
+                        return this->CloseContainer('[', JsonEvent::EndArray);
+                    }
+
+                    return this->ReadValue(c);
+
+                default:
+                    return this->ReadValue(c);
+                }
+            }
+        }
+
+        const char* GetData() const
+        {
+            return this->data;
+        }
+
+        size_t GetSize() const
+        {
+            return this->size;
+        }
+
+        std::string GetString() const
+        {
+            return std::string(this->data, this->size);
+        }
+
+        bool GetBool() const
+        {
+            return this->boolValue;
+        }
+
+        /// Offset of the current position from the start of the buffer.
+        size_t GetOffset() const
+        {
+            return this->pos - this->begin;
+        }
+
+        /// Nesting depth after the last event.
+        size_t GetDepth() const
+        {
+            return this->stack.size();
+        }
+
+        /// Skips the value whose first event (StartObject/StartArray or a scalar) was just returned.
+        /// Containers are skipped by counting brackets in the structural index, so their contents are
+        /// only checked for well-formed strings and a matching outer bracket, not for full syntax.
+        void SkipValue(JsonEvent first)
+        {
+            if ((first != JsonEvent::StartObject) && (first != JsonEvent::StartArray))
+            {
+                return;
+            }
+
+            size_t depth = 1;
+
+            while (true)
+            {
+                this->pos = this->index.Next();
+
+                if (this->pos == this->end)
+                {
+                    this->Fail("Unexpected end of JSON");
+                }
+
+                auto c = *this->pos;
+
+                if ((c == '{') || (c == '['))
+                {
+                    depth++;
+                }
+                else if (((c == '}') || (c == ']')) && (--depth == 0))
+                {
+                    this->pos++;
+                    this->CloseContainer((c == '}') ? '{' : '[', JsonEvent::End);
+                    return;
+                }
+            }
+        }
+
+        /// Feeds all events to a SAX handler, which has StartObject(), EndObject(), StartArray(),
+        /// EndArray(), Key(data, size), String(data, size), Number(data, size), Bool(value) and Null().
+        template<typename Handler>
+        void Parse(Handler& handler)
+        {
+            auto event = this->Next();
+
+            while (event != JsonEvent::End)
+            {
+                this->Dispatch(event, handler);
+                event = this->Next();
+            }
+        }
+
+        /// Feeds the value whose first event was just returned to a SAX handler, see Parse().
+        template<typename Handler>
+        void ParseValue(JsonEvent first, Handler& handler)
+        {
+            this->Dispatch(first, handler);
+
+            if ((first != JsonEvent::StartObject) && (first != JsonEvent::StartArray))
+            {
+                return;
+            }
+
+            auto depth = this->stack.size() - 1;
+
+            while (this->stack.size() > depth)
+            {
+                this->Dispatch(this->Next(), handler);
+            }
+        }
+
+    private:
+
+        template<typename Handler>
+        void Dispatch(JsonEvent event, Handler& handler)
+        {
+            switch (event)
+            {
+            case JsonEvent::StartObject:
+                handler.StartObject();
+                break;
+
+            case JsonEvent::EndObject:
+                handler.EndObject();
+                break;
+
+            case JsonEvent::StartArray:
+                handler.StartArray();
+                break;
+
+            case JsonEvent::EndArray:
+                handler.EndArray();
+                break;
+
+            case JsonEvent::Key:
+                handler.Key(this->data, this->size);
+                break;
+
+            case JsonEvent::String:
+                handler.String(this->data, this->size);
+                break;
+
+            case JsonEvent::Number:
+                handler.Number(this->data, this->size);
+                break;
+
+            case JsonEvent::Bool:
+                handler.Bool(this->boolValue);
+                break;
+
+            case JsonEvent::Null:
+                handler.Null();
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        JsonEvent ReadValue(char c)
+        {
+            switch (c)
+            {
+            case '{':
+                this->pos++;
+                this->stack.push_back('{');
+                this->state = State::KeyOrEnd;
+                return JsonEvent::StartObject;
+
+            case '[':
+                this->pos++;
+                this->stack.push_back('[');
+                this->state = State::ValueOrEnd;
+                return JsonEvent::StartArray;
+
+            case '"':
+                this->ReadString();
+                this->EndValue();
+                return JsonEvent::String;
+
+            case 't':
+                this->ReadLiteral("true", 4);
+                this->CheckScalarEnd();
+                this->boolValue = true;
+                this->EndValue();
+                return JsonEvent::Bool;
+
+            case 'f':
+                this->ReadLiteral("false", 5);
+                this->CheckScalarEnd();
+                this->boolValue = false;
+                this->EndValue();
+                return JsonEvent::Bool;
+
+            case 'n':
+                this->ReadLiteral("null", 4);
+                this->CheckScalarEnd();
+                this->EndValue();
+                return JsonEvent::Null;
+
+            default:
+                if ((c == '-') || ((c >= '0') && (c <= '9')))
+                {
+                    this->ReadNumber();
+                    this->CheckScalarEnd();
+                    this->EndValue();
+                    return JsonEvent::Number;
+                }
+
+                this->Fail("Unexpected character");
+            }
+
+            return JsonEvent::End;
+        }
+
+        JsonEvent CloseContainer(char open, JsonEvent event)
+        {
+            if (this->stack.back() != open)
+            {
+                this->Fail("Mismatched closing bracket");
+            }
+
+            this->stack.pop_back();
+            this->EndValue();
+
+            return event;
+        }
+
+        void EndValue()
+        {
+            this->state = this->stack.empty() ? State::Done : State::CommaOrEnd;
+        }
+
+        static size_t GetBomSize(const char* data, size_t size)
+        {
+            return ((size >= 3) && (memcmp(data, "\xef\xbb\xbf", 3) == 0)) ? 3 : 0;
+        }
+
+        /// Numbers and literals have no index entry for their end, so make sure nothing is glued to them.
+        void CheckScalarEnd()
+        {
+            if (this->pos == this->end)
+            {
+                return;
+            }
+
+            switch (*this->pos)
+            {
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+            case ',':
+            case ':':
+            case ']':
+            case '}':
+            case '[':
+            case '{':
+            case '"':
+                return;
+            }
+
+            this->Fail("Unexpected character");
+        }
+
+        void ReadLiteral(const char* literal, size_t length)
+        {
+            if ((static_cast<size_t>(this->end - this->pos) < length) || (memcmp(this->pos, literal, length) != 0))
+            {
+                this->Fail("Unexpected character");
+            }
+
+            this->pos += length;
+        }
+
+        void ReadNumber()
+        {
+            auto start = this->pos;
+
+            if (*this->pos == '-')
+            {
+                this->pos++;
+            }
+
+            if ((this->pos != this->end) && (*this->pos == '0'))
+            {
+                this->pos++;
+            }
+            else if (this->SkipDigits() == 0)
+            {
+                this->Fail("Bad number");
+            }
+
+            if ((this->pos != this->end) && (*this->pos == '.'))
+            {
+                this->pos++;
+
+                if (this->SkipDigits() == 0)
+                {
+                    this->Fail("Bad number");
+                }
+            }
+
+            if ((this->pos != this->end) && ((*this->pos == 'e') || (*this->pos == 'E')))
+            {
+                this->pos++;
+
+                if ((this->pos != this->end) && ((*this->pos == '+') || (*this->pos == '-')))
+                {
+                    this->pos++;
+                }
+
+                if (this->SkipDigits() == 0)
+                {
+                    this->Fail("Bad number");
+                }
+            }
+
+            this->data = start;
+            this->size = this->pos - start;
+        }
+
+        size_t SkipDigits()
+        {
+            auto start = this->pos;
+
+            while ((this->pos != this->end) && (*this->pos >= '0') && (*this->pos <= '9'))
+            {
+                this->pos++;
+            }
+
+            return this->pos - start;
+        }
+
+        /// Reads the string starting at the opening quote. The index yields the escape sequences of
+        /// the string and its closing quote, and has already rejected control characters.
+        void ReadString()
+        {
+            auto start = this->pos + 1;
+            auto close = this->index.Next();
+
+            if (*close == '"')
+            {
+                this->data = start;
+                this->size = close - start;
+                this->pos = close + 1;
+                return;
+            }
+
+            while (*close != '"')
+            {
+                close = this->index.Next();
+            }
+
+            this->pos = start;
+            this->ReadEscapedString(close);
+            this->pos = close + 1;
+        }
+
+        void ReadEscapedString(const char* close)
+        {
+            this->scratch.clear();
+
+            while (this->pos != close)
+            {
+                auto c = *this->pos++;
+
+                if (c != '\\')
+                {
+                    this->scratch.push_back(c);
+                    continue;
+                }
+
+                // A backslash is never the last byte before the closing quote.
+                switch (*this->pos++)
+                {
+                case '"':
+                    this->scratch.push_back('"');
+                    break;
+
+                case '\\':
+                    this->scratch.push_back('\\');
+                    break;
+
+                case '/':
+                    this->scratch.push_back('/');
+                    break;
+
+                case 'b':
+                    this->scratch.push_back('\b');
+                    break;
+
+                case 'f':
+                    this->scratch.push_back('\f');
+                    break;
+
+                case 'n':
+                    this->scratch.push_back('\n');
+                    break;
+
+                case 'r':
+                    this->scratch.push_back('\r');
+                    break;
+
+                case 't':
+                    this->scratch.push_back('\t');
+                    break;
+
+                case 'u':
+                    this->AppendUtf8(this->ReadCodePoint());
+                    break;
+
+                default:
+                    this->pos--;
+                    this->Fail("Bad escape sequence");
+                }
+            }
+
+            this->data = this->scratch.data();
+            this->size = this->scratch.size();
+        }
+
+        /// Reads the hex digits of a \u escape, combining surrogate pairs.
+        uint32_t ReadCodePoint()
+        {
+            auto code = this->ReadHex4();
+
+            if ((code >= 0xd800) && (code <= 0xdbff))
+            {
+                if ((this->end - this->pos < 6) || (this->pos[0] != '\\') || (this->pos[1] != 'u'))
+                {
+                    this->Fail("Unpaired surrogate");
+                }
+
+                this->pos += 2;
+
+                auto low = this->ReadHex4();
+                if ((low < 0xdc00) || (low > 0xdfff))
+                {
+                    this->Fail("Unpaired surrogate");
+                }
+
+                code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+            }
+            else if ((code >= 0xdc00) && (code <= 0xdfff))
+            {
+                this->Fail("Unpaired surrogate");
+            }
+
+            return code;
+        }
+
+        uint32_t ReadHex4()
+        {
+            if (this->end - this->pos < 4)
+            {
+                this->Fail("Unexpected end of string");
+            }
+
+            uint32_t code = 0;
+
+            for (int i = 0; i < 4; i++)
+            {
+                auto c = *this->pos++;
+                code <<= 4;
+
+                if ((c >= '0') && (c <= '9'))
+                {
+                    code |= c - '0';
+                }
+                else if ((c >= 'a') && (c <= 'f'))
+                {
+                    code |= c - 'a' + 10;
+                }
+                else if ((c >= 'A') && (c <= 'F'))
+                {
+                    code |= c - 'A' + 10;
+                }
+                else
+                {
+                    this->Fail("Bad \\u escape");
+                }
+            }
+
+            return code;
+        }
+
+        void AppendUtf8(uint32_t code)
+        {
+            if (code < 0x80)
+            {
+                this->scratch.push_back(static_cast<char>(code));
+            }
+            else if (code < 0x800)
+            {
+                this->scratch.push_back(static_cast<char>(0xc0 | (code >> 6)));
+                this->scratch.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+            }
+            else if (code < 0x10000)
+            {
+                this->scratch.push_back(static_cast<char>(0xe0 | (code >> 12)));
+                this->scratch.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+                this->scratch.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+            }
+            else
+            {
+                this->scratch.push_back(static_cast<char>(0xf0 | (code >> 18)));
+                this->scratch.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+                this->scratch.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+                this->scratch.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+            }
+        }
+
+        [[noreturn]] void Fail(const char* message) const
+        {
+            throw std::runtime_error(std::string(message) + " at offset " + std::to_string(this->pos - this->begin));
+        }
+    };
+} }
@@ -0,0 +1,345 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <ccb/binary/Varint.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace ccb { namespace tree
+{
+    namespace details
+    {
+        /// Character classes of a 64 byte block, one bit per byte.
+        struct JsonBlockMasks
+        {
+            uint64_t backslash;
+
+            uint64_t quote;
+
+            /// One of {}[]:,
+            uint64_t op;
+
+            uint64_t whitespace;
+
+            /// Bytes below 0x20, not allowed inside strings.
+            uint64_t control;
+        };
+
+        inline void ClassifyJsonBlockScalar(const uint8_t* block, JsonBlockMasks& masks)
+        {
+            masks = JsonBlockMasks();
+
+            for (unsigned i = 0; i < 64; i++)
+            {
+                auto c = block[i];
+                auto bit = static_cast<uint64_t>(1) << i;
+
+                switch (c)
+                {
+                case '\\':
+                    masks.backslash |= bit;
+                    break;
+
+                case '"':
+                    masks.quote |= bit;
+                    break;
+
+                case '{':
+                case '}':
+                case '[':
+                case ']':
+                case ':':
+                case ',':
+                    masks.op |= bit;
+                    break;
+
+                case ' ':
+                case '\t':
+                case '\n':
+                case '\r':
+                    masks.whitespace |= bit;
+                    break;
+                }
+
+                if (c < 0x20)
+                {
+                    masks.control |= bit;
+                }
+            }
+        }
+
+#if defined(__SSE2__) || defined(_M_X64)
+        inline void ClassifyJsonBlock16(const uint8_t* src, uint64_t* masks, unsigned shift)
+        {
+            auto c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+
+            // '[' and ']' differ from '{' and '}' only in bit 0x20.
+            auto folded = _mm_or_si128(c, _mm_set1_epi8(0x20));
+            auto op = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')), _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))),
+                _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8(':')), _mm_cmpeq_epi8(c, _mm_set1_epi8(','))));
+
+            auto whitespace = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(c, _mm_set1_epi8('\t'))),
+                _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(c, _mm_set1_epi8('\r'))));
+
+            auto control = _mm_cmpeq_epi8(_mm_max_epu8(c, _mm_set1_epi8(0x1f)), _mm_set1_epi8(0x1f));
+
+            masks[0] |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8('\\'))))) << shift;
+            masks[1] |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8('"'))))) << shift;
+            masks[2] |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(op))) << shift;
+            masks[3] |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(whitespace))) << shift;
+            masks[4] |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(control))) << shift;
+        }
+#endif
+
+#if defined(__AVX2__)
+        inline void ClassifyJsonBlock32(const uint8_t* src, uint64_t* masks, unsigned shift)
+        {
+            auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+
+            auto folded = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+            auto op = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+                _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(c, _mm256_set1_epi8(','))));
+
+            auto whitespace = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\t'))),
+                _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\r'))));
+
+            auto control = _mm256_cmpeq_epi8(_mm256_max_epu8(c, _mm256_set1_epi8(0x1f)), _mm256_set1_epi8(0x1f));
+
+            masks[0] |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('\\'))))) << shift;
+            masks[1] |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('"'))))) << shift;
+            masks[2] |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(op))) << shift;
+            masks[3] |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(whitespace))) << shift;
+            masks[4] |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(control))) << shift;
+        }
+#endif
+
+        inline void ClassifyJsonBlock(const uint8_t* block, JsonBlockMasks& masks)
+        {
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+            // Accumulated in locals: stores through a reference could alias the loaded bytes.
+            uint64_t local[5] = {};
+
+#if defined(__AVX2__)
+            ClassifyJsonBlock32(block, local, 0);
+            ClassifyJsonBlock32(block + 32, local, 32);
+#else
+            ClassifyJsonBlock16(block, local, 0);
+            ClassifyJsonBlock16(block + 16, local, 16);
+            ClassifyJsonBlock16(block + 32, local, 32);
+            ClassifyJsonBlock16(block + 48, local, 48);
+#endif
+
+            masks.backslash = local[0];
+            masks.quote = local[1];
+            masks.op = local[2];
+            masks.whitespace = local[3];
+            masks.control = local[4];
+#else
+            ClassifyJsonBlockScalar(block, masks);
+#endif
+        }
+
+        /// Bit i of the result is the xor of bits 0..i of the value.
+        inline uint64_t PrefixXor(uint64_t value)
+        {
+            value ^= value << 1;
+            value ^= value << 2;
+            value ^= value << 4;
+            value ^= value << 8;
+            value ^= value << 16;
+            value ^= value << 32;
+            return value;
+        }
+    }
+
+    /// Stage one of JSON parsing. Classifies the input 64 bytes at a time and yields, in order, the
+    /// positions of all structural characters ({}[]:,), of unescaped quotes (both the opening and
+    /// the closing one), of the backslashes starting escape sequences in strings and of the first
+    /// byte of every other value. Everything between two positions outside of strings is whitespace
+    /// or the rest of a number or literal. Positions are produced in batches as the parser consumes
+    /// them, so memory use does not depend on the input size.
+    class JsonStructuralIndex
+    {
+    private:
+
+        static const size_t BATCH_BLOCKS = 64;
+
+        const char* begin;
+
+        const char* end;
+
+        /// Offset of the first block not scanned yet.
+        size_t scanned = 0;
+
+        /// 1 if the first byte of the next block is escaped.
+        uint64_t prevEscaped = 0;
+
+        /// All ones if the next block starts inside a string.
+        uint64_t prevInString = 0;
+
+        /// 1 if the last byte of the previous block belongs to a number or literal.
+        uint64_t prevScalar = 0;
+
+        std::vector<const char*> positions;
+
+        size_t count = 0;
+
+        size_t next = 0;
+
+    public:
+
+        JsonStructuralIndex(const char* data, size_t size)
+            : begin(data)
+            , end(data + size)
+        {
+            // Small inputs, such as single values read on demand, need no full batch.
+            auto blocks = (size + 63) / 64;
+            this->positions.resize(((blocks < BATCH_BLOCKS) ? blocks : BATCH_BLOCKS) * 64);
+        }
+
+    public:
+
+        /// Returns the next position, or the end of the input when there are no more.
+        const char* Next()
+        {
+            if (this->next != this->count)
+            {
+                return this->positions[this->next++];
+            }
+
+            while (this->Refill())
+            {
+                if (this->count != 0)
+                {
+                    return this->positions[this->next++];
+                }
+            }
+
+            return this->end;
+        }
+
+    private:
+
+        bool Refill()
+        {
+            this->count = 0;
+            this->next = 0;
+
+            auto size = static_cast<size_t>(this->end - this->begin);
+            if (this->scanned >= size)
+            {
+                return false;
+            }
+
+            auto out = this->positions.data();
+
+            for (size_t i = 0; (i < BATCH_BLOCKS) && (this->scanned < size); i++)
+            {
+                auto block = reinterpret_cast<const uint8_t*>(this->begin + this->scanned);
+
+                // The last block is padded with whitespace.
+                uint8_t tail[64];
+                if (size - this->scanned < 64)
+                {
+                    memset(tail, ' ', sizeof(tail));
+                    memcpy(tail, block, size - this->scanned);
+                    block = tail;
+                }
+
+                auto mask = this->ScanBlock(block);
+                auto base = this->begin + this->scanned;
+
+                while (mask != 0)
+                {
+                    out[this->count++] = base + binary::details::CountTrailingZeros(mask);
+                    mask &= mask - 1;
+                }
+
+                this->scanned += 64;
+            }
+
+            if ((this->scanned >= size) && (this->prevInString != 0))
+            {
+                throw std::runtime_error("Unexpected end of string at offset " + std::to_string(size));
+            }
+
+            return true;
+        }
+
+        uint64_t ScanBlock(const uint8_t* block)
+        {
+            details::JsonBlockMasks masks;
+            details::ClassifyJsonBlock(block, masks);
+
+            // A backslash escapes the next byte if it ends an odd length run of backslashes. Adding
+            // the run starts at odd bit positions to the runs carries each of them to its end; the
+            // parity of where the carry lands gives the run length parity.
+            const uint64_t evenBits = 0x5555555555555555ULL;
+
+            auto backslash = masks.backslash & ~this->prevEscaped;
+            auto followsEscape = (backslash << 1) | this->prevEscaped;
+            auto oddStarts = backslash & ~evenBits & ~followsEscape;
+            auto evenRunEnds = oddStarts + backslash;
+            this->prevEscaped = (evenRunEnds < oddStarts) ? 1 : 0;
+            auto escaped = (evenBits ^ (evenRunEnds << 1)) & followsEscape;
+
+            // Opening quotes and string contents are set, closing quotes are not.
+            auto quote = masks.quote & ~escaped;
+            auto inString = details::PrefixXor(quote) ^ this->prevInString;
+            this->prevInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+
+            auto control = masks.control & inString;
+            if (control != 0)
+            {
+                auto offset = this->scanned + binary::details::CountTrailingZeros(control);
+                throw std::runtime_error("Control character in string at offset " + std::to_string(offset));
+            }
+
+            auto scalar = ~(masks.op | masks.whitespace | quote | inString);
+            auto scalarStarts = scalar & ~((scalar << 1) | this->prevScalar);
+            this->prevScalar = scalar >> 63;
+
+            // Backslashes inside strings tell the parser that a string needs unescaping.
+            auto escapes = masks.backslash & ~escaped & inString;
+
+            return (masks.op & ~inString) | quote | scalarStarts | escapes;
+        }
+    };
+} }
@@ -24,320 +24,263 @@
 
 #include <istream>
 #include <ostream>
+#include <string>
+#include <vector>
 
-#include <ccb/charset/CharsetConverter.hpp>
+#include <ccb/tree/JsonReader.hpp>
+#include <ccb/tree/JsonWriter.hpp>
 #include <ccb/tree/TreeArray.hpp>
+#include <ccb/tree/TreeDocument.hpp>
 #include <ccb/tree/TreeMap.hpp>
 #include <ccb/tree/TreeValue.hpp>
 
 namespace ccb { namespace tree
 {
-    class JsonTreeSerializer
+    namespace details
     {
-    private:
-
-        charset::CharsetConverter<charset::Encoding::UTF8, charset::Encoding::UTF32LE> writeConverter;
-
-        charset::CharsetConverter<charset::Encoding::UTF32LE, charset::Encoding::UTF8> readConverter;
-
-    public:
-
-        void Serialize(const TreeNode& node, std::ostream& stream)
+        /// Builds a tree from JsonReader events. Numbers, booleans and nulls become native values.
+        class JsonTreeBuilder
         {
-            // Put UTF8 BOM
-            stream << static_cast<uint8_t>(0xef) << static_cast<uint8_t>(0xbb) << static_cast<uint8_t>(0xbf);
+        private:
 
-            this->SerializeNode(node, stream);
-        }
+            std::unique_ptr<TreeNode> root;
 
-        std::unique_ptr<TreeNode> Deserialize(std::istream& stream)
-        {
-            // Skip BOM, if present.
-            this->SkipBom(stream);
+            /// Open containers, innermost last.
+            std::vector<TreeNode*> stack;
 
-            return this->DeserializeNode(stream);
-        }
+            std::wstring key;
 
-    private:
+            std::wstring buffer;
 
-        void SerializeNode(const TreeNode& node, std::ostream& stream)
-        {
-            if (node.GetType() == TreeNodeType::Value)
-            {
-                this->SerializeValue(static_cast<const TreeValue&>(node), stream);
-            }
-            else if (node.GetType() == TreeNodeType::Array)
+        public:
+
+            std::unique_ptr<TreeNode> Release()
             {
-                this->SerializeArray(static_cast<const TreeArray&>(node), stream);
+                return std::move(this->root);
             }
-            else if (node.GetType() == TreeNodeType::Map)
+
+            void StartObject()
             {
-                this->SerializeMap(static_cast<const TreeMap&>(node), stream);
+                auto map = new TreeMap();
+                this->Add(std::unique_ptr<TreeNode>(map));
+                this->stack.push_back(map);
             }
-            else
+
+            void EndObject()
             {
-                throw std::logic_error("Unknown tree node type");
+                this->stack.pop_back();
             }
-        }
 
-        void SerializeMap(const TreeMap& map, std::ostream& stream)
-        {
-            bool firstItem = true;
-            stream << "{";
-            for (const auto& pair : map.GetNodes())
+            void StartArray()
             {
-                if (!firstItem)
-                {
-                    stream << ", ";
-                }
-
-                stream << std::endl;
-
-                stream << "\"";
-
-                this->writeConverter.Convert(pair.first.begin(), pair.first.end(), std::ostream_iterator<char>(stream));
-
-                stream << "\": ";
-
-                this->SerializeNode(*pair.second, stream);
-
-                firstItem = false;
+                auto array = new TreeArray();
+                this->Add(std::unique_ptr<TreeNode>(array));
+                this->stack.push_back(array);
             }
 
-            stream << std::endl << "}";
-        }
-
-        void SerializeArray(const TreeArray& array, std::ostream& stream)
-        {
-            stream << "[" << std::endl;
-            for (const auto& node : array.GetNodes())
+            void EndArray()
             {
-                this->SerializeNode(*node, stream);
-
-                stream << ", " << std::endl;
+                this->stack.pop_back();
             }
 
-            stream << "]";
-        }
-
-        void SerializeValue(const TreeValue& value, std::ostream& stream)
-        {
-            stream << "\"";
-
-            this->writeConverter.Convert(value.GetString().begin(), value.GetString().end(), std::ostream_iterator<char>(stream));
-
-            stream << "\"";
-        }
-
-        std::unique_ptr<TreeNode> DeserializeNode(std::istream& stream)
-        {
-            this->SkipWhitespaces(stream);
-
-            if (!stream)
+            void Key(const char* data, size_t size)
             {
-                throw std::runtime_error("Unexpected end of file while looking for node value");
+                charset::Utf8ToWide(data, size, this->key);
             }
 
-            auto c = stream.peek();
-            if (c == '{')
+            void String(const char* data, size_t size)
             {
-                return this->DeserializeMap(stream);
+                charset::Utf8ToWide(data, size, this->buffer);
+                this->Add(std::unique_ptr<TreeNode>(new TreeValue(this->buffer)));
             }
-            else if (c == '[')
+
+            void Number(const char* data, size_t size)
             {
-                return this->DeserializeArray(stream);
+                auto value = new TreeValue();
+                this->Add(std::unique_ptr<TreeNode>(value));
+                value->SetNumber(data, size);
             }
-            else
+
+            void Bool(bool value)
             {
-                return this->DeserializeValue(stream);
+                auto node = new TreeValue();
+                this->Add(std::unique_ptr<TreeNode>(node));
+                node->SetValue(value);
             }
-        }
-
-        std::unique_ptr<TreeMap> DeserializeMap(std::istream& stream)
-        {
-            auto map = std::unique_ptr<TreeMap>(new TreeMap());
-
-            this->SkipWhitespaces(stream);
 
-            if (this->GetSymbol(stream) != '{')
+            void Null()
             {
-                throw std::runtime_error("Not a JSON object");
+                auto value = new TreeValue();
+                this->Add(std::unique_ptr<TreeNode>(value));
+                value->SetNull();
             }
 
-            bool firstItem = true;
+        private:
 
-            while (true)
+            void Add(std::unique_ptr<TreeNode>&& node)
             {
-                this->SkipWhitespaces(stream);
-
-                // End of object.
-                if (stream.peek() == '}')
+                if (this->stack.empty())
                 {
-                    this->GetSymbol(stream);
-                    break;
+                    this->root = std::move(node);
                 }
-
-                if (!firstItem)
+                else if (this->stack.back()->GetType() == TreeNodeType::Map)
                 {
-                    if (this->GetSymbol(stream) != ',')
+                    auto& map = static_cast<TreeMap&>(*this->stack.back());
+
+                    if (!map.Add(this->key, std::move(node)))
                     {
-                        throw std::runtime_error("Missing comma");
+                        throw std::runtime_error("Duplicate field: " + std::string(this->key.begin(), this->key.end()));
                     }
-
-                    this->SkipWhitespaces(stream);
-                }
-
-                if (this->GetSymbol(stream) != '"')
-                {
-                    throw std::runtime_error("Missing field name");
-                }
-
-                wchar_t c;
-                std::wstring fieldName;
-                while ((c = this->GetSymbol(stream)) != '"')
-                {
-                    fieldName.push_back(c);
                 }
-
-                if (map->HasNode(fieldName))
+                else
                 {
-                    throw std::runtime_error("Duplicate field: " + std::string(fieldName.begin(), fieldName.end()));
+                    static_cast<TreeArray&>(*this->stack.back()).Add(std::move(node));
                 }
+            }
+        };
+    }
 
-                this->SkipWhitespaces(stream);
-
-                if (this->GetSymbol(stream) != ':')
-                {
-                    throw std::runtime_error("Bad JSON structure");
-                }
+    class JsonTreeSerializer
+    {
+    public:
 
-                map->Set(fieldName, this->DeserializeNode(stream));
+        void Serialize(const TreeNode& node, std::ostream& stream, JsonStyle style = JsonStyle::Pretty)
+        {
+            JsonWriter writer(stream, style);
 
-                firstItem = false;
-            }
+            // Put UTF8 BOM
+            writer.GetStream().Write("\xef\xbb\xbf", 3);
 
-            return map;
+            this->SerializeNode(node, writer);
+            writer.Flush();
         }
 
-        std::unique_ptr<TreeArray> DeserializeArray(std::istream& stream)
+        std::string Serialize(const TreeNode& node, JsonStyle style)
         {
-            auto array = std::unique_ptr<TreeArray>(new TreeArray());
-
-            this->SkipWhitespaces(stream);
+            JsonWriter writer(style);
+            this->SerializeNode(node, writer);
 
-            if (this->GetSymbol(stream) != '[')
-            {
-                throw std::runtime_error("Not a JSON array");
-            }
+            return writer.GetString();
+        }
 
-            bool firstItem = true;
+        std::unique_ptr<TreeNode> Deserialize(std::istream& stream)
+        {
+            auto text = this->ReadAll(stream);
 
-            while (true)
-            {
-                this->SkipWhitespaces(stream);
+            return this->Deserialize(text.data(), text.size());
+        }
 
-                wchar_t c = stream.peek();
+        std::unique_ptr<TreeNode> Deserialize(const char* data, size_t size)
+        {
+            details::JsonTreeBuilder builder;
 
-                // End of array.
-                if (c == ']')
-                {
-                    this->GetSymbol(stream);
-                    break;
-                }
-                else
-                {
-                    // Not the first value - must be a comma.
-                    if (!firstItem)
-                    {
-                        if (this->GetSymbol(stream) != ',')
-                        {
-                            throw std::runtime_error("Missing comma");
-                        }
-                    }
+            JsonReader reader(data, size);
+            reader.Parse(builder);
 
-                    array->Add(this->DeserializeNode(stream));
-                }
+            return builder.Release();
+        }
 
-                firstItem = false;
-            }
+        TreeDocument DeserializeDocument(std::istream& stream)
+        {
+            auto text = this->ReadAll(stream);
 
-            return array;
+            return this->DeserializeDocument(text.data(), text.size());
         }
 
-        std::unique_ptr<TreeValue> DeserializeValue(std::istream& stream)
+        TreeDocument DeserializeDocument(const char* data, size_t size)
         {
-            std::string strValue;
+            details::TreeDocumentBuilder builder;
 
-            this->SkipWhitespaces(stream);
+            JsonReader reader(data, size);
+            reader.Parse(builder);
 
-            wchar_t c = this->GetSymbol(stream);
+            return builder.Release();
+        }
 
-            // Start of a string value.
-            if (c == '"')
-            {
-                while ((c = this->GetSymbol(stream)) != '"')
-                {
-                    strValue.push_back(static_cast<char>(c));
+    private:
 
-                    if (!stream)
-                    {
-                        throw std::runtime_error("Unexpected end of stream");
-                    }
-                }
+        void SerializeNode(const TreeNode& node, JsonWriter& writer)
+        {
+            if (node.GetType() == TreeNodeType::Value)
+            {
+                this->SerializeValue(static_cast<const TreeValue&>(node), writer);
+            }
+            else if (node.GetType() == TreeNodeType::Array)
+            {
+                this->SerializeArray(static_cast<const TreeArray&>(node), writer);
+            }
+            else if (node.GetType() == TreeNodeType::Map)
+            {
+                this->SerializeMap(static_cast<const TreeMap&>(node), writer);
             }
             else
             {
-                strValue.push_back(static_cast<char>(c));
-                c = stream.peek();
-                while (!isspace(c) && (c != ','))
-                {
-                    c = this->GetSymbol(stream);
-                    strValue.push_back(tolower(c));
-                    c = stream.peek();
-                }
+                throw std::logic_error("Unknown tree node type");
             }
-
-            std::wstring wideStringValue;
-            this->readConverter.Convert(strValue.begin(), strValue.end(), std::back_inserter(wideStringValue));
-
-            return std::unique_ptr<TreeValue>(new TreeValue(wideStringValue));
         }
 
-        wchar_t GetSymbol(std::istream& stream)
+        void SerializeMap(const TreeMap& map, JsonWriter& writer)
         {
-            return stream.get();
-        }
+            writer.StartObject();
 
-        void SkipWhitespaces(std::istream& stream)
-        {
-            while (stream && isspace(stream.peek()))
+            for (const auto& pair : map.GetNodes())
             {
-                stream.get();
+                writer.Key(pair.first);
+                this->SerializeNode(*pair.second, writer);
             }
+
+            writer.EndObject();
         }
 
-        void SkipBom(std::istream& stream)
+        void SerializeArray(const TreeArray& array, JsonWriter& writer)
         {
-            if (!stream || (stream.peek() != 0xef))
+            writer.StartArray();
+
+            for (const auto& node : array.GetNodes())
             {
-                return;
+                this->SerializeNode(*node, writer);
             }
 
-            stream.get();
+            writer.EndArray();
+        }
 
-            if (!stream || (stream.peek() != 0xbb))
+        void SerializeValue(const TreeValue& value, JsonWriter& writer)
+        {
+            switch (value.GetValueType())
             {
-                return;
+            case TreeValueType::Null:
+                writer.Null();
+                break;
+
+            case TreeValueType::Bool:
+                writer.Bool(value.GetValue<bool>());
+                break;
+
+            case TreeValueType::Int:
+                writer.Int(value.GetValue<int64_t>());
+                break;
+
+            case TreeValueType::Double:
+                writer.Double(value.GetValue<double>());
+                break;
+
+            default:
+                writer.String(value.GetString());
             }
+        }
 
-            stream.get();
+        std::string ReadAll(std::istream& stream)
+        {
+            std::string text;
+            char buffer[65536];
 
-            if (!stream || (stream.peek() != 0xbf))
+            while (stream)
             {
-                return;
+                stream.read(buffer, sizeof(buffer));
+                text.append(buffer, static_cast<size_t>(stream.gcount()));
             }
 
-            stream.get();
+            return text;
         }
     };
 } }
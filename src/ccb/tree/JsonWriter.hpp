@@ -0,0 +1,417 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <ccb/binary/OutputBinaryStream.hpp>
+#include <ccb/binary/Varint.hpp>
+#include <ccb/charset/Utf8.hpp>
+#include <ccb/tree/TreeValue.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace ccb { namespace tree
+{
+    enum class JsonStyle
+    {
+        /// No whitespace at all.
+        Compact,
+
+        /// One member or item per line, indented by four spaces per level.
+        Pretty
+    };
+
+    namespace details
+    {
+        inline bool NeedsJsonEscape(char c)
+        {
+            return (c == '"') || (c == '\\') || (static_cast<uint8_t>(c) < 0x20);
+        }
+
+        /// Returns the first character that must be escaped in a JSON string, or end.
+        inline const char* FindJsonEscape(const char* pos, const char* end)
+        {
+#if defined(__AVX2__)
+            while (end - pos >= 32)
+            {
+                auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+
+                auto special = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\\'))),
+                    _mm256_cmpeq_epi8(_mm256_max_epu8(c, _mm256_set1_epi8(0x1f)), _mm256_set1_epi8(0x1f)));
+
+                auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(special));
+                if (mask != 0)
+                {
+                    return pos + binary::details::CountTrailingZeros(mask);
+                }
+
+                pos += 32;
+            }
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+            while (end - pos >= 16)
+            {
+                auto c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+
+                auto special = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('"')), _mm_cmpeq_epi8(c, _mm_set1_epi8('\\'))),
+                    _mm_cmpeq_epi8(_mm_max_epu8(c, _mm_set1_epi8(0x1f)), _mm_set1_epi8(0x1f)));
+
+                auto mask = static_cast<uint32_t>(_mm_movemask_epi8(special));
+                if (mask != 0)
+                {
+                    return pos + binary::details::CountTrailingZeros(mask);
+                }
+
+                pos += 16;
+            }
+#endif
+
+            while ((pos != end) && !NeedsJsonEscape(*pos))
+            {
+                pos++;
+            }
+
+            return pos;
+        }
+    }
+
+    /// Streaming JSON writer. Output accumulates in an OutputBinaryStream, either in memory or in
+    /// chunks written to an std::ostream. Commas, colons and indentation are inserted automatically;
+    /// strings are taken as UTF-8 or wide strings and escaped as needed.
+    class JsonWriter
+    {
+    private:
+
+        binary::OutputBinaryStream output;
+
+        JsonStyle style;
+
+        /// Whether each open container already has an item.
+        std::vector<bool> hasItems;
+
+        bool afterKey = false;
+
+        std::string scratch;
+
+    public:
+
+        JsonWriter(JsonStyle style = JsonStyle::Compact)
+            : style(style)
+        {
+        }
+
+        JsonWriter(std::ostream& stream, JsonStyle style = JsonStyle::Compact, size_t chunkSize = binary::OutputBinaryStream::DEFAULT_CHUNK_SIZE)
+            : output(stream, chunkSize)
+            , style(style)
+        {
+        }
+
+    public:
+
+        void StartObject()
+        {
+            this->BeforeValue();
+            this->Put('{');
+            this->hasItems.push_back(false);
+        }
+
+        void EndObject()
+        {
+            this->EndContainer('}');
+        }
+
+        void StartArray()
+        {
+            this->BeforeValue();
+            this->Put('[');
+            this->hasItems.push_back(false);
+        }
+
+        void EndArray()
+        {
+            this->EndContainer(']');
+        }
+
+        void Key(const char* data, size_t size)
+        {
+            if (this->hasItems.empty() || this->afterKey)
+            {
+                throw std::logic_error("JSON key outside of an object");
+            }
+
+            this->BeforeItem();
+            this->WriteString(data, size);
+
+            if (this->style == JsonStyle::Pretty)
+            {
+                this->output.Write(": ", 2);
+            }
+            else
+            {
+                this->Put(':');
+            }
+
+            this->afterKey = true;
+        }
+
+        void Key(const std::string& name)
+        {
+            this->Key(name.data(), name.size());
+        }
+
+        void Key(const std::wstring& name)
+        {
+            charset::WideToUtf8(name.data(), name.size(), this->scratch);
+            this->Key(this->scratch.data(), this->scratch.size());
+        }
+
+        void String(const char* data, size_t size)
+        {
+            this->BeforeValue();
+            this->WriteString(data, size);
+        }
+
+        void String(const std::string& value)
+        {
+            this->String(value.data(), value.size());
+        }
+
+        void String(const std::wstring& value)
+        {
+            charset::WideToUtf8(value.data(), value.size(), this->scratch);
+            this->String(this->scratch.data(), this->scratch.size());
+        }
+
+        void Int(int64_t value)
+        {
+            this->BeforeValue();
+
+            char buffer[24];
+            this->output.Write(buffer, details::FormatInt(value, buffer));
+        }
+
+        /// Writes the shortest text that reads back to the same value; JSON has no infinities and NaNs,
+        /// they are written as null.
+        void Double(double value)
+        {
+            if (!std::isfinite(value))
+            {
+                this->Null();
+                return;
+            }
+
+            this->BeforeValue();
+
+            char buffer[32];
+            this->output.Write(buffer, details::FormatDouble(value, buffer));
+        }
+
+        void Bool(bool value)
+        {
+            this->BeforeValue();
+
+            if (value)
+            {
+                this->output.Write("true", 4);
+            }
+            else
+            {
+                this->output.Write("false", 5);
+            }
+        }
+
+        void Null()
+        {
+            this->BeforeValue();
+            this->output.Write("null", 4);
+        }
+
+        /// Writes buffered output to the stream; does nothing when writing to memory.
+        void Flush()
+        {
+            this->output.Flush();
+        }
+
+        /// Output written to memory.
+        std::string GetString() const
+        {
+            return std::string(reinterpret_cast<const char*>(this->output.Data()), static_cast<size_t>(this->output.GetSize()));
+        }
+
+        binary::OutputBinaryStream& GetStream()
+        {
+            return this->output;
+        }
+
+    private:
+
+        void Put(char c)
+        {
+            this->output.Write(&c, 1);
+        }
+
+        void BeforeValue()
+        {
+            if (this->afterKey)
+            {
+                this->afterKey = false;
+                return;
+            }
+
+            if (!this->hasItems.empty())
+            {
+                this->BeforeItem();
+            }
+        }
+
+        void BeforeItem()
+        {
+            if (this->hasItems.back())
+            {
+                this->Put(',');
+            }
+
+            this->hasItems.back() = true;
+
+            if (this->style == JsonStyle::Pretty)
+            {
+                this->NewLine(this->hasItems.size());
+            }
+        }
+
+        void EndContainer(char bracket)
+        {
+            if (this->hasItems.empty() || this->afterKey)
+            {
+                throw std::logic_error("No JSON container to close");
+            }
+
+            auto nonEmpty = this->hasItems.back();
+            this->hasItems.pop_back();
+
+            if (nonEmpty && (this->style == JsonStyle::Pretty))
+            {
+                this->NewLine(this->hasItems.size());
+            }
+
+            this->Put(bracket);
+        }
+
+        void NewLine(size_t depth)
+        {
+            static const char spaces[] = "\n                                                                ";
+            static const size_t maxIndent = (sizeof(spaces) - 2) / 4;
+
+            this->output.Write(spaces, 1 + 4 * std::min(depth, maxIndent));
+
+            for (size_t i = maxIndent; i < depth; i++)
+            {
+                this->output.Write(spaces + 1, 4);
+            }
+        }
+
+        void WriteString(const char* data, size_t size)
+        {
+            static const char hexDigits[] = "0123456789abcdef";
+
+            this->Put('"');
+
+            auto pos = data;
+            auto end = data + size;
+
+            while (true)
+            {
+                auto special = details::FindJsonEscape(pos, end);
+                this->output.Write(pos, special - pos);
+
+                if (special == end)
+                {
+                    break;
+                }
+
+                char escape[6] = { '\\', 0, 0, 0, 0, 0 };
+                size_t escapeSize = 2;
+
+                switch (*special)
+                {
+                case '"':
+                    escape[1] = '"';
+                    break;
+
+                case '\\':
+                    escape[1] = '\\';
+                    break;
+
+                case '\b':
+                    escape[1] = 'b';
+                    break;
+
+                case '\f':
+                    escape[1] = 'f';
+                    break;
+
+                case '\n':
+                    escape[1] = 'n';
+                    break;
+
+                case '\r':
+                    escape[1] = 'r';
+                    break;
+
+                case '\t':
+                    escape[1] = 't';
+                    break;
+
+                default:
+                    escape[1] = 'u';
+                    escape[2] = '0';
+                    escape[3] = '0';
+                    escape[4] = hexDigits[static_cast<uint8_t>(*special) >> 4];
+                    escape[5] = hexDigits[*special & 0x0f];
+                    escapeSize = 6;
+                }
+
+                this->output.Write(escape, escapeSize);
+                pos = special + 1;
+            }
+
+            this->Put('"');
+        }
+    };
+} }
@@ -0,0 +1,486 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <ccb/charset/Utf8.hpp>
+#include <ccb/filesystem/MappedFile.hpp>
+#include <ccb/tree/JsonReader.hpp>
+#include <ccb/tree/JsonTreeSerializer.hpp>
+#include <ccb/tree/TreeValue.hpp>
+
+namespace ccb { namespace tree
+{
+    class LazyJsonDocument;
+
+    namespace details
+    {
+        /// Child of a lazily read map or array: the member name and the range of the value text.
+        struct LazyJsonChild
+        {
+            std::string name;
+
+            size_t begin;
+
+            size_t end;
+        };
+
+        inline bool IsJsonSpace(char c)
+        {
+            return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r');
+        }
+
+        inline bool CompareLazyJsonChildren(const LazyJsonChild& left, const LazyJsonChild& right)
+        {
+            return left.name < right.name;
+        }
+    }
+
+    /// Handle to a value of a LazyJsonDocument, cheap to copy. Maps and arrays list their children
+    /// on first access; values are decoded every time they are read.
+    class LazyJsonNode
+    {
+    private:
+
+        const LazyJsonDocument* document = nullptr;
+
+        size_t begin = 0;
+
+        size_t end = 0;
+
+    public:
+
+        LazyJsonNode()
+        {
+        }
+
+        LazyJsonNode(const LazyJsonDocument* document, size_t begin, size_t end)
+            : document(document)
+            , begin(begin)
+            , end(end)
+        {
+        }
+
+    public:
+
+        inline TreeNodeType GetType() const;
+
+        /// Number of children of a map or an array.
+        inline size_t GetSize() const;
+
+        /// Child of a map or an array by position, map members are kept in document order.
+        inline LazyJsonNode Get(size_t idx) const;
+
+        inline bool HasNode(const std::wstring& name) const;
+
+        inline LazyJsonNode GetNode(const std::wstring& name) const;
+
+        /// JSON text of the node.
+        inline std::string GetText() const;
+
+        inline TreeValue GetTreeValue() const;
+
+        std::wstring GetString() const
+        {
+            return this->GetTreeValue().GetString();
+        }
+
+        template<typename ValueType>
+        ValueType GetValue() const
+        {
+            return this->GetTreeValue().GetValue<ValueType>();
+        }
+
+        /// Parses the node into a TreeNode hierarchy.
+        inline std::unique_ptr<TreeNode> ToTreeNode() const;
+
+    private:
+
+        inline const LazyJsonDocument& GetDocument() const;
+
+        inline const std::vector<details::LazyJsonChild>& GetChildren() const;
+
+        inline const details::LazyJsonChild* FindMember(const std::wstring& name) const;
+    };
+
+    /// JSON text that is parsed on demand. Looking up a member lists the members of its map once,
+    /// skipping their values by the structural index without parsing them, so reading a few fields
+    /// of a large file touches little more than the path to them. Syntax errors in a value are
+    /// reported when the value, or a map or array around it, is read. Nodes of one document can be read
+    /// from several threads.
+    class LazyJsonDocument
+    {
+        friend class LazyJsonNode;
+
+    private:
+
+        std::unique_ptr<filesystem::MappedFile> file;
+
+        std::string text;
+
+        const char* data = nullptr;
+
+        size_t size = 0;
+
+        size_t rootBegin = 0;
+
+        size_t rootEnd = 0;
+
+        /// Guards the caches below. Containers are listed outside the lock; when two threads list the
+        /// same one, the first result is kept.
+        mutable std::mutex mutex;
+
+        /// Children of maps and arrays listed so far, by the offset of the container.
+        mutable std::map<size_t, std::unique_ptr<std::vector<details::LazyJsonChild>>> children;
+
+        /// Map members sorted by name, by the offset of the map.
+        mutable std::map<size_t, std::unique_ptr<std::vector<details::LazyJsonChild>>> members;
+
+    public:
+
+        /// Maps the file into memory; it is read as values are requested.
+        LazyJsonDocument(const filesystem::Path& path)
+            : file(new filesystem::MappedFile(path))
+        {
+            this->Init(reinterpret_cast<const char*>(this->file->GetData()), this->file->GetSize());
+        }
+
+        LazyJsonDocument(std::string&& text)
+            : text(std::move(text))
+        {
+            this->Init(this->text.data(), this->text.size());
+        }
+
+        LazyJsonDocument(const LazyJsonDocument&) = delete;
+
+        LazyJsonDocument& operator = (const LazyJsonDocument&) = delete;
+
+    public:
+
+        LazyJsonNode GetRoot() const
+        {
+            return LazyJsonNode(this, this->rootBegin, this->rootEnd);
+        }
+
+    private:
+
+        void Init(const char* data, size_t size)
+        {
+            this->data = data;
+            this->size = size;
+
+            auto begin = ((size >= 3) && (memcmp(data, "\xef\xbb\xbf", 3) == 0)) ? 3 : 0;
+            this->rootBegin = this->SkipSpace(begin, size);
+
+            this->rootEnd = size;
+            while ((this->rootEnd > this->rootBegin) && details::IsJsonSpace(data[this->rootEnd - 1]))
+            {
+                this->rootEnd--;
+            }
+
+            if (this->rootBegin == this->rootEnd)
+            {
+                throw std::runtime_error("Unexpected end of JSON at offset " + std::to_string(size));
+            }
+
+            // A scalar root is checked right away, containers are checked level by level as they are read.
+            if ((data[this->rootBegin] != '{') && (data[this->rootBegin] != '['))
+            {
+                JsonReader reader(data + this->rootBegin, this->rootEnd - this->rootBegin);
+                reader.Next();
+                reader.Next();
+            }
+        }
+
+        size_t SkipSpace(size_t offset, size_t limit) const
+        {
+            while ((offset < limit) && details::IsJsonSpace(this->data[offset]))
+            {
+                offset++;
+            }
+
+            return offset;
+        }
+
+        /// Lists the children of the map or array at [begin, end). Values are only checked for their
+        /// first token; maps and arrays in them are skipped.
+        const std::vector<details::LazyJsonChild>& GetChildren(size_t begin, size_t end) const
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+
+                auto pos = this->children.find(begin);
+                if (pos != this->children.end())
+                {
+                    return *pos->second;
+                }
+            }
+
+            std::unique_ptr<std::vector<details::LazyJsonChild>> result(new std::vector<details::LazyJsonChild>());
+
+            JsonReader reader(this->data + begin, end - begin);
+            auto isMap = (reader.Next() == JsonEvent::StartObject);
+
+            while (true)
+            {
+                details::LazyJsonChild child;
+
+                if (!isMap)
+                {
+                    // The item starts after the whitespace and the comma in front of it.
+                    auto offset = this->SkipSpace(begin + reader.GetOffset(), end);
+                    if ((offset < end) && (this->data[offset] == ','))
+                    {
+                        offset = this->SkipSpace(offset + 1, end);
+                    }
+
+                    child.begin = offset;
+                }
+
+                auto event = reader.Next();
+                if ((event == JsonEvent::EndObject) || (event == JsonEvent::EndArray))
+                {
+                    break;
+                }
+
+                if (isMap)
+                {
+                    child.name.assign(reader.GetData(), reader.GetSize());
+                    child.begin = this->SkipSpace(begin + reader.GetOffset(), end);
+
+                    event = reader.Next();
+                }
+
+                reader.SkipValue(event);
+                child.end = begin + reader.GetOffset();
+
+                result->push_back(std::move(child));
+            }
+
+            // Fails if anything follows the container.
+            reader.Next();
+
+            return Store(this->children, begin, std::move(result));
+        }
+
+        const std::vector<details::LazyJsonChild>& GetMembers(size_t begin, size_t end) const
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+
+                auto pos = this->members.find(begin);
+                if (pos != this->members.end())
+                {
+                    return *pos->second;
+                }
+            }
+
+            std::unique_ptr<std::vector<details::LazyJsonChild>> result(new std::vector<details::LazyJsonChild>(this->GetChildren(begin, end)));
+            std::sort(result->begin(), result->end(), details::CompareLazyJsonChildren);
+
+            for (size_t i = 1; i < result->size(); i++)
+            {
+                if ((*result)[i - 1].name == (*result)[i].name)
+                {
+                    throw std::runtime_error("Duplicate field: " + (*result)[i].name);
+                }
+            }
+
+            return Store(this->members, begin, std::move(result));
+        }
+
+        /// Entries are never removed, so references to them stay valid after the lock is released.
+        const std::vector<details::LazyJsonChild>& Store(
+            std::map<size_t, std::unique_ptr<std::vector<details::LazyJsonChild>>>& cache,
+            size_t begin,
+            std::unique_ptr<std::vector<details::LazyJsonChild>>&& result) const
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+
+            auto& entry = cache[begin];
+            if (entry == nullptr)
+            {
+                entry = std::move(result);
+            }
+
+            return *entry;
+        }
+    };
+
+    TreeNodeType LazyJsonNode::GetType() const
+    {
+        switch (this->GetDocument().data[this->begin])
+        {
+        case '{':
+            return TreeNodeType::Map;
+
+        case '[':
+            return TreeNodeType::Array;
+
+        default:
+            return TreeNodeType::Value;
+        }
+    }
+
+    size_t LazyJsonNode::GetSize() const
+    {
+        return this->GetChildren().size();
+    }
+
+    LazyJsonNode LazyJsonNode::Get(size_t idx) const
+    {
+        const auto& children = this->GetChildren();
+        if (children.size() <= idx)
+        {
+            throw std::runtime_error("Index out of range");
+        }
+
+        return LazyJsonNode(this->document, children[idx].begin, children[idx].end);
+    }
+
+    bool LazyJsonNode::HasNode(const std::wstring& name) const
+    {
+        return this->FindMember(name) != nullptr;
+    }
+
+    LazyJsonNode LazyJsonNode::GetNode(const std::wstring& name) const
+    {
+        auto member = this->FindMember(name);
+        if (member == nullptr)
+        {
+            throw std::runtime_error("No such node");
+        }
+
+        return LazyJsonNode(this->document, member->begin, member->end);
+    }
+
+    std::string LazyJsonNode::GetText() const
+    {
+        return std::string(this->GetDocument().data + this->begin, this->end - this->begin);
+    }
+
+    TreeValue LazyJsonNode::GetTreeValue() const
+    {
+        if (this->GetType() != TreeNodeType::Value)
+        {
+            throw std::runtime_error("Is not of requested type");
+        }
+
+        auto text = this->GetDocument().data + this->begin;
+        auto size = this->end - this->begin;
+
+        TreeValue value;
+
+        switch (*text)
+        {
+        case '"':
+            if (memchr(text, '\\', size) == nullptr)
+            {
+                std::wstring str;
+                charset::Utf8ToWide(text + 1, size - 2, str);
+                value.SetString(str);
+            }
+            else
+            {
+                JsonReader reader(text, size);
+                reader.Next();
+
+                std::wstring str;
+                charset::Utf8ToWide(reader.GetData(), reader.GetSize(), str);
+                value.SetString(str);
+            }
+            break;
+
+        case 't':
+            value.SetValue(true);
+            break;
+
+        case 'f':
+            value.SetValue(false);
+            break;
+
+        case 'n':
+            value.SetNull();
+            break;
+
+        default:
+            value.SetNumber(text, size);
+        }
+
+        return value;
+    }
+
+    std::unique_ptr<TreeNode> LazyJsonNode::ToTreeNode() const
+    {
+        return JsonTreeSerializer().Deserialize(this->GetDocument().data + this->begin, this->end - this->begin);
+    }
+
+    const LazyJsonDocument& LazyJsonNode::GetDocument() const
+    {
+        if (this->document == nullptr)
+        {
+            throw std::logic_error("Empty lazy JSON node");
+        }
+
+        return *this->document;
+    }
+
+    const std::vector<details::LazyJsonChild>& LazyJsonNode::GetChildren() const
+    {
+        if (this->GetType() == TreeNodeType::Value)
+        {
+            throw std::runtime_error("Is not of requested type");
+        }
+
+        return this->GetDocument().GetChildren(this->begin, this->end);
+    }
+
+    const details::LazyJsonChild* LazyJsonNode::FindMember(const std::wstring& name) const
+    {
+        if (this->GetType() != TreeNodeType::Map)
+        {
+            throw std::runtime_error("Expected field to be a map");
+        }
+
+        details::LazyJsonChild key;
+        charset::WideToUtf8(name.data(), name.size(), key.name);
+
+        const auto& members = this->GetDocument().GetMembers(this->begin, this->end);
+
+        auto pos = std::lower_bound(members.begin(), members.end(), key, details::CompareLazyJsonChildren);
+        if ((pos == members.end()) || (pos->name != key.name))
+        {
+            return nullptr;
+        }
+
+        return &*pos;
+    }
+} }
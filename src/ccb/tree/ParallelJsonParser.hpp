@@ -0,0 +1,467 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ccb/tree/JsonReader.hpp>
+#include <ccb/tree/JsonTreeSerializer.hpp>
+#include <ccb/tree/TreeArray.hpp>
+
+namespace ccb { namespace tree
+{
+    namespace details
+    {
+        /// Run of top-level items or lines parsed by one worker.
+        struct JsonChunk
+        {
+            const char* begin = nullptr;
+
+            const char* end = nullptr;
+
+            /// Item ranges of an array chunk; a lines chunk is split while parsing.
+            std::vector<std::pair<const char*, const char*>> items;
+
+            std::vector<std::unique_ptr<TreeNode>> nodes;
+
+            bool done = false;
+
+            /// Parse error and the start of the item it happened in.
+            std::string message;
+
+            const char* failedItem = nullptr;
+
+            std::exception_ptr error;
+        };
+    }
+
+    /// Parses a large top-level array or a JSON-lines text on several threads. A sequential scan
+    /// finds the item boundaries, which is cheap with the structural index, then runs of items are
+    /// parsed into trees by a pool of workers. Results come back in order on the calling thread,
+    /// either stitched into a TreeArray or one by one through a callback, which can then drop each
+    /// item before the rest of the input is parsed. Single-threaded parsers, and small arrays stitched
+    /// into a TreeArray, read the array in one pass instead; errors then carry the offset in the whole
+    /// text. Items parsed before an error are always handed to the callback first.
+    class ParallelJsonParser
+    {
+    public:
+
+        typedef std::function<void(size_t, std::unique_ptr<TreeNode>&&)> Callback;
+
+    private:
+
+        static const size_t MIN_CHUNK_SIZE = 64 * 1024;
+
+        /// Chunks per thread, so that uneven items still keep all workers busy.
+        static const size_t CHUNKS_PER_THREAD = 8;
+
+        /// Chunks per thread parsed ahead of the one handed out, which bounds the memory held by
+        /// parsed items when the callback is slower than the workers.
+        static const size_t CHUNKS_IN_FLIGHT = 2;
+
+        size_t threads;
+
+    public:
+
+        /// Zero threads means one per hardware thread.
+        ParallelJsonParser(size_t threads = 0)
+            : threads(threads)
+        {
+            if (this->threads == 0)
+            {
+                this->threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+            }
+        }
+
+    public:
+
+        std::unique_ptr<TreeArray> ParseArray(const char* data, size_t size)
+        {
+            if ((this->threads == 1) || (size <= MIN_CHUNK_SIZE))
+            {
+                auto root = JsonTreeSerializer().Deserialize(data, size);
+                if (root->GetType() != TreeNodeType::Array)
+                {
+                    throw std::runtime_error("Not a JSON array");
+                }
+
+                return std::unique_ptr<TreeArray>(static_cast<TreeArray*>(root.release()));
+            }
+
+            std::unique_ptr<TreeArray> array(new TreeArray());
+
+            this->ParseArray(data, size, [&array] (size_t, std::unique_ptr<TreeNode>&& node)
+            {
+                array->Add(std::move(node));
+            });
+
+            return array;
+        }
+
+        void ParseArray(const char* data, size_t size, const Callback& callback)
+        {
+            if (this->threads == 1)
+            {
+                ParseArrayInOnePass(data, size, callback);
+                return;
+            }
+
+            auto chunks = this->SplitArray(data, size);
+            this->Run(chunks, data, false, callback);
+        }
+
+        /// Parses one JSON value per line, skipping empty lines.
+        std::unique_ptr<TreeArray> ParseLines(const char* data, size_t size)
+        {
+            std::unique_ptr<TreeArray> array(new TreeArray());
+            auto add = [&array] (size_t, std::unique_ptr<TreeNode>&& node)
+            {
+                array->Add(std::move(node));
+            };
+
+            if (this->threads == 1)
+            {
+                // All lines end up in the array anyway, so they are parsed as a single chunk.
+                std::vector<details::JsonChunk> chunks(1);
+                chunks.back().begin = data;
+                chunks.back().end = data + size;
+
+                this->Run(chunks, data, true, add);
+            }
+            else
+            {
+                this->ParseLines(data, size, add);
+            }
+
+            return array;
+        }
+
+        void ParseLines(const char* data, size_t size, const Callback& callback)
+        {
+            auto chunks = this->SplitLines(data, size);
+            this->Run(chunks, data, true, callback);
+        }
+
+    private:
+
+        /// Builds each item straight from the reader events, without listing the items first.
+        static void ParseArrayInOnePass(const char* data, size_t size, const Callback& callback)
+        {
+            JsonReader reader(data, size);
+            if (reader.Next() != JsonEvent::StartArray)
+            {
+                throw std::runtime_error("Not a JSON array");
+            }
+
+            for (size_t itemIndex = 0; ; itemIndex++)
+            {
+                auto event = reader.Next();
+                if (event == JsonEvent::EndArray)
+                {
+                    break;
+                }
+
+                details::JsonTreeBuilder builder;
+                reader.ParseValue(event, builder);
+
+                callback(itemIndex, builder.Release());
+            }
+
+            // Fails if anything follows the array.
+            reader.Next();
+        }
+
+        size_t GetChunkSize(size_t size) const
+        {
+            auto chunkSize = size / (this->threads * CHUNKS_PER_THREAD) + 1;
+
+            return (chunkSize < MIN_CHUNK_SIZE) ? MIN_CHUNK_SIZE : chunkSize;
+        }
+
+        static const char* SkipSpace(const char* pos, const char* end)
+        {
+            while ((pos < end) && ((*pos == ' ') || (*pos == '\t') || (*pos == '\n') || (*pos == '\r')))
+            {
+                pos++;
+            }
+
+            return pos;
+        }
+
+        /// Lists the items of the array, checking the array itself but not the items, and groups
+        /// them into chunks of about the same size.
+        std::vector<details::JsonChunk> SplitArray(const char* data, size_t size) const
+        {
+            std::vector<details::JsonChunk> chunks;
+            auto chunkSize = this->GetChunkSize(size);
+            auto end = data + size;
+
+            JsonReader reader(data, size);
+            if (reader.Next() != JsonEvent::StartArray)
+            {
+                throw std::runtime_error("Not a JSON array");
+            }
+
+            while (true)
+            {
+                // The item starts after the whitespace and the comma in front of it.
+                auto begin = SkipSpace(data + reader.GetOffset(), end);
+                if ((begin < end) && (*begin == ','))
+                {
+                    begin = SkipSpace(begin + 1, end);
+                }
+
+                auto event = reader.Next();
+                if (event == JsonEvent::EndArray)
+                {
+                    break;
+                }
+
+                reader.SkipValue(event);
+
+                if (chunks.empty() || (chunks.back().end - chunks.back().begin >= static_cast<ptrdiff_t>(chunkSize)))
+                {
+                    chunks.emplace_back();
+                    chunks.back().begin = begin;
+                }
+
+                chunks.back().end = data + reader.GetOffset();
+                chunks.back().items.emplace_back(begin, chunks.back().end);
+            }
+
+            // Fails if anything follows the array.
+            reader.Next();
+
+            return chunks;
+        }
+
+        /// Cuts the text at the first line break after every chunk size.
+        std::vector<details::JsonChunk> SplitLines(const char* data, size_t size) const
+        {
+            std::vector<details::JsonChunk> chunks;
+            auto chunkSize = this->GetChunkSize(size);
+            auto end = data + size;
+
+            for (auto pos = data; pos < end; )
+            {
+                auto next = (static_cast<size_t>(end - pos) > chunkSize) ? pos + chunkSize : end;
+
+                auto lineEnd = static_cast<const char*>(memchr(next, '\n', end - next));
+                next = (lineEnd == nullptr) ? end : lineEnd + 1;
+
+                chunks.emplace_back();
+                chunks.back().begin = pos;
+                chunks.back().end = next;
+
+                pos = next;
+            }
+
+            return chunks;
+        }
+
+        static void ParseChunk(details::JsonChunk& chunk, bool lines)
+        {
+            const char* item = nullptr;
+
+            try
+            {
+                if (!lines)
+                {
+                    for (const auto& range : chunk.items)
+                    {
+                        item = range.first;
+                        chunk.nodes.push_back(JsonTreeSerializer().Deserialize(range.first, range.second - range.first));
+                    }
+
+                    return;
+                }
+
+                for (auto pos = chunk.begin; pos < chunk.end; )
+                {
+                    auto lineEnd = static_cast<const char*>(memchr(pos, '\n', chunk.end - pos));
+                    if (lineEnd == nullptr)
+                    {
+                        lineEnd = chunk.end;
+                    }
+
+                    item = pos;
+                    if (SkipSpace(pos, lineEnd) != lineEnd)
+                    {
+                        chunk.nodes.push_back(JsonTreeSerializer().Deserialize(pos, lineEnd - pos));
+                    }
+
+                    pos = lineEnd + 1;
+                }
+            }
+            catch (const std::runtime_error& e)
+            {
+                chunk.message = e.what();
+                chunk.failedItem = item;
+            }
+            catch (...)
+            {
+                chunk.error = std::current_exception();
+            }
+        }
+
+        /// Parses the chunks on the workers and hands the items to the callback in order. Reader
+        /// errors are reported with the number of the item or line they happened in.
+        void Run(std::vector<details::JsonChunk>& chunks, const char* data, bool lines, const Callback& callback)
+        {
+            std::mutex mutex;
+            std::condition_variable chunkDone;
+            std::condition_variable chunkConsumed;
+            size_t nextChunk = 0;
+            size_t consumed = 0;
+            bool cancelled = false;
+
+            auto workerCount = std::min(this->threads, chunks.size());
+            auto window = CHUNKS_IN_FLIGHT * workerCount;
+
+            auto work = [&] ()
+            {
+                while (true)
+                {
+                    size_t idx;
+
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        chunkConsumed.wait(lock, [&] () { return cancelled || (nextChunk < consumed + window); });
+
+                        if (cancelled || (nextChunk >= chunks.size()))
+                        {
+                            break;
+                        }
+
+                        idx = nextChunk++;
+                    }
+
+                    ParseChunk(chunks[idx], lines);
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        chunks[idx].done = true;
+                    }
+
+                    chunkDone.notify_all();
+                }
+            };
+
+            std::vector<std::thread> workers;
+
+            try
+            {
+                // A single worker is the calling thread itself.
+                for (size_t i = 0; (workerCount > 1) && (i < workerCount); i++)
+                {
+                    workers.emplace_back(work);
+                }
+
+                size_t itemIndex = 0;
+
+                for (auto& chunk : chunks)
+                {
+                    if (workers.empty())
+                    {
+                        ParseChunk(chunk, lines);
+                    }
+                    else
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        chunkDone.wait(lock, [&chunk] () { return chunk.done; });
+                    }
+
+                    // Items parsed before an error in the chunk are delivered first, so that a
+                    // streaming consumer sees every item up to the failing one.
+                    for (auto& node : chunk.nodes)
+                    {
+                        callback(itemIndex++, std::move(node));
+                    }
+
+                    if (chunk.error)
+                    {
+                        std::rethrow_exception(chunk.error);
+                    }
+
+                    if (chunk.failedItem != nullptr)
+                    {
+                        this->Fail(chunk, data, lines, itemIndex);
+                    }
+
+                    chunk.nodes.clear();
+                    chunk.nodes.shrink_to_fit();
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        consumed++;
+                    }
+
+                    chunkConsumed.notify_all();
+                }
+            }
+            catch (...)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    cancelled = true;
+                }
+
+                chunkConsumed.notify_all();
+
+                for (auto& worker : workers)
+                {
+                    worker.join();
+                }
+
+                throw;
+            }
+
+            for (auto& worker : workers)
+            {
+                worker.join();
+            }
+        }
+
+        [[noreturn]] void Fail(const details::JsonChunk& chunk, const char* data, bool lines, size_t itemIndex) const
+        {
+            if (lines)
+            {
+                auto line = std::count(data, chunk.failedItem, '\n') + 1;
+                throw std::runtime_error(chunk.message + " of line " + std::to_string(line));
+            }
+
+            // The items in front of the failed one were parsed and delivered, so it is the next one.
+            throw std::runtime_error(chunk.message + " of item " + std::to_string(itemIndex));
+        }
+    };
+} }
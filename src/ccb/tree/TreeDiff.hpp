@@ -0,0 +1,197 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <ccb/tree/TreeArray.hpp>
+#include <ccb/tree/TreeMap.hpp>
+#include <ccb/tree/TreePath.hpp>
+#include <ccb/tree/TreeValue.hpp>
+
+namespace ccb { namespace tree
+{
+    enum class TreeChangeType
+    {
+        Added,
+        Removed,
+        Modified
+    };
+
+    /// Node that differs between two trees, addressed by a JSON Pointer.
+    struct TreeChange
+    {
+        TreeChangeType type;
+
+        std::wstring path;
+
+        TreeChange(TreeChangeType type, const std::wstring& path)
+            : type(type)
+            , path(path)
+        {
+        }
+
+        /// The change is at the pointer, below it, or replaces a node above it.
+        bool Affects(const std::wstring& pointer) const
+        {
+            auto shorter = (this->path.size() < pointer.size()) ? &this->path : &pointer;
+            auto longer = (shorter == &this->path) ? &pointer : &this->path;
+
+            return (longer->compare(0, shorter->size(), *shorter) == 0) &&
+                ((longer->size() == shorter->size()) || ((*longer)[shorter->size()] == L'/'));
+        }
+    };
+
+    /// Compares two trees down to the deepest nodes that differ. Map members are matched by name and
+    /// array items by index; a node that changes type is reported as modified as a whole. Values are
+    /// equal when they have the same type and value, so 1 and 1.0 differ.
+    class TreeDiff
+    {
+    public:
+
+        std::vector<TreeChange> Compare(const TreeNode& before, const TreeNode& after) const
+        {
+            std::vector<TreeChange> changes;
+            std::wstring path;
+
+            this->CompareNodes(before, after, path, changes);
+
+            return changes;
+        }
+
+    private:
+
+        void CompareNodes(const TreeNode& before, const TreeNode& after, std::wstring& path, std::vector<TreeChange>& changes) const
+        {
+            if (before.GetType() != after.GetType())
+            {
+                changes.emplace_back(TreeChangeType::Modified, path);
+                return;
+            }
+
+            switch (before.GetType())
+            {
+            case TreeNodeType::Map:
+                this->CompareMaps(static_cast<const TreeMap&>(before), static_cast<const TreeMap&>(after), path, changes);
+                break;
+
+            case TreeNodeType::Array:
+                this->CompareArrays(static_cast<const TreeArray&>(before), static_cast<const TreeArray&>(after), path, changes);
+                break;
+
+            default:
+                if (!EqualValues(static_cast<const TreeValue&>(before), static_cast<const TreeValue&>(after)))
+                {
+                    changes.emplace_back(TreeChangeType::Modified, path);
+                }
+            }
+        }
+
+        void CompareMaps(const TreeMap& before, const TreeMap& after, std::wstring& path, std::vector<TreeChange>& changes) const
+        {
+            auto size = path.size();
+
+            for (const auto& node : before.GetNodes())
+            {
+                details::AppendTreePathStep(path, node.first);
+
+                auto other = after.FindNode(node.first.data(), node.first.size());
+                if (other == nullptr)
+                {
+                    changes.emplace_back(TreeChangeType::Removed, path);
+                }
+                else
+                {
+                    this->CompareNodes(*node.second, *other, path, changes);
+                }
+
+                path.resize(size);
+            }
+
+            for (const auto& node : after.GetNodes())
+            {
+                if (!before.HasNode(node.first.data(), node.first.size()))
+                {
+                    details::AppendTreePathStep(path, node.first);
+                    changes.emplace_back(TreeChangeType::Added, path);
+                    path.resize(size);
+                }
+            }
+        }
+
+        void CompareArrays(const TreeArray& before, const TreeArray& after, std::wstring& path, std::vector<TreeChange>& changes) const
+        {
+            auto size = path.size();
+            const auto& beforeNodes = before.GetNodes();
+            const auto& afterNodes = after.GetNodes();
+
+            for (size_t i = 0; i < std::max(beforeNodes.size(), afterNodes.size()); i++)
+            {
+                details::AppendTreePathStep(path, std::to_wstring(i));
+
+                if (i >= afterNodes.size())
+                {
+                    changes.emplace_back(TreeChangeType::Removed, path);
+                }
+                else if (i >= beforeNodes.size())
+                {
+                    changes.emplace_back(TreeChangeType::Added, path);
+                }
+                else
+                {
+                    this->CompareNodes(*beforeNodes[i], *afterNodes[i], path, changes);
+                }
+
+                path.resize(size);
+            }
+        }
+
+        static bool EqualValues(const TreeValue& before, const TreeValue& after)
+        {
+            if (before.GetValueType() != after.GetValueType())
+            {
+                return false;
+            }
+
+            switch (before.GetValueType())
+            {
+            case TreeValueType::Null:
+                return true;
+
+            case TreeValueType::Bool:
+                return before.GetValue<bool>() == after.GetValue<bool>();
+
+            case TreeValueType::Int:
+                return before.GetValue<int64_t>() == after.GetValue<int64_t>();
+
+            case TreeValueType::Double:
+                return before.GetValue<double>() == after.GetValue<double>();
+
+            default:
+                return before.GetString() == after.GetString();
+            }
+        }
+    };
+} }
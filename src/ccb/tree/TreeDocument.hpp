@@ -0,0 +1,547 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <ccb/charset/Utf8.hpp>
+#include <ccb/tree/TreeArray.hpp>
+#include <ccb/tree/TreeMap.hpp>
+#include <ccb/tree/TreeValue.hpp>
+
+namespace ccb { namespace tree
+{
+    namespace details
+    {
+        /// Node of a TreeDocument. Children of a map or an array are stored next to each other.
+        struct CompactTreeNode
+        {
+            TreeNodeType type;
+
+            /// Kind of a value, whose text is always kept in the pool.
+            TreeValueType valueType;
+
+            /// Member name in the string pool, empty for array items and the root.
+            uint32_t nameOffset;
+
+            uint32_t nameSize;
+
+            /// Value: text offset in the string pool. Map and array: index of the first child.
+            uint32_t offset;
+
+            /// Value: text size. Map and array: number of children.
+            uint32_t size;
+        };
+
+        /// Offsets of the literals, which are put into the pool once.
+        enum
+        {
+            TRUE_OFFSET = 0,
+            FALSE_OFFSET = 4,
+            NULL_OFFSET = 9
+        };
+
+        class TreeDocumentBuilder;
+    }
+
+    /// Read-only handle to a node of a TreeDocument. Cheap to copy, stays valid while the document
+    /// exists, even if the document is moved.
+    class TreeDocumentNode
+    {
+    private:
+
+        const details::CompactTreeNode* nodes = nullptr;
+
+        const char* strings = nullptr;
+
+        uint32_t index = 0;
+
+    public:
+
+        TreeDocumentNode()
+        {
+        }
+
+        TreeDocumentNode(const details::CompactTreeNode* nodes, const char* strings, uint32_t index)
+            : nodes(nodes)
+            , strings(strings)
+            , index(index)
+        {
+        }
+
+    public:
+
+        TreeNodeType GetType() const
+        {
+            return this->GetCompactNode().type;
+        }
+
+        TreeValueType GetValueType() const
+        {
+            return this->GetValueNode().valueType;
+        }
+
+        /// Number of children of a map or an array.
+        size_t GetSize() const
+        {
+            const auto& node = this->GetCompactNode();
+
+            return (node.type == TreeNodeType::Value) ? 0 : node.size;
+        }
+
+        /// Child of a map or an array by position, map members are kept in document order.
+        TreeDocumentNode Get(size_t idx) const
+        {
+            if (this->GetSize() <= idx)
+            {
+                throw std::runtime_error("Index out of range");
+            }
+
+            return TreeDocumentNode(this->nodes, this->strings, this->GetCompactNode().offset + static_cast<uint32_t>(idx));
+        }
+
+        bool HasNode(const std::wstring& name) const
+        {
+            std::string utf8Name;
+            charset::WideToUtf8(name.data(), name.size(), utf8Name);
+
+            return this->Find(utf8Name.data(), utf8Name.size()) != nullptr;
+        }
+
+        /// Map member by name. Members are searched linearly.
+        TreeDocumentNode GetNode(const std::wstring& name) const
+        {
+            std::string utf8Name;
+            charset::WideToUtf8(name.data(), name.size(), utf8Name);
+
+            auto node = this->Find(utf8Name.data(), utf8Name.size());
+            if (node == nullptr)
+            {
+                throw std::runtime_error("No such node");
+            }
+
+            return TreeDocumentNode(this->nodes, this->strings, static_cast<uint32_t>(node - this->nodes));
+        }
+
+        std::wstring GetName() const
+        {
+            const auto& node = this->GetCompactNode();
+
+            std::wstring result;
+            charset::Utf8ToWide(this->strings + node.nameOffset, node.nameSize, result);
+
+            return result;
+        }
+
+        /// Value text as UTF-8.
+        std::string GetText() const
+        {
+            const auto& node = this->GetValueNode();
+
+            return std::string(this->strings + node.offset, node.size);
+        }
+
+        std::wstring GetString() const
+        {
+            const auto& node = this->GetValueNode();
+
+            std::wstring result;
+            charset::Utf8ToWide(this->strings + node.offset, node.size, result);
+
+            return result;
+        }
+
+        template<typename ValueType>
+        ValueType GetValue() const
+        {
+            return details::ParseValue<ValueType>(this->GetText());
+        }
+
+        /// Copies the node into a TreeNode hierarchy, for code that works with TreeMap and TreeArray.
+        std::unique_ptr<TreeNode> ToTreeNode() const
+        {
+            const auto& node = this->GetCompactNode();
+
+            if (node.type == TreeNodeType::Value)
+            {
+                return this->ToTreeValue();
+            }
+
+            if (node.type == TreeNodeType::Array)
+            {
+                auto array = std::unique_ptr<TreeArray>(new TreeArray());
+
+                for (size_t i = 0; i < node.size; i++)
+                {
+                    array->Add(this->Get(i).ToTreeNode());
+                }
+
+                return std::move(array);
+            }
+
+            auto map = std::unique_ptr<TreeMap>(new TreeMap());
+            map->Reserve(node.size);
+
+            for (size_t i = 0; i < node.size; i++)
+            {
+                auto child = this->Get(i);
+                map->Set(child.GetName(), child.ToTreeNode());
+            }
+
+            return std::move(map);
+        }
+
+    private:
+
+        std::unique_ptr<TreeNode> ToTreeValue() const
+        {
+            const auto& node = this->GetCompactNode();
+            auto value = std::unique_ptr<TreeValue>(new TreeValue());
+
+            switch (node.valueType)
+            {
+            case TreeValueType::Null:
+                value->SetNull();
+                break;
+
+            case TreeValueType::Bool:
+                value->SetValue(node.offset == details::TRUE_OFFSET);
+                break;
+
+            case TreeValueType::Int:
+            case TreeValueType::Double:
+                value->SetNumber(this->strings + node.offset, node.size);
+                break;
+
+            default:
+                value->SetString(this->GetString());
+            }
+
+            return std::move(value);
+        }
+
+        const details::CompactTreeNode& GetCompactNode() const
+        {
+            if (this->nodes == nullptr)
+            {
+                throw std::logic_error("Empty tree document node");
+            }
+
+            return this->nodes[this->index];
+        }
+
+        const details::CompactTreeNode& GetValueNode() const
+        {
+            const auto& node = this->GetCompactNode();
+            if (node.type != TreeNodeType::Value)
+            {
+                throw std::runtime_error("Is not of requested type");
+            }
+
+            return node;
+        }
+
+        const details::CompactTreeNode* Find(const char* name, size_t size) const
+        {
+            const auto& node = this->GetCompactNode();
+            if (node.type != TreeNodeType::Map)
+            {
+                throw std::runtime_error("Is not of requested type");
+            }
+
+            auto child = this->nodes + node.offset;
+            auto childrenEnd = child + node.size;
+
+            for (; child != childrenEnd; child++)
+            {
+                if ((child->nameSize == size) && (memcmp(this->strings + child->nameOffset, name, size) == 0))
+                {
+                    return child;
+                }
+            }
+
+            return nullptr;
+        }
+    };
+
+    /// Immutable tree stored in two contiguous blocks: an array of fixed size nodes and a pool
+    /// with all names and values as UTF-8. Holds the same data as a TreeNode hierarchy with two
+    /// allocations instead of several per node.
+    class TreeDocument
+    {
+    private:
+
+        std::vector<details::CompactTreeNode> nodes;
+
+        std::vector<char> strings;
+
+    public:
+
+        TreeDocument()
+        {
+        }
+
+        TreeDocument(TreeDocument&&) = default;
+
+        TreeDocument& operator = (TreeDocument&&) = default;
+
+        TreeDocument(const TreeDocument&) = delete;
+
+        TreeDocument& operator = (const TreeDocument&) = delete;
+
+    public:
+
+        bool IsEmpty() const
+        {
+            return this->nodes.empty();
+        }
+
+        /// The root is the last node.
+        TreeDocumentNode GetRoot() const
+        {
+            if (this->nodes.empty())
+            {
+                throw std::logic_error("Tree document is empty");
+            }
+
+            return TreeDocumentNode(this->nodes.data(), this->strings.data(), static_cast<uint32_t>(this->nodes.size() - 1));
+        }
+
+        size_t GetNodeCount() const
+        {
+            return this->nodes.size();
+        }
+
+        /// Memory held by the document, in bytes.
+        size_t GetMemorySize() const
+        {
+            return this->nodes.capacity() * sizeof(details::CompactTreeNode) + this->strings.capacity();
+        }
+
+        friend class details::TreeDocumentBuilder;
+    };
+
+    namespace details
+    {
+        /// Builds a TreeDocument from parser events: StartObject(), EndObject(), StartArray(),
+        /// EndArray(), Key(data, size), String(data, size), Number(data, size), Bool(value), Null().
+        /// Nodes wait on a stack until their container is closed, then all its children are
+        /// appended to the document at once.
+        class TreeDocumentBuilder
+        {
+        private:
+
+            TreeDocument document;
+
+            std::vector<CompactTreeNode> pending;
+
+            /// Position of every open container in pending.
+            std::vector<size_t> containers;
+
+            uint32_t nameOffset = 0;
+
+            uint32_t nameSize = 0;
+
+            std::vector<std::pair<const char*, uint32_t>> names;
+
+        public:
+
+            TreeDocumentBuilder()
+            {
+                this->AddString("truefalsenull", 13);
+            }
+
+        public:
+
+            TreeDocument Release()
+            {
+                if ((this->pending.size() != 1) || !this->containers.empty())
+                {
+                    throw std::logic_error("Tree document is not complete");
+                }
+
+                this->Append(this->pending.begin(), this->pending.end());
+                this->pending.clear();
+
+                return std::move(this->document);
+            }
+
+            void StartObject()
+            {
+                this->Push(TreeNodeType::Map, TreeValueType::Null, 0, 0);
+                this->containers.push_back(this->pending.size() - 1);
+            }
+
+            void EndObject()
+            {
+                this->Close();
+            }
+
+            void StartArray()
+            {
+                this->Push(TreeNodeType::Array, TreeValueType::Null, 0, 0);
+                this->containers.push_back(this->pending.size() - 1);
+            }
+
+            void EndArray()
+            {
+                this->Close();
+            }
+
+            void Key(const char* data, size_t size)
+            {
+                this->nameOffset = this->AddString(data, size);
+                this->nameSize = static_cast<uint32_t>(size);
+            }
+
+            void String(const char* data, size_t size)
+            {
+                this->Push(TreeNodeType::Value, TreeValueType::String, this->AddString(data, size), static_cast<uint32_t>(size));
+            }
+
+            void Number(const char* data, size_t size)
+            {
+                int64_t intValue;
+                double doubleValue;
+
+                auto type = ParseNumber(data, size, intValue, doubleValue);
+                this->Push(TreeNodeType::Value, type, this->AddString(data, size), static_cast<uint32_t>(size));
+            }
+
+            void Bool(bool value)
+            {
+                if (value)
+                {
+                    this->Push(TreeNodeType::Value, TreeValueType::Bool, TRUE_OFFSET, 4);
+                }
+                else
+                {
+                    this->Push(TreeNodeType::Value, TreeValueType::Bool, FALSE_OFFSET, 5);
+                }
+            }
+
+            void Null()
+            {
+                this->Push(TreeNodeType::Value, TreeValueType::Null, NULL_OFFSET, 4);
+            }
+
+        private:
+
+            void Push(TreeNodeType type, TreeValueType valueType, uint32_t offset, uint32_t size)
+            {
+                CompactTreeNode node;
+                node.type = type;
+                node.valueType = valueType;
+                node.nameOffset = this->nameOffset;
+                node.nameSize = this->nameSize;
+                node.offset = offset;
+                node.size = size;
+
+                this->pending.push_back(node);
+
+                this->nameOffset = 0;
+                this->nameSize = 0;
+            }
+
+            void Close()
+            {
+                auto start = this->containers.back();
+                this->containers.pop_back();
+
+                auto first = this->pending.begin() + start + 1;
+                auto count = static_cast<uint32_t>(this->pending.end() - first);
+
+                if (this->pending[start].type == TreeNodeType::Map)
+                {
+                    this->CheckDuplicates(first, this->pending.end());
+                }
+
+                this->pending[start].offset = static_cast<uint32_t>(this->document.nodes.size());
+                this->pending[start].size = count;
+
+                this->Append(first, this->pending.end());
+                this->pending.resize(start + 1);
+            }
+
+            void Append(std::vector<CompactTreeNode>::const_iterator begin, std::vector<CompactTreeNode>::const_iterator end)
+            {
+                if (this->document.nodes.size() + (end - begin) > std::numeric_limits<uint32_t>::max())
+                {
+                    throw std::runtime_error("Tree document is too large");
+                }
+
+                this->document.nodes.insert(this->document.nodes.end(), begin, end);
+            }
+
+            uint32_t AddString(const char* data, size_t size)
+            {
+                auto& strings = this->document.strings;
+
+                if (strings.size() + size > std::numeric_limits<uint32_t>::max())
+                {
+                    throw std::runtime_error("Tree document is too large");
+                }
+
+                auto offset = static_cast<uint32_t>(strings.size());
+                strings.insert(strings.end(), data, data + size);
+
+                return offset;
+            }
+
+            void CheckDuplicates(std::vector<CompactTreeNode>::const_iterator begin, std::vector<CompactTreeNode>::const_iterator end)
+            {
+                auto strings = this->document.strings.data();
+
+                this->names.clear();
+                for (auto node = begin; node != end; ++node)
+                {
+                    this->names.push_back(std::make_pair(strings + node->nameOffset, node->nameSize));
+                }
+
+                auto less = [](const std::pair<const char*, uint32_t>& a, const std::pair<const char*, uint32_t>& b)
+                {
+                    auto result = memcmp(a.first, b.first, std::min(a.second, b.second));
+                    return (result < 0) || ((result == 0) && (a.second < b.second));
+                };
+
+                std::sort(this->names.begin(), this->names.end(), less);
+
+                for (size_t i = 1; i < this->names.size(); i++)
+                {
+                    if (!less(this->names[i - 1], this->names[i]))
+                    {
+                        throw std::runtime_error("Duplicate field: " + std::string(this->names[i].first, this->names[i].second));
+                    }
+                }
+            }
+        };
+    }
+} }
@@ -22,9 +22,13 @@
 
 #pragma once
 
-#include <map>
+#include <cstdint>
+#include <cwchar>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <ccb/tree/TreeArray.hpp>
 #include <ccb/tree/TreeMap.hpp>
@@ -34,11 +38,51 @@ namespace ccb { namespace tree
     class TreeArray;
     class TreeValue;
 
+    namespace details
+    {
+        /// FNV-1a over the code units of the name.
+        inline uint32_t HashTreeName(const wchar_t* name, size_t size)
+        {
+            uint32_t hash = 2166136261u;
+
+            for (size_t i = 0; i < size; i++)
+            {
+                hash = (hash ^ static_cast<uint32_t>(name[i])) * 16777619u;
+            }
+
+            return hash;
+        }
+
+        struct TreeMapSlot
+        {
+            /// Index of the node plus one, zero for an empty slot.
+            uint32_t index;
+
+            uint32_t hash;
+        };
+    }
+
+    /// Named child nodes in insertion order. Small maps are searched linearly; larger ones keep an
+    /// open addressing index next to the nodes. Lookups take the name as a pointer and a size, so
+    /// callers holding names in other buffers need not build an std::wstring.
     class TreeMap : public TreeNode
     {
+    public:
+
+        typedef std::vector<std::pair<std::wstring, std::unique_ptr<TreeNode>>> Nodes;
+
     private:
 
-        std::map<std::wstring, std::unique_ptr<TreeNode>> nodes;
+        enum
+        {
+            /// Maps up to this size have no index.
+            MAX_LINEAR_SIZE = 8
+        };
+
+        Nodes nodes;
+
+        /// Linear probing table with a power of two size, kept at most half full.
+        std::vector<details::TreeMapSlot> slots;
 
     public:
 
@@ -53,37 +97,68 @@ namespace ccb { namespace tree
             return TreeNodeType::Map;
         }
 
+        size_t GetSize() const
+        {
+            return this->nodes.size();
+        }
+
+        bool HasNode(const wchar_t* name, size_t size) const
+        {
+            return this->Find(name, size) != nullptr;
+        }
+
+        bool HasNode(const wchar_t* name) const
+        {
+            return this->HasNode(name, wcslen(name));
+        }
+
         bool HasNode(const std::wstring& name) const
         {
-            return this->nodes.count(name) > 0;
+            return this->HasNode(name.data(), name.size());
         }
 
-        const std::map<std::wstring, std::unique_ptr<TreeNode>>& GetNodes() const
+        const Nodes& GetNodes() const
         {
             return this->nodes;
         }
 
-        TreeNode& GetNode(const std::wstring& name)
+        /// Node of the given name, or nullptr.
+        const TreeNode* FindNode(const wchar_t* name, size_t size) const
+        {
+            return this->Find(name, size);
+        }
+
+        TreeNode& GetNode(const wchar_t* name, size_t size)
         {
-            auto pos = this->nodes.find(name);
-            if (pos == this->nodes.end())
+            auto node = this->Find(name, size);
+            if (node == nullptr)
             {
                 throw std::runtime_error("No such node");
             }
 
-            return *pos->second;
+            return *node;
+        }
+
+        TreeNode& GetNode(const wchar_t* name)
+        {
+            return this->GetNode(name, wcslen(name));
+        }
+
+        TreeNode& GetNode(const std::wstring& name)
+        {
+            return this->GetNode(name.data(), name.size());
         }
 
         template<typename NodeType>
-        const typename std::enable_if<std::is_base_of<TreeNode, NodeType>::value, NodeType>::type& Get(const std::wstring& name) const
+        const typename std::enable_if<std::is_base_of<TreeNode, NodeType>::value, NodeType>::type& Get(const wchar_t* name, size_t size) const
         {
-            auto pos = this->nodes.find(name);
-            if (pos == this->nodes.end())
+            auto found = this->Find(name, size);
+            if (found == nullptr)
             {
                 throw std::runtime_error("No such node");
             }
 
-            auto node = dynamic_cast<const NodeType*>(pos->second.get());
+            auto node = dynamic_cast<const NodeType*>(found);
             if (node == nullptr)
             {
                 throw std::runtime_error("Is not of requested type");
@@ -93,22 +168,173 @@ namespace ccb { namespace tree
         }
 
         template<typename NodeType>
-        typename std::enable_if<std::is_base_of<TreeNode, NodeType>::value, NodeType>::type& Set(const std::wstring& name)
+        const typename std::enable_if<std::is_base_of<TreeNode, NodeType>::value, NodeType>::type& Get(const wchar_t* name) const
         {
-            auto pos = this->nodes.find(name);
-            if (pos != this->nodes.end())
-            {
-                this->nodes.erase(pos);
-            }
+            return this->Get<NodeType>(name, wcslen(name));
+        }
 
+        template<typename NodeType>
+        const typename std::enable_if<std::is_base_of<TreeNode, NodeType>::value, NodeType>::type& Get(const std::wstring& name) const
+        {
+            return this->Get<NodeType>(name.data(), name.size());
+        }
+
+        /// Creates a node, replacing the existing one of the same name in its place.
+        template<typename NodeType>
+        typename std::enable_if<std::is_base_of<TreeNode, NodeType>::value, NodeType>::type& Set(const std::wstring& name)
+        {
             auto node = new NodeType();
-            this->nodes.insert(std::make_pair(name, std::unique_ptr<TreeNode>(node)));
+            this->Set(name, std::unique_ptr<TreeNode>(node));
             return *node;
         }
 
         void Set(const std::wstring& name, std::unique_ptr<TreeNode>&& node)
         {
-            this->nodes[name] = std::move(node);
+            this->Set(std::wstring(name), std::move(node));
+        }
+
+        void Set(std::wstring&& name, std::unique_ptr<TreeNode>&& node)
+        {
+            auto hash = details::HashTreeName(name.data(), name.size());
+
+            auto index = this->FindIndex(name.data(), name.size(), hash);
+            if (index < this->nodes.size())
+            {
+                this->nodes[index].second = std::move(node);
+            }
+            else
+            {
+                this->Append(std::move(name), std::move(node), hash);
+            }
+        }
+
+        /// Adds a node unless there already is one of the same name. Returns whether it was added.
+        bool Add(const std::wstring& name, std::unique_ptr<TreeNode>&& node)
+        {
+            auto hash = details::HashTreeName(name.data(), name.size());
+
+            if (this->FindIndex(name.data(), name.size(), hash) < this->nodes.size())
+            {
+                return false;
+            }
+
+            this->Append(std::wstring(name), std::move(node), hash);
+            return true;
+        }
+
+        void Reserve(size_t size)
+        {
+            this->nodes.reserve(size);
+
+            if (size > MAX_LINEAR_SIZE)
+            {
+                size_t capacity = 4 * MAX_LINEAR_SIZE;
+                while (capacity < 2 * size)
+                {
+                    capacity *= 2;
+                }
+
+                if (capacity > this->slots.size())
+                {
+                    this->Rehash(capacity);
+                }
+            }
+        }
+
+    private:
+
+        const TreeNode* Find(const wchar_t* name, size_t size) const
+        {
+            auto index = this->FindIndex(name, size, this->slots.empty() ? 0 : details::HashTreeName(name, size));
+
+            return (index < this->nodes.size()) ? this->nodes[index].second.get() : nullptr;
+        }
+
+        TreeNode* Find(const wchar_t* name, size_t size)
+        {
+            return const_cast<TreeNode*>(static_cast<const TreeMap*>(this)->Find(name, size));
+        }
+
+        /// Returns the node index, or the node count when there is no such node. The hash is only
+        /// used when the map has an index.
+        size_t FindIndex(const wchar_t* name, size_t size, uint32_t hash) const
+        {
+            if (this->slots.empty())
+            {
+                for (size_t i = 0; i < this->nodes.size(); i++)
+                {
+                    if (this->Equals(i, name, size))
+                    {
+                        return i;
+                    }
+                }
+
+                return this->nodes.size();
+            }
+
+            auto mask = this->slots.size() - 1;
+            for (auto pos = hash & mask; this->slots[pos].index != 0; pos = (pos + 1) & mask)
+            {
+                const auto& slot = this->slots[pos];
+                if ((slot.hash == hash) && this->Equals(slot.index - 1, name, size))
+                {
+                    return slot.index - 1;
+                }
+            }
+
+            return this->nodes.size();
+        }
+
+        void Append(std::wstring&& name, std::unique_ptr<TreeNode>&& node, uint32_t hash)
+        {
+            this->nodes.emplace_back(std::move(name), std::move(node));
+
+            if (!this->slots.empty())
+            {
+                if (this->nodes.size() * 2 > this->slots.size())
+                {
+                    this->Rehash(this->slots.size() * 2);
+                }
+                else
+                {
+                    this->Insert(static_cast<uint32_t>(this->nodes.size() - 1), hash);
+                }
+            }
+            else if (this->nodes.size() > MAX_LINEAR_SIZE)
+            {
+                this->Rehash(4 * MAX_LINEAR_SIZE);
+            }
+        }
+
+        bool Equals(size_t index, const wchar_t* name, size_t size) const
+        {
+            const auto& key = this->nodes[index].first;
+            return (key.size() == size) && (wmemcmp(key.data(), name, size) == 0);
+        }
+
+        void Insert(uint32_t index, uint32_t hash)
+        {
+            auto mask = this->slots.size() - 1;
+
+            auto pos = hash & mask;
+            while (this->slots[pos].index != 0)
+            {
+                pos = (pos + 1) & mask;
+            }
+
+            this->slots[pos].index = index + 1;
+            this->slots[pos].hash = hash;
+        }
+
+        void Rehash(size_t capacity)
+        {
+            this->slots.assign(capacity, details::TreeMapSlot());
+
+            for (size_t i = 0; i < this->nodes.size(); i++)
+            {
+                const auto& key = this->nodes[i].first;
+                this->Insert(static_cast<uint32_t>(i), details::HashTreeName(key.data(), key.size()));
+            }
         }
     };
 } }
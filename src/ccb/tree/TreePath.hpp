@@ -0,0 +1,361 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <ccb/charset/Utf8.hpp>
+#include <ccb/tree/TreeArray.hpp>
+#include <ccb/tree/TreeMap.hpp>
+#include <ccb/tree/TreeValue.hpp>
+
+namespace ccb { namespace tree
+{
+    namespace details
+    {
+        /// One reference token of a path.
+        struct TreePathStep
+        {
+            std::wstring name;
+
+            /// The name as UTF-8, compared against raw JSON keys.
+            std::string utf8Name;
+
+            /// Array index, valid when isIndex is set.
+            size_t index = 0;
+
+            /// The name is a valid array index.
+            bool isIndex = false;
+
+            /// Matches every member or item.
+            bool any = false;
+
+            bool Matches(const char* key, size_t size) const
+            {
+                return this->any || ((this->utf8Name.size() == size) && (this->utf8Name.compare(0, size, key, size) == 0));
+            }
+
+            bool Matches(size_t item) const
+            {
+                return this->any || (this->isIndex && (this->index == item));
+            }
+        };
+
+        /// Appends a reference token to a pointer, escaping '~' and '/'.
+        inline void AppendTreePathStep(std::wstring& pointer, const std::wstring& name)
+        {
+            pointer += L'/';
+
+            for (auto c : name)
+            {
+                if (c == L'~')
+                {
+                    pointer += L"~0";
+                }
+                else if (c == L'/')
+                {
+                    pointer += L"~1";
+                }
+                else
+                {
+                    pointer += c;
+                }
+            }
+        }
+    }
+
+    /// JSON Pointer (RFC 6901) compiled into steps, for example "/servers/0/name". A segment that is
+    /// just "*" matches every member of a map or item of an array. Paths are resolved against TreeNode
+    /// hierarchies, node handles such as TreeDocumentNode and LazyJsonNode, and JSON text through
+    /// JsonPathExtractor.
+    class TreePath
+    {
+    private:
+
+        std::vector<details::TreePathStep> steps;
+
+        bool hasWildcards = false;
+
+    public:
+
+        TreePath()
+        {
+        }
+
+        TreePath(const std::wstring& pointer)
+        {
+            if (pointer.empty())
+            {
+                return;
+            }
+
+            if (pointer[0] != L'/')
+            {
+                throw std::invalid_argument("JSON pointer must start with '/'");
+            }
+
+            size_t pos = 1;
+
+            while (true)
+            {
+                auto next = pointer.find(L'/', pos);
+                if (next == std::wstring::npos)
+                {
+                    next = pointer.size();
+                }
+
+                this->steps.push_back(ParseStep(pointer, pos, next));
+                this->hasWildcards = this->hasWildcards || this->steps.back().any;
+
+                if (next == pointer.size())
+                {
+                    break;
+                }
+
+                pos = next + 1;
+            }
+        }
+
+    public:
+
+        /// Number of steps; the empty path refers to the root itself.
+        size_t GetSize() const
+        {
+            return this->steps.size();
+        }
+
+        bool HasWildcards() const
+        {
+            return this->hasWildcards;
+        }
+
+        const details::TreePathStep& GetStep(size_t idx) const
+        {
+            return this->steps.at(idx);
+        }
+
+        /// First node the path refers to, or nullptr.
+        const TreeNode* Find(const TreeNode& root) const
+        {
+            std::vector<const TreeNode*> result;
+            this->Collect(root, 0, result, true);
+
+            return result.empty() ? nullptr : result.front();
+        }
+
+        /// All nodes the path refers to, in document order.
+        std::vector<const TreeNode*> FindAll(const TreeNode& root) const
+        {
+            std::vector<const TreeNode*> result;
+            this->Collect(root, 0, result, false);
+
+            return result;
+        }
+
+        /// Nodes the path refers to, starting from the given step at the given node.
+        void FindAll(const TreeNode& node, size_t step, std::vector<const TreeNode*>& result) const
+        {
+            this->Collect(node, step, result, false);
+        }
+
+        template<typename NodeType>
+        const typename std::enable_if<std::is_base_of<TreeNode, NodeType>::value, NodeType>::type& Get(const TreeNode& root) const
+        {
+            auto found = this->Find(root);
+            if (found == nullptr)
+            {
+                throw std::runtime_error("No such node");
+            }
+
+            auto node = dynamic_cast<const NodeType*>(found);
+            if (node == nullptr)
+            {
+                throw std::runtime_error("Is not of requested type");
+            }
+
+            return *node;
+        }
+
+        /// All nodes the path refers to, for read-only node handles with GetType(), GetSize(), Get(idx),
+        /// HasNode(name) and GetNode(name).
+        template<typename Node>
+        std::vector<Node> Select(const Node& root) const
+        {
+            std::vector<Node> result;
+            this->CollectHandles(root, 0, result);
+
+            return result;
+        }
+
+        std::wstring ToString() const
+        {
+            std::wstring result;
+
+            for (const auto& step : this->steps)
+            {
+                details::AppendTreePathStep(result, step.name);
+            }
+
+            return result;
+        }
+
+    private:
+
+        static details::TreePathStep ParseStep(const std::wstring& pointer, size_t begin, size_t end)
+        {
+            details::TreePathStep step;
+
+            for (auto i = begin; i < end; i++)
+            {
+                if (pointer[i] != L'~')
+                {
+                    step.name += pointer[i];
+                }
+                else if ((i + 1 < end) && (pointer[i + 1] == L'0'))
+                {
+                    step.name += L'~';
+                    i++;
+                }
+                else if ((i + 1 < end) && (pointer[i + 1] == L'1'))
+                {
+                    step.name += L'/';
+                    i++;
+                }
+                else
+                {
+                    throw std::invalid_argument("Bad escape in JSON pointer");
+                }
+            }
+
+            charset::WideToUtf8(step.name.data(), step.name.size(), step.utf8Name);
+
+            // Array indexes have no leading zeros.
+            step.isIndex = !step.name.empty() && ((step.name.size() == 1) || (step.name[0] != L'0'));
+
+            for (auto c : step.name)
+            {
+                if ((c < L'0') || (c > L'9') || (step.index > (SIZE_MAX - 9) / 10))
+                {
+                    step.isIndex = false;
+                    break;
+                }
+
+                step.index = step.index * 10 + static_cast<size_t>(c - L'0');
+            }
+
+            step.any = (step.name == L"*");
+
+            return step;
+        }
+
+        /// Returns true when the search can stop.
+        bool Collect(const TreeNode& node, size_t idx, std::vector<const TreeNode*>& result, bool firstOnly) const
+        {
+            if (idx == this->steps.size())
+            {
+                result.push_back(&node);
+                return firstOnly;
+            }
+
+            const auto& step = this->steps[idx];
+
+            if (node.GetType() == TreeNodeType::Map)
+            {
+                const auto& map = static_cast<const TreeMap&>(node);
+
+                if (!step.any)
+                {
+                    auto child = map.FindNode(step.name.data(), step.name.size());
+                    return (child != nullptr) && this->Collect(*child, idx + 1, result, firstOnly);
+                }
+
+                for (const auto& pair : map.GetNodes())
+                {
+                    if (this->Collect(*pair.second, idx + 1, result, firstOnly))
+                    {
+                        return true;
+                    }
+                }
+            }
+            else if (node.GetType() == TreeNodeType::Array)
+            {
+                const auto& items = static_cast<const TreeArray&>(node).GetNodes();
+
+                if (!step.any)
+                {
+                    return step.isIndex && (step.index < items.size()) && this->Collect(*items[step.index], idx + 1, result, firstOnly);
+                }
+
+                for (const auto& item : items)
+                {
+                    if (this->Collect(*item, idx + 1, result, firstOnly))
+                    {
+                        return true;
+                    }
+                }
+            }
+
+            return false;
+        }
+
+        template<typename Node>
+        void CollectHandles(const Node& node, size_t idx, std::vector<Node>& result) const
+        {
+            if (idx == this->steps.size())
+            {
+                result.push_back(node);
+                return;
+            }
+
+            const auto& step = this->steps[idx];
+            auto type = node.GetType();
+
+            if ((type == TreeNodeType::Value) || (!step.any && (type == TreeNodeType::Array) && !step.isIndex))
+            {
+                return;
+            }
+
+            if (step.any)
+            {
+                for (size_t i = 0; i < node.GetSize(); i++)
+                {
+                    this->CollectHandles(node.Get(i), idx + 1, result);
+                }
+            }
+            else if (type == TreeNodeType::Map)
+            {
+                if (node.HasNode(step.name))
+                {
+                    this->CollectHandles(node.GetNode(step.name), idx + 1, result);
+                }
+            }
+            else if (step.index < node.GetSize())
+            {
+                this->CollectHandles(node.Get(step.index), idx + 1, result);
+            }
+        }
+    };
+} }
@@ -22,26 +22,256 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <sstream>
+#include <string>
+#include <type_traits>
 
 #include <ccb/tree/TreeNode.hpp>
+#include <ccb/tree/TreeValueType.hpp>
 
 namespace ccb { namespace tree
 {
+    namespace details
+    {
+        /// Writes the decimal digits of the value. The buffer must hold at least 20 characters.
+        /// Returns the text length.
+        inline size_t FormatInt(int64_t value, char* buffer)
+        {
+            char digits[20];
+            auto pos = digits + sizeof(digits);
+
+            auto magnitude = (value < 0) ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+
+            do
+            {
+                *--pos = static_cast<char>('0' + magnitude % 10);
+                magnitude /= 10;
+            }
+            while (magnitude != 0);
+
+            auto size = static_cast<size_t>(digits + sizeof(digits) - pos);
+            if (value < 0)
+            {
+                *buffer++ = '-';
+            }
+
+            memcpy(buffer, pos, size);
+
+            return size + (value < 0 ? 1 : 0);
+        }
+
+        /// Formats values that are exactly n / 10^k with n below 2^53 without going through snprintf:
+        /// both n and 10^k are exact doubles then, so the division is correctly rounded and the smallest
+        /// such k gives the shortest text. Returns 0 for other values.
+        inline size_t FormatShortDecimal(double value, char* buffer)
+        {
+            static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+
+            // Same range as %g with the default exponent switch, so that the output looks the same.
+            auto magnitude = std::fabs(value);
+            if (!(magnitude >= 1e-4) || !(magnitude < 1e15))
+            {
+                return 0;
+            }
+
+            for (int k = 0; k < 16; k++)
+            {
+                auto scaled = magnitude * powers[k];
+                if (scaled >= 9007199254740992.0)
+                {
+                    break;
+                }
+
+                auto n = static_cast<int64_t>(scaled + 0.5);
+                if (static_cast<double>(n) / powers[k] != magnitude)
+                {
+                    continue;
+                }
+
+                char digits[20];
+                auto size = FormatInt(n, digits);
+
+                auto pos = buffer;
+                if (value < 0)
+                {
+                    *pos++ = '-';
+                }
+
+                if (static_cast<size_t>(k) < size)
+                {
+                    memcpy(pos, digits, size - k);
+                    pos += size - k;
+                }
+                else
+                {
+                    *pos++ = '0';
+                }
+
+                if (k > 0)
+                {
+                    *pos++ = '.';
+
+                    for (auto zeros = k - static_cast<int>(size); zeros > 0; zeros--)
+                    {
+                        *pos++ = '0';
+                    }
+
+                    auto fraction = std::min(static_cast<size_t>(k), size);
+                    memcpy(pos, digits + size - fraction, fraction);
+                    pos += fraction;
+                }
+
+                return static_cast<size_t>(pos - buffer);
+            }
+
+            return 0;
+        }
+
+        /// Writes the shortest representation of the value that reads back to the same double.
+        /// The buffer must hold at least 32 characters. Returns the text length.
+        inline size_t FormatDouble(double value, char* buffer)
+        {
+            auto size = FormatShortDecimal(value, buffer);
+            if (size != 0)
+            {
+                return size;
+            }
+
+            for (int precision = 15; precision <= 17; precision++)
+            {
+                auto length = snprintf(buffer, 32, "%.*g", precision, value);
+
+                if ((precision == 17) || (strtod(buffer, nullptr) == value))
+                {
+                    return static_cast<size_t>(length);
+                }
+            }
+
+            return 0;
+        }
+
+        /// Parses JSON number text. Integers that fit int64_t give Int, fractions and exponents give
+        /// Double; larger integers give String, so that they can still be read exactly as text.
+        inline TreeValueType ParseNumber(const char* text, size_t size, int64_t& intValue, double& doubleValue)
+        {
+            auto pos = text;
+            auto end = text + size;
+
+            bool negative = (pos != end) && (*pos == '-');
+            if (negative)
+            {
+                pos++;
+            }
+
+            uint64_t magnitude = 0;
+            bool overflow = false;
+
+            for (; (pos != end) && (*pos >= '0') && (*pos <= '9'); pos++)
+            {
+                auto digit = static_cast<uint64_t>(*pos - '0');
+
+                if (magnitude > (std::numeric_limits<uint64_t>::max() - digit) / 10)
+                {
+                    overflow = true;
+                }
+
+                magnitude = magnitude * 10 + digit;
+            }
+
+            if (pos == end)
+            {
+                auto limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + (negative ? 1 : 0);
+
+                if (overflow || (magnitude > limit))
+                {
+                    return TreeValueType::String;
+                }
+
+                intValue = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+                return TreeValueType::Int;
+            }
+
+            std::string copy(text, size);
+            doubleValue = strtod(copy.c_str(), nullptr);
+
+            return TreeValueType::Double;
+        }
+
+        // Parses text of a value, reading one byte integers as numbers rather than characters.
+
+        template<typename T, typename Char>
+        typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, T>::type ParseValue(const std::basic_string<Char>& text)
+        {
+            long long result = 0;
+            std::basic_istringstream<Char> stream(text);
+            stream >> result;
+            return static_cast<T>(result);
+        }
+
+        template<typename T, typename Char>
+        typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value && !std::is_same<T, bool>::value, T>::type ParseValue(const std::basic_string<Char>& text)
+        {
+            unsigned long long result = 0;
+            std::basic_istringstream<Char> stream(text);
+            stream >> result;
+            return static_cast<T>(result);
+        }
+
+        template<typename T, typename Char>
+        typename std::enable_if<std::is_same<T, bool>::value, T>::type ParseValue(const std::basic_string<Char>& text)
+        {
+            static const Char trueText[] = { 't', 'r', 'u', 'e', 0 };
+
+            return text == trueText;
+        }
+
+        template<typename T, typename Char>
+        typename std::enable_if<!std::is_integral<T>::value, T>::type ParseValue(const std::basic_string<Char>& text)
+        {
+            T result = T();
+            std::basic_istringstream<Char> stream(text);
+            stream >> result;
+            return result;
+        }
+    }
+
+    /// Leaf of a tree. Holds a string, or a native null, bool, int64_t or double. Native values are
+    /// formatted on every GetString() call rather than cached, so const access stays thread safe.
     class TreeValue : public TreeNode
     {
     private:
 
+        TreeValueType type = TreeValueType::String;
+
+        union
+        {
+            bool boolValue;
+
+            int64_t intValue;
+
+            double doubleValue;
+        };
+
+        /// The string; empty for native values.
         std::wstring value;
 
     public:
 
         TreeValue()
+            : intValue(0)
         {
         }
 
         TreeValue(const std::wstring& value)
-            : value(value)
+            : intValue(0)
+            , value(value)
         {
         }
 
@@ -52,31 +282,145 @@ namespace ccb { namespace tree
             return TreeNodeType::Value;
         }
 
-        const std::wstring& GetString() const
+        TreeValueType GetValueType() const
+        {
+            return this->type;
+        }
+
+        bool IsNull() const
+        {
+            return this->type == TreeValueType::Null;
+        }
+
+        std::wstring GetString() const
         {
-            return this->value;
+            return (this->type == TreeValueType::String) ? this->value : this->FormatNative();
         }
 
         void SetString(const std::wstring& value)
         {
+            this->type = TreeValueType::String;
             this->value = value;
         }
 
+        void SetNull()
+        {
+            this->SetNative(TreeValueType::Null);
+        }
+
+        /// Sets the value from JSON number text, see details::ParseNumber().
+        void SetNumber(const char* text, size_t size)
+        {
+            int64_t intValue = 0;
+            double doubleValue = 0;
+
+            auto type = details::ParseNumber(text, size, intValue, doubleValue);
+
+            if (type == TreeValueType::Int)
+            {
+                this->SetValue(intValue);
+            }
+            else if (type == TreeValueType::Double)
+            {
+                this->SetValue(doubleValue);
+            }
+            else
+            {
+                this->SetString(std::wstring(text, text + size));
+            }
+        }
+
+        /// Arithmetic types are converted from the native value, strings are parsed.
         template<typename ValueType>
-        ValueType GetValue() const
+        typename std::enable_if<std::is_arithmetic<ValueType>::value, ValueType>::type GetValue() const
         {
-            ValueType result;
-            std::wistringstream stream(this->value);
-            stream >> result;
-            return result;
+            switch (this->type)
+            {
+            case TreeValueType::Null:
+                return ValueType();
+
+            case TreeValueType::Bool:
+                return static_cast<ValueType>(this->boolValue);
+
+            case TreeValueType::Int:
+                return static_cast<ValueType>(this->intValue);
+
+            case TreeValueType::Double:
+                return static_cast<ValueType>(this->doubleValue);
+
+            default:
+                return details::ParseValue<ValueType>(this->value);
+            }
+        }
+
+        template<typename ValueType>
+        typename std::enable_if<!std::is_arithmetic<ValueType>::value, ValueType>::type GetValue() const
+        {
+            return details::ParseValue<ValueType>(this->GetString());
+        }
+
+        void SetValue(bool value)
+        {
+            this->SetNative(TreeValueType::Bool);
+            this->boolValue = value;
+        }
+
+        template<typename ValueType>
+        typename std::enable_if<std::is_integral<ValueType>::value && !std::is_same<ValueType, bool>::value>::type SetValue(const ValueType& value)
+        {
+            // Unsigned values above the int64_t range are kept as text.
+            if (!std::is_signed<ValueType>::value &&
+                (static_cast<uint64_t>(value) > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())))
+            {
+                this->SetString(std::to_wstring(static_cast<unsigned long long>(value)));
+                return;
+            }
+
+            this->SetNative(TreeValueType::Int);
+            this->intValue = static_cast<int64_t>(value);
+        }
+
+        template<typename ValueType>
+        typename std::enable_if<std::is_floating_point<ValueType>::value>::type SetValue(const ValueType& value)
+        {
+            this->SetNative(TreeValueType::Double);
+            this->doubleValue = static_cast<double>(value);
         }
 
         template<typename ValueType>
-        void SetValue(const ValueType& value)
+        typename std::enable_if<!std::is_arithmetic<ValueType>::value>::type SetValue(const ValueType& value)
         {
             std::wostringstream stream;
             stream << value;
-            this->value = stream.str();
+            this->SetString(stream.str());
+        }
+
+    private:
+
+        void SetNative(TreeValueType type)
+        {
+            this->type = type;
+            this->value.clear();
+        }
+
+        std::wstring FormatNative() const
+        {
+            switch (this->type)
+            {
+            case TreeValueType::Null:
+                return L"null";
+
+            case TreeValueType::Bool:
+                return this->boolValue ? L"true" : L"false";
+
+            case TreeValueType::Int:
+                return std::to_wstring(static_cast<long long>(this->intValue));
+
+            default:
+                char buffer[32];
+                auto size = details::FormatDouble(this->doubleValue, buffer);
+                return std::wstring(buffer, buffer + size);
+            }
         }
     };
 } }
@@ -0,0 +1,87 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <list>
+
+#include <ccb/binary/ByteIterator.hpp>
+
+namespace ccb { namespace binary
+{
+    class ByteIteratorTests : public CxxTest::TestSuite
+    {
+    private:
+
+        template<typename Endianness, size_t N, typename Iter>
+        static std::vector<uint32_t> Collect(Iter begin, Iter end)
+        {
+            std::vector<uint32_t> result;
+
+            ByteIterator<Endianness, N, Iter> it(begin, end);
+            ByteIterator<Endianness, N, Iter> last(end, end);
+
+            for (; it != last; ++it)
+            {
+                result.push_back(*it);
+            }
+
+            return result;
+        }
+
+    public:
+
+        void TestPointerAndListIteratorsAgree()
+        {
+            const uint8_t data[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 };
+            std::list<uint8_t> list(data, data + sizeof(data));
+
+            auto big2 = Collect<BigEndian, 2>(data, data + sizeof(data));
+            auto little2 = Collect<LittleEndian, 2>(data, data + sizeof(data));
+            auto big4 = Collect<BigEndian, 4>(data, data + sizeof(data));
+            auto little4 = Collect<LittleEndian, 4>(data, data + sizeof(data));
+
+            TS_ASSERT(big2 == (Collect<BigEndian, 2>(list.begin(), list.end())));
+            TS_ASSERT(little2 == (Collect<LittleEndian, 2>(list.begin(), list.end())));
+            TS_ASSERT(big4 == (Collect<BigEndian, 4>(list.begin(), list.end())));
+            TS_ASSERT(little4 == (Collect<LittleEndian, 4>(list.begin(), list.end())));
+            TS_ASSERT_EQUALS(0x04030201u, little4[0]);
+        }
+
+        void TestCanIterateOverPointers()
+        {
+            const char data[] = "\x12\x34\x56\x78\x9a";
+
+            // An incomplete unit at the end is not produced.
+            auto values = Collect<BigEndian, 2>(data, data + 5);
+
+            TS_ASSERT_EQUALS(2u, values.size());
+            TS_ASSERT_EQUALS(0x1234u, values.at(0));
+            TS_ASSERT_EQUALS(0x5678u, values.at(1));
+
+            values = Collect<LittleEndian, 4>(data, data + 5);
+
+            TS_ASSERT_EQUALS(1u, values.size());
+            TS_ASSERT_EQUALS(0x78563412u, values.at(0));
+        }
+    };
+} }
@@ -0,0 +1,133 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+#include <ccb/binary/Hex.hpp>
+
+namespace ccb { namespace binary
+{
+    class HexTests : public CxxTest::TestSuite
+    {
+    private:
+
+        static std::string ReferenceHex(const std::vector<uint8_t>& data)
+        {
+            std::ostringstream stream;
+            for (auto b : data)
+            {
+                stream << std::hex << std::setw(2) << std::setfill('0') << (int)b;
+            }
+
+            return stream.str();
+        }
+
+    public:
+
+        void TestCanEncodeAllLengths()
+        {
+            std::vector<uint8_t> data;
+
+            for (size_t i = 0; i < 200; i++)
+            {
+                TS_ASSERT_EQUALS(ReferenceHex(data), ToHex(data.data(), data.size()));
+                data.push_back(static_cast<uint8_t>(i * 37 + 11));
+            }
+        }
+
+        void TestCanRoundTripAllBytes()
+        {
+            std::vector<uint8_t> data;
+            for (int i = 0; i < 256; i++)
+            {
+                data.push_back(static_cast<uint8_t>(i));
+            }
+
+            auto hex = ToHex(data.data(), data.size());
+
+            TS_ASSERT(data == FromHex(hex));
+        }
+
+        void TestCanDecodeUpperCase()
+        {
+            std::vector<uint8_t> expected(40, 0xab);
+            expected.back() = 0xcd;
+
+            std::string hex;
+            for (size_t i = 0; i < 39; i++)
+            {
+                hex += (i % 2 == 0) ? "AB" : "ab";
+            }
+            hex += "Cd";
+
+            TS_ASSERT(expected == FromHex(hex));
+        }
+
+        void TestInvalidSymbolThrows()
+        {
+            for (size_t pos = 0; pos < 140; pos += 7)
+            {
+                std::string hex(140, '0');
+                hex[pos] = 'g';
+
+                TS_ASSERT_THROWS(FromHex(hex), std::invalid_argument);
+
+                hex[pos] = '0' - 1;
+                TS_ASSERT_THROWS(FromHex(hex), std::invalid_argument);
+
+                hex[pos] = static_cast<char>('0' + 128);
+                TS_ASSERT_THROWS(FromHex(hex), std::invalid_argument);
+            }
+        }
+
+        void TestOddLengthThrows()
+        {
+            TS_ASSERT_THROWS(FromHex("abc"), std::invalid_argument);
+        }
+
+        void TestHexPerformance()
+        {
+            std::vector<uint8_t> data(16 * 1024 * 1024);
+            for (size_t i = 0; i < data.size(); i++)
+            {
+                data[i] = static_cast<uint8_t>(i * 2654435761u >> 13);
+            }
+
+            auto t1 = std::chrono::system_clock::now();
+            auto hex = ToHex(data.data(), data.size());
+            auto t2 = std::chrono::system_clock::now();
+            auto decoded = FromHex(hex);
+            auto t3 = std::chrono::system_clock::now();
+
+            TS_ASSERT(data == decoded);
+
+            std::cout << std::endl << "Hex of " << data.size() << " bytes encoded in "
+                << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " micros, decoded in "
+                << std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count() << " micros" << std::endl;
+        }
+    };
+} }
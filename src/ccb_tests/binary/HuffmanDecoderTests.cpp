@@ -56,5 +56,154 @@ namespace ccb { namespace binary
             TS_ASSERT(!bitstream);
         }
 
+        void TestCanDecodeLongCodes()
+        {
+            HuffmanDecoder<int> decoder;
+
+            // Twelve codes of increasing length, the last two are longer than the primary table.
+            decoder.Add("1", 1);
+            decoder.Add("01", 2);
+            decoder.Add("001", 3);
+            decoder.Add("0001", 4);
+            decoder.Add("00001", 5);
+            decoder.Add("000001", 6);
+            decoder.Add("0000001", 7);
+            decoder.Add("00000001", 8);
+            decoder.Add("000000001", 9);
+            decoder.Add("0000000001", 10);
+            decoder.Add("00000000001", 11);
+            decoder.Add("00000000000", 12);
+
+            // 00000000001 0000000001 000000001 00000000000 1 = 42 bits, followed by 01 and padding
+            auto bits = std::vector<uint8_t> { 0x00, 0x20, 0x08, 0x04, 0x00, 0x50 };
+
+            auto bitstream = MakeInputBitStream(bits.begin(), bits.end());
+
+            TS_ASSERT_EQUALS(11, decoder.Next(bitstream));
+            TS_ASSERT_EQUALS(10, decoder.Next(bitstream));
+            TS_ASSERT_EQUALS(9, decoder.Next(bitstream));
+            TS_ASSERT_EQUALS(12, decoder.Next(bitstream));
+            TS_ASSERT_EQUALS(1, decoder.Next(bitstream));
+            TS_ASSERT_EQUALS(2, decoder.Next(bitstream));
+        }
+
+        void TestCanAddCodesAfterDecoding()
+        {
+            HuffmanDecoder<int> decoder;
+            decoder.Add("1", 1);
+
+            auto first = std::vector<uint8_t> { 0x80 };
+            auto firstStream = MakeInputBitStream(first.begin(), first.end());
+
+            TS_ASSERT_EQUALS(1, decoder.Next(firstStream));
+
+            decoder.Add("01", 2);
+            decoder.Add("00", 3);
+
+            auto second = std::vector<uint8_t> { 0x48 };
+            auto secondStream = MakeInputBitStream(second.begin(), second.end());
+
+            TS_ASSERT_EQUALS(2, decoder.Next(secondStream));
+            TS_ASSERT_EQUALS(3, decoder.Next(secondStream));
+            TS_ASSERT_EQUALS(1, decoder.Next(secondStream));
+        }
+
+        void TestCanDecodeFromBitOnlyStream()
+        {
+            auto decoder = HuffmanDecoder<int>
+            {
+                { "1", 1 },
+                { "01", 2 },
+                { "001", 3 },
+                { "000", 4 }
+            };
+
+            auto bits = std::vector<uint8_t> { 0xa4, 0x40 };
+
+            auto bitstream = MakeInputBitStream(bits.begin(), bits.end());
+            auto bitOnlyStream = BitOnlyStream<decltype(bitstream)>(bitstream);
+
+            TS_ASSERT_EQUALS(1, decoder.Next(bitOnlyStream));
+            TS_ASSERT_EQUALS(2, decoder.Next(bitOnlyStream));
+            TS_ASSERT_EQUALS(3, decoder.Next(bitOnlyStream));
+            TS_ASSERT_EQUALS(4, decoder.Next(bitOnlyStream));
+            TS_ASSERT_EQUALS(1, decoder.Next(bitOnlyStream));
+            TS_ASSERT_EQUALS(4, decoder.Next(bitOnlyStream));
+            TS_ASSERT_EQUALS(4, decoder.Next(bitOnlyStream));
+
+            TS_ASSERT(!bitstream);
+        }
+
+        void TestUnknownSequenceThrows()
+        {
+            auto decoder = HuffmanDecoder<int>
+            {
+                { "1", 1 },
+                { "01", 2 }
+            };
+
+            auto bits = std::vector<uint8_t> { 0x00 };
+
+            auto bitstream = MakeInputBitStream(bits.begin(), bits.end());
+
+            try
+            {
+                decoder.Next(bitstream);
+                TS_FAIL("Expected exception");
+            }
+            catch (const std::runtime_error&)
+            {
+            }
+        }
+
+        void TestConflictingCodesThrow()
+        {
+            typedef std::initializer_list<std::pair<const char*, int>> Codes;
+
+            TS_ASSERT_THROWS(HuffmanDecoder<int>(Codes { { "01", 1 }, { "1", 2 }, { "01", 3 } }), std::logic_error);
+            TS_ASSERT_THROWS(HuffmanDecoder<int>(Codes { { "011", 1 }, { "1", 2 }, { "0", 3 } }), std::logic_error);
+            TS_ASSERT_THROWS(HuffmanDecoder<int>(Codes { { "1", 1 }, { "0100", 2 }, { "0101", 3 }, { "01", 4 } }), std::logic_error);
+
+            HuffmanDecoder<int> decoder { { "1", 1 }, { "01", 2 } };
+
+            // A rejected code leaves the decoder as it was.
+            TS_ASSERT_THROWS(decoder.Add("10", 3), std::logic_error);
+            decoder.Add("00", 3);
+
+            auto bits = std::vector<uint8_t> { 0x48 };
+            auto bitstream = MakeInputBitStream(bits.begin(), bits.end());
+
+            TS_ASSERT_EQUALS(2, decoder.Next(bitstream));
+            TS_ASSERT_EQUALS(3, decoder.Next(bitstream));
+            TS_ASSERT_EQUALS(1, decoder.Next(bitstream));
+        }
+
+    private:
+
+        template<typename BitStream>
+        class BitOnlyStream
+        {
+        private:
+
+            BitStream& bitstream;
+
+        public:
+
+            BitOnlyStream(BitStream& bitstream)
+                : bitstream(bitstream)
+            {
+            }
+
+            operator bool () const
+            {
+                return this->bitstream;
+            }
+
+            BitOnlyStream& operator >> (bool& value)
+            {
+                this->bitstream >> value;
+                return *this;
+            }
+        };
     };
 } }
@@ -0,0 +1,113 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <map>
+#include <string>
+
+#include <ccb/binary/HuffmanEncoder.hpp>
+#include <ccb/binary/InputBitReader.hpp>
+#include <ccb/binary/OutputBitStream.hpp>
+
+namespace ccb { namespace binary
+{
+    class HuffmanEncoderTests : public CxxTest::TestSuite
+    {
+    public:
+
+        void TestCanBuildCodeLengths()
+        {
+            auto lengths = HuffmanEncoder<int>::BuildCodeLengths({ 1, 1, 2, 4, 0 }, 15);
+
+            TS_ASSERT_EQUALS(3u, lengths[0]);
+            TS_ASSERT_EQUALS(3u, lengths[1]);
+            TS_ASSERT_EQUALS(2u, lengths[2]);
+            TS_ASSERT_EQUALS(1u, lengths[3]);
+            TS_ASSERT_EQUALS(0u, lengths[4]);
+        }
+
+        void TestCanLimitCodeLengths()
+        {
+            // Fibonacci weights make an unrestricted Huffman code as deep as possible.
+            std::vector<uint64_t> weights = { 1, 1, 2, 3, 5, 8, 13, 21, 34, 55 };
+
+            auto lengths = HuffmanEncoder<int>::BuildCodeLengths(weights, 4);
+
+            uint32_t kraft = 0;
+            for (auto length : lengths)
+            {
+                TS_ASSERT(length >= 1);
+                TS_ASSERT(length <= 4);
+
+                kraft += 1 << (4 - length);
+            }
+
+            TS_ASSERT_EQUALS(16u, kraft);
+        }
+
+        void TestCanBuildCanonicalCodes()
+        {
+            auto encoder = HuffmanEncoder<char>::FromCodeLengths({ { 'a', 3 }, { 'b', 3 }, { 'c', 2 }, { 'd', 1 } });
+
+            TS_ASSERT_EQUALS(0x0u, encoder.GetCode('d').bits);
+            TS_ASSERT_EQUALS(0x2u, encoder.GetCode('c').bits);
+            TS_ASSERT_EQUALS(0x6u, encoder.GetCode('a').bits);
+            TS_ASSERT_EQUALS(0x7u, encoder.GetCode('b').bits);
+        }
+
+        void TestRoundTrip()
+        {
+            std::string text = "abracadabra, abracadabra, a magic word";
+
+            std::map<char, uint64_t> counts;
+            for (auto c : text)
+            {
+                counts[c]++;
+            }
+
+            auto encoder = HuffmanEncoder<char>::FromFrequencies(std::vector<std::pair<char, uint64_t>>(counts.begin(), counts.end()), 4);
+            auto decoder = encoder.CreateDecoder();
+
+            MsbOutputBitStream msbStream;
+            LsbOutputBitStream lsbStream;
+
+            for (auto c : text)
+            {
+                encoder.Write(msbStream, c);
+                encoder.Write(lsbStream, c);
+            }
+
+            auto msbBytes = msbStream.Release();
+            auto lsbBytes = lsbStream.Release();
+
+            MsbInputBitReader msbReader(msbBytes.data(), msbBytes.size());
+            LsbInputBitReader lsbReader(lsbBytes.data(), lsbBytes.size());
+
+            for (auto c : text)
+            {
+                TS_ASSERT_EQUALS(c, decoder.Next(msbReader));
+                TS_ASSERT_EQUALS(c, decoder.Next(lsbReader));
+            }
+        }
+    };
+} }
@@ -0,0 +1,174 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <cstring>
+#include <fstream>
+
+#include <ccb/binary/InputBinaryStream.hpp>
+#include <ccb/filesystem/TempPathGuard.hpp>
+
+namespace ccb { namespace binary
+{
+    class InputBinaryStreamTests : public CxxTest::TestSuite
+    {
+    public:
+
+        void TestCanReadValues()
+        {
+            auto stream = InputBinaryStream::FromHex("0102030405060708ff");
+
+            uint32_t value32;
+            stream >> value32;
+
+            uint8_t bytes[4];
+            stream.Read(bytes, sizeof(bytes));
+
+            uint8_t last;
+            stream >> last;
+
+            uint32_t expected32;
+            const uint8_t source[] = { 0x01, 0x02, 0x03, 0x04 };
+            memcpy(&expected32, source, sizeof(expected32));
+
+            TS_ASSERT_EQUALS(expected32, value32);
+            TS_ASSERT_EQUALS(0x05, bytes[0]);
+            TS_ASSERT_EQUALS(0x08, bytes[3]);
+            TS_ASSERT_EQUALS(0xff, last);
+            TS_ASSERT(stream.End());
+        }
+
+        void TestReadStopsAtEnd()
+        {
+            const uint8_t data[] = { 1, 2, 3 };
+            InputBinaryStream stream(data, sizeof(data));
+
+            uint8_t buffer[8] = { 0 };
+
+            TS_ASSERT_EQUALS(2u, stream.Read(buffer, 2));
+            TS_ASSERT_EQUALS(1u, stream.Read(buffer, sizeof(buffer)));
+            TS_ASSERT_EQUALS(3, buffer[0]);
+            TS_ASSERT_EQUALS(0u, stream.Read(buffer, sizeof(buffer)));
+        }
+
+        void TestCanReadWithByteOrder()
+        {
+            auto stream = InputBinaryStream::FromHex("12345678123456783ff8000000000000ab");
+
+            TS_ASSERT_EQUALS(0x12345678u, stream.ReadBE<uint32_t>());
+            TS_ASSERT_EQUALS(0x78563412u, stream.ReadLE<uint32_t>());
+            TS_ASSERT_EQUALS(1.5, stream.ReadBE<double>());
+            TS_ASSERT_EQUALS(-85, stream.ReadLE<int8_t>());
+
+            TS_ASSERT_THROWS(stream.ReadBE<uint16_t>(), std::out_of_range);
+        }
+
+        void TestCanBorrowMemory()
+        {
+            const uint8_t data[] = { 1, 2, 3, 4, 5 };
+            InputBinaryStream stream(data, sizeof(data));
+
+            stream.Skip(1);
+
+            auto span = stream.ReadSpan(3);
+
+            TS_ASSERT_EQUALS(data + 1, span);
+            TS_ASSERT_EQUALS(4u, stream.GetPosition());
+            TS_ASSERT_EQUALS(1u, stream.GetRemaining());
+            TS_ASSERT_EQUALS(5, stream.ReadUnchecked<uint8_t>());
+
+            TS_ASSERT_THROWS(stream.ReadSpan(1), std::out_of_range);
+        }
+
+        void TestMovedStreamKeepsPosition()
+        {
+            auto stream = InputBinaryStream::FromHex("0a0b0c");
+            stream.Skip(1);
+
+            InputBinaryStream moved(std::move(stream));
+
+            TS_ASSERT_EQUALS(0x0b, moved.ReadUnchecked<uint8_t>());
+            TS_ASSERT_EQUALS(0x0c, moved.ReadUnchecked<uint8_t>());
+            TS_ASSERT(moved.End());
+        }
+
+        void TestCanCopyAndAssign()
+        {
+            auto stream = InputBinaryStream::FromHex("0a0b0c");
+            stream.Skip(1);
+
+            {
+                InputBinaryStream copy(stream);
+                stream = InputBinaryStream::FromHex("0d");
+
+                TS_ASSERT_EQUALS(0x0b, copy.ReadUnchecked<uint8_t>());
+                TS_ASSERT_EQUALS(0x0d, stream.ReadUnchecked<uint8_t>());
+
+                stream = copy;
+            }
+
+            TS_ASSERT_EQUALS(0x0c, stream.ReadUnchecked<uint8_t>());
+            TS_ASSERT(stream.End());
+        }
+
+        void TestCanReadMappedFile()
+        {
+            filesystem::TempPathGuard guard;
+
+            {
+                std::ofstream file(guard.GetPath().ToShortString(), std::ios::binary);
+                file << "mapped data";
+            }
+
+            auto stream = InputBinaryStream::FromFile(guard.GetPath());
+
+            TS_ASSERT_EQUALS(11u, stream.GetSize());
+            TS_ASSERT_EQUALS(0, memcmp(stream.ReadSpan(6), "mapped", 6));
+
+            char rest[5];
+            stream.ReadUnchecked(rest, sizeof(rest));
+            TS_ASSERT_EQUALS(0, memcmp(rest, " data", 5));
+            TS_ASSERT(stream.End());
+        }
+
+        void TestCanMapEmptyFile()
+        {
+            filesystem::TempPathGuard guard;
+
+            {
+                std::ofstream file(guard.GetPath().ToShortString(), std::ios::binary);
+            }
+
+            auto stream = InputBinaryStream::FromFile(guard.GetPath());
+
+            TS_ASSERT(stream.End());
+        }
+
+        void TestMappingMissingFileThrows()
+        {
+            filesystem::TempPathGuard guard;
+
+            TS_ASSERT_THROWS(InputBinaryStream::FromFile(guard.GetPath()), std::runtime_error);
+        }
+    };
+} }
@@ -0,0 +1,136 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <ccb/binary/HuffmanDecoder.hpp>
+#include <ccb/binary/InputBitReader.hpp>
+
+namespace ccb { namespace binary
+{
+    class InputBitReaderTests : public CxxTest::TestSuite
+    {
+    public:
+
+        void TestCanReadMsbFirst()
+        {
+            std::vector<uint8_t> bytes = { 0xAB, 0xCD, 0xEF, 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD };
+
+            MsbInputBitReader reader(bytes.data(), bytes.size());
+
+            TS_ASSERT_EQUALS(0xAu, reader.Read(4));
+            TS_ASSERT_EQUALS(true, reader.Read());
+            TS_ASSERT_EQUALS(0x3u, reader.Read(3));
+            TS_ASSERT_EQUALS(0xCDEF0123456789ABull >> 7, reader.Read(57));
+            TS_ASSERT_EQUALS(0x2Bu, reader.Read(7));
+            TS_ASSERT_EQUALS(0xCDu, reader.Read(8));
+
+            TS_ASSERT(!reader.IsGood());
+        }
+
+        void TestCanReadLsbFirst()
+        {
+            std::vector<uint8_t> bytes = { 0xAB, 0xCD, 0xEF };
+
+            LsbInputBitReader reader(bytes.data(), bytes.size());
+
+            TS_ASSERT_EQUALS(0xBu, reader.Read(4));
+            TS_ASSERT_EQUALS(false, reader.Read());
+            TS_ASSERT_EQUALS(0x5u, reader.Read(3));
+            TS_ASSERT_EQUALS(0xEFCDu, reader.Peek(16));
+            TS_ASSERT_EQUALS(0xEFCDu, reader.Read(16));
+
+            TS_ASSERT(!reader.IsGood());
+            TS_ASSERT_EQUALS(0u, reader.Read(8));
+        }
+
+        void TestTracksEnd()
+        {
+            std::vector<uint8_t> bytes = { 0xFF, 0xFF };
+
+            MsbInputBitReader reader(bytes.data(), bytes.size());
+
+            TS_ASSERT_EQUALS(0xFFFF0u, reader.Peek(20));
+            TS_ASSERT(reader.HasBits(16));
+            TS_ASSERT(!reader.HasBits(17));
+
+            reader.Skip(10);
+            TS_ASSERT_EQUALS(6, reader.GetBitsLeft());
+            TS_ASSERT_EQUALS(0x3F0u, reader.Peek(10));
+
+            reader.Skip(6);
+            TS_ASSERT(!reader.IsGood());
+        }
+
+        void TestCanReadAlignedBytes()
+        {
+            std::vector<uint8_t> bytes(32);
+            for (size_t i = 0; i < bytes.size(); i++)
+            {
+                bytes[i] = static_cast<uint8_t>(i);
+            }
+
+            LsbInputBitReader reader(bytes.data(), bytes.size());
+
+            reader.Read(3);
+            reader.AlignToByte();
+
+            std::vector<uint8_t> copy(20);
+            TS_ASSERT_EQUALS(20u, reader.ReadBytes(copy.data(), copy.size()));
+
+            for (size_t i = 0; i < copy.size(); i++)
+            {
+                TS_ASSERT_EQUALS(bytes[i + 1], copy[i]);
+            }
+
+            TS_ASSERT_EQUALS(21u, reader.Read(8));
+            TS_ASSERT_EQUALS(80, reader.GetBitsLeft());
+        }
+
+        void TestCanDecodeHuffman()
+        {
+            auto decoder = HuffmanDecoder<int>
+            {
+                { "1", 1 },
+                { "01", 2 },
+                { "001", 3 },
+                { "000", 4 }
+            };
+
+            // 1 01 001 000 1 000 000 in both bit orders.
+            auto msbBits = std::vector<uint8_t> { 0xa4, 0x40 };
+            auto lsbBits = std::vector<uint8_t> { 0x25, 0x02 };
+
+            MsbInputBitReader msbReader(msbBits.data(), msbBits.size());
+            LsbInputBitReader lsbReader(lsbBits.data(), lsbBits.size());
+
+            for (auto expected : { 1, 2, 3, 4, 1, 4, 4 })
+            {
+                TS_ASSERT_EQUALS(expected, decoder.Next(msbReader));
+                TS_ASSERT_EQUALS(expected, decoder.Next(lsbReader));
+            }
+
+            TS_ASSERT(!msbReader);
+            TS_ASSERT(!lsbReader);
+        }
+    };
+} }
@@ -22,6 +22,11 @@
 
 #include <cxxtest/TestSuite.h>
 
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include <ccb/binary/HuffmanDecoder.hpp>
 #include <ccb/binary/InputBitStream.hpp>
 
 namespace ccb { namespace binary
@@ -94,5 +99,68 @@ namespace ccb { namespace binary
             TS_ASSERT(!bitstream.IsGood());
         }
 
+        void TestCanPeekAndSkip()
+        {
+            std::vector<uint8_t> bytes = { 0xAB, 0xCD, 0xEF };
+
+            auto bitstream = MakeInputBitStream(bytes.begin(), bytes.end());
+
+            TS_ASSERT_EQUALS(0xABCu, bitstream.Peek(12));
+
+            bitstream.Skip(4);
+            TS_ASSERT_EQUALS(0xBCDu, bitstream.Peek(12));
+
+            bitstream.Read();
+            TS_ASSERT_EQUALS(0x3CDu, bitstream.Peek(11));
+
+            bitstream.Skip(15);
+            TS_ASSERT(bitstream.HasBits(4));
+            TS_ASSERT(!bitstream.HasBits(5));
+            TS_ASSERT_EQUALS(0xF0u, bitstream.Peek(8));
+
+            bitstream.Skip(4);
+            TS_ASSERT(!bitstream.IsGood());
+            TS_ASSERT_EQUALS(0u, bitstream.Peek(8));
+        }
+
+        void TestCanPeekAcrossWideUnits()
+        {
+            std::vector<uint64_t> units = { 0x0123456789ABCDEFull, 0xFEDCBA9876543210ull };
+
+            auto bitstream = MakeInputBitStream(units.begin(), units.end());
+
+            TS_ASSERT_EQUALS(0x01234567u, bitstream.Peek(32));
+
+            bitstream.Skip(48);
+            TS_ASSERT_EQUALS(0xCDEFFEDCu, bitstream.Peek(32));
+
+            bitstream.Skip(15);
+            TS_ASSERT_EQUALS(0xFF6E5D4Cu, bitstream.Peek(32));
+
+            bitstream.Skip(60);
+            TS_ASSERT(bitstream.HasBits(5));
+            TS_ASSERT(!bitstream.HasBits(6));
+            TS_ASSERT_EQUALS(0x80000000u, bitstream.Peek(32));
+        }
+
+        void TestSinglePassStreamDecodesBitByBit()
+        {
+            std::istringstream stream("\xB4");
+            std::istream_iterator<char> begin(stream), end;
+
+            auto bitstream = MakeInputBitStream(begin, end);
+
+            TS_ASSERT(!details::HasPeek<decltype(bitstream)>::value);
+            TS_ASSERT((details::HasPeek<InputBitStream<uint8_t, std::vector<uint8_t>::iterator>>::value));
+
+            HuffmanDecoder<char> decoder({ { "1", 'a' }, { "01", 'b' }, { "00", 'c' } });
+
+            TS_ASSERT_EQUALS('a', decoder.Next(bitstream));
+            TS_ASSERT_EQUALS('b', decoder.Next(bitstream));
+            TS_ASSERT_EQUALS('a', decoder.Next(bitstream));
+            TS_ASSERT_EQUALS('b', decoder.Next(bitstream));
+            TS_ASSERT_EQUALS('c', decoder.Next(bitstream));
+        }
+
     };
 } }
@@ -0,0 +1,167 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <ccb/binary/OutputBinaryStream.hpp>
+#include <ccb/filesystem/TempPathGuard.hpp>
+
+namespace ccb { namespace binary
+{
+    class OutputBinaryStreamTests : public CxxTest::TestSuite
+    {
+    public:
+
+        void TestCanWriteWithByteOrder()
+        {
+            OutputBinaryStream stream;
+
+            stream.WriteBE<uint32_t>(0x12345678);
+            stream.WriteLE<uint16_t>(0xabcd);
+            stream.WriteBE(1.5f);
+            stream.WriteLE<int8_t>(-1);
+
+            TS_ASSERT_EQUALS("12345678cdab3fc00000ff", stream.GetHex());
+        }
+
+        void TestCanReleaseData()
+        {
+            OutputBinaryStream stream;
+            stream.Reserve(16);
+
+            stream.Write("abc", 3);
+            stream << static_cast<uint8_t>('d');
+
+            TS_ASSERT_EQUALS(4u, stream.GetSize());
+            TS_ASSERT_EQUALS(0, memcmp(stream.Data(), "abcd", 4));
+
+            auto data = stream.Release();
+
+            TS_ASSERT_EQUALS("abcd", std::string(data.begin(), data.end()));
+            TS_ASSERT_EQUALS(0u, stream.GetSize());
+        }
+
+        void TestFlushesChunksToSink()
+        {
+            std::ostringstream sink;
+
+            {
+                OutputBinaryStream stream(sink, 4);
+
+                stream.Write("ab", 2);
+                stream.WriteBE<uint16_t>(0x6364);
+                TS_ASSERT_EQUALS("", sink.str());
+
+                stream.Write("e", 1);
+                TS_ASSERT_EQUALS("abcd", sink.str());
+
+                stream.Write("fghijk", 6);
+                TS_ASSERT_EQUALS("abcdefghijk", sink.str());
+
+                stream.Write("l", 1);
+                TS_ASSERT_EQUALS(12u, stream.GetSize());
+                TS_ASSERT_THROWS(stream.Release(), std::logic_error);
+            }
+
+            TS_ASSERT_EQUALS("abcdefghijkl", sink.str());
+        }
+
+        void TestCanCopyAndAssign()
+        {
+            OutputBinaryStream stream;
+            stream.Write("ab", 2);
+
+            auto copy = stream;
+            copy.Write("c", 1);
+
+            TS_ASSERT_EQUALS("6162", stream.GetHex());
+            TS_ASSERT_EQUALS("616263", copy.GetHex());
+
+            std::ostringstream sink;
+
+            {
+                OutputBinaryStream sinkStream(sink, 16);
+                sinkStream.Write("xy", 2);
+
+                TS_ASSERT_THROWS(OutputBinaryStream { sinkStream }, std::logic_error);
+
+                // The pending bytes go to the sink before the stream is replaced.
+                sinkStream = std::move(copy);
+                TS_ASSERT_EQUALS("xy", sink.str());
+                TS_ASSERT_EQUALS("616263", sinkStream.GetHex());
+            }
+
+            TS_ASSERT_EQUALS("xy", sink.str());
+        }
+
+        void TestFailingSinkDoesNotThrowFromDestructor()
+        {
+            class FailingBuffer : public std::streambuf
+            {
+            protected:
+
+                int overflow(int) override
+                {
+                    return traits_type::eof();
+                }
+            };
+
+            FailingBuffer buffer;
+            std::ostream sink(&buffer);
+            sink.exceptions(std::ios::badbit | std::ios::failbit);
+
+            {
+                OutputBinaryStream stream(sink, 16);
+                stream.Write("abc", 3);
+
+                TS_ASSERT_THROWS_ANYTHING(stream.Flush());
+                stream.Write("d", 1);
+            }
+
+            TS_ASSERT(sink.bad());
+        }
+
+        void TestCanWriteToFile()
+        {
+            filesystem::TempPathGuard guard;
+
+            {
+                auto stream = OutputBinaryStream::ToFile(guard.GetPath(), 8);
+
+                for (int i = 0; i < 100; i++)
+                {
+                    stream.WriteLE<uint32_t>(i);
+                }
+            }
+
+            std::ifstream file(guard.GetPath().ToShortString(), std::ios::binary);
+            std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+            TS_ASSERT_EQUALS(400u, contents.size());
+            TS_ASSERT_EQUALS(99, contents[396]);
+        }
+    };
+} }
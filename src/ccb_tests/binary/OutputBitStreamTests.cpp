@@ -0,0 +1,128 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <ccb/binary/InputBitReader.hpp>
+#include <ccb/binary/OutputBitStream.hpp>
+
+namespace ccb { namespace binary
+{
+    class OutputBitStreamTests : public CxxTest::TestSuite
+    {
+    public:
+
+        void TestCanWriteMsbFirst()
+        {
+            MsbOutputBitStream stream;
+
+            stream.Write(0xA, 4);
+            stream << true << false;
+            stream.Write(0x3, 2);
+
+            TS_ASSERT_EQUALS(8u, stream.GetBitCount());
+
+            stream.Write(0x1, 3);
+
+            auto bytes = stream.GetBytes();
+
+            TS_ASSERT_EQUALS(2u, bytes.size());
+            TS_ASSERT_EQUALS(0xABu, bytes[0]);
+            TS_ASSERT_EQUALS(0x20u, bytes[1]);
+        }
+
+        void TestGetBytesKeepsWriting()
+        {
+            MsbOutputBitStream stream;
+
+            TS_ASSERT_EQUALS(0u, stream.GetBytes().size());
+
+            stream.Write(0x5, 3);
+            TS_ASSERT(stream.GetBytes() == std::vector<uint8_t>({ 0xA0 }));
+
+            for (unsigned i = 0; i < 20; i++)
+            {
+                stream.Write(0x1F, 5);
+            }
+
+            stream.Write(0x1F, 5);
+
+            auto bytes = stream.Release();
+
+            TS_ASSERT_EQUALS(14u, bytes.size());
+            TS_ASSERT_EQUALS(0xBFu, bytes[0]);
+            TS_ASSERT_EQUALS(0xFFu, bytes[12]);
+            TS_ASSERT_EQUALS(0xF0u, bytes[13]);
+        }
+
+        void TestCanWriteLsbFirst()
+        {
+            LsbOutputBitStream stream;
+
+            stream.Write(0xB, 4);
+            stream.Write(0xA, 4);
+            stream.Write(0x1, 3);
+            stream.AlignToByte();
+
+            uint8_t raw[] = { 0x12, 0x34 };
+            stream.WriteBytes(raw, sizeof(raw));
+
+            auto bytes = stream.Release();
+
+            TS_ASSERT_EQUALS(4u, bytes.size());
+            TS_ASSERT_EQUALS(0xABu, bytes[0]);
+            TS_ASSERT_EQUALS(0x01u, bytes[1]);
+            TS_ASSERT_EQUALS(0x12u, bytes[2]);
+            TS_ASSERT_EQUALS(0x34u, bytes[3]);
+        }
+
+        void TestRoundTrip()
+        {
+            MsbOutputBitStream msbStream;
+            LsbOutputBitStream lsbStream;
+
+            for (unsigned i = 0; i < 1000; i++)
+            {
+                auto length = 1 + (i * 7) % OutputBitStream<MsbFirst>::MAX_WRITE;
+                auto value = (0x9E3779B97F4A7C15ull * (i + 1)) >> (64 - length);
+
+                msbStream.Write(value, length);
+                lsbStream.Write(value, length);
+            }
+
+            auto msbBytes = msbStream.Release();
+            auto lsbBytes = lsbStream.Release();
+
+            MsbInputBitReader msbReader(msbBytes.data(), msbBytes.size());
+            LsbInputBitReader lsbReader(lsbBytes.data(), lsbBytes.size());
+
+            for (unsigned i = 0; i < 1000; i++)
+            {
+                auto length = 1 + (i * 7) % OutputBitStream<MsbFirst>::MAX_WRITE;
+                auto value = (0x9E3779B97F4A7C15ull * (i + 1)) >> (64 - length);
+
+                TS_ASSERT_EQUALS(value, msbReader.Read(length));
+                TS_ASSERT_EQUALS(value, lsbReader.Read(length));
+            }
+        }
+    };
+} }
@@ -0,0 +1,230 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <chrono>
+#include <iostream>
+
+#include <ccb/binary/InputBinaryStream.hpp>
+#include <ccb/binary/OutputBinaryStream.hpp>
+#include <ccb/binary/Varint.hpp>
+
+namespace ccb { namespace binary
+{
+    class VarintTests : public CxxTest::TestSuite
+    {
+    private:
+
+        // Mostly small values with occasional long ones, like a typical integer column.
+        static std::vector<uint64_t> GenerateValues(size_t count, uint64_t seed)
+        {
+            std::vector<uint64_t> values;
+
+            for (size_t i = 0; i < count; i++)
+            {
+                seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+
+                auto bits = (seed >> 60) < 12 ? 7 : static_cast<unsigned>((seed >> 33) % 64 + 1);
+                values.push_back((seed >> 3) & ((bits == 64) ? ~0ull : ((1ull << bits) - 1)));
+            }
+
+            return values;
+        }
+
+        static std::vector<uint8_t> Encode(const std::vector<uint64_t>& values)
+        {
+            std::vector<uint8_t> result;
+            uint8_t buffer[MAX_VARINT_SIZE];
+
+            for (auto value : values)
+            {
+                auto size = EncodeVarint(value, buffer);
+                result.insert(result.end(), buffer, buffer + size);
+            }
+
+            return result;
+        }
+
+    public:
+
+        void TestCanEncodeAndDecode()
+        {
+            const uint64_t values[] = { 0, 1, 127, 128, 300, 16383, 16384, 0xffffffffull, 1ull << 56, (1ull << 63) - 1, 1ull << 63, ~0ull };
+
+            for (auto value : values)
+            {
+                uint8_t buffer[MAX_VARINT_SIZE + 16] = { 0 };
+                auto size = EncodeVarint(value, buffer);
+
+                TS_ASSERT_EQUALS(GetVarintSize(value), size);
+
+                // Short buffer goes through the byte loop, long one through the word decoder.
+                uint64_t decoded = 0;
+                TS_ASSERT_EQUALS(buffer + size, DecodeVarint(buffer, buffer + size, decoded));
+                TS_ASSERT_EQUALS(value, decoded);
+
+                decoded = 0;
+                TS_ASSERT_EQUALS(buffer + size, DecodeVarint(buffer, buffer + sizeof(buffer), decoded));
+                TS_ASSERT_EQUALS(value, decoded);
+            }
+        }
+
+        void TestEncodingMatchesLeb128()
+        {
+            uint8_t buffer[MAX_VARINT_SIZE];
+
+            TS_ASSERT_EQUALS(2u, EncodeVarint(300, buffer));
+            TS_ASSERT_EQUALS(0xac, buffer[0]);
+            TS_ASSERT_EQUALS(0x02, buffer[1]);
+        }
+
+        void TestCanZigZag()
+        {
+            TS_ASSERT_EQUALS(0u, ZigZagEncode(0));
+            TS_ASSERT_EQUALS(1u, ZigZagEncode(-1));
+            TS_ASSERT_EQUALS(2u, ZigZagEncode(1));
+            TS_ASSERT_EQUALS(~0ull, ZigZagEncode(std::numeric_limits<int64_t>::min()));
+
+            const int64_t values[] = { 0, -1, 1, -64, 64, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max() };
+            for (auto value : values)
+            {
+                TS_ASSERT_EQUALS(value, ZigZagDecode(ZigZagEncode(value)));
+            }
+        }
+
+        void TestMalformedVarintsThrow()
+        {
+            const uint8_t truncated[] = { 0x80, 0x80 };
+            uint64_t value;
+
+            TS_ASSERT_THROWS(DecodeVarint(truncated, truncated + sizeof(truncated), value), std::runtime_error);
+
+            uint8_t tooLong[16] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x02 };
+
+            TS_ASSERT_THROWS(DecodeVarint(tooLong, tooLong + 10, value), std::runtime_error);
+            TS_ASSERT_THROWS(DecodeVarint(tooLong, tooLong + sizeof(tooLong), value), std::runtime_error);
+        }
+
+        void TestBulkDecodeMatchesSingle()
+        {
+            for (size_t count = 0; count < 100; count += 7)
+            {
+                for (uint64_t seed = 1; seed < 5; seed++)
+                {
+                    auto values = GenerateValues(count, seed);
+                    auto encoded = Encode(values);
+
+                    std::vector<uint64_t> decoded(count);
+                    auto end = DecodeVarints(encoded.data(), encoded.data() + encoded.size(), decoded.data(), count);
+
+                    TS_ASSERT_EQUALS(encoded.data() + encoded.size(), end);
+                    TS_ASSERT(values == decoded);
+                }
+            }
+        }
+
+        void TestBulkDecodeOfSmallValues()
+        {
+            std::vector<uint64_t> values;
+            for (size_t i = 0; i < 1000; i++)
+            {
+                values.push_back((i % 50 == 49) ? 100000 : i % 128);
+            }
+
+            auto encoded = Encode(values);
+
+            std::vector<uint32_t> decoded(values.size());
+            DecodeVarints(encoded.data(), encoded.data() + encoded.size(), decoded.data(), decoded.size());
+
+            TS_ASSERT(std::equal(values.begin(), values.end(), decoded.begin()));
+        }
+
+        void TestBulkDecodeChecksRange()
+        {
+            auto encoded = Encode(std::vector<uint64_t>(40, 0x100000000ull));
+            std::vector<uint32_t> decoded(40);
+
+            TS_ASSERT_THROWS(DecodeVarints(encoded.data(), encoded.data() + encoded.size(), decoded.data(), decoded.size()), std::runtime_error);
+        }
+
+        void TestCanUseWithStreams()
+        {
+            OutputBinaryStream output;
+
+            output.WriteVarint(300);
+            output.WriteSignedVarint(-2);
+            output.WriteString("hello");
+            output.WriteLE<uint32_t>(7);
+
+            for (uint32_t i = 0; i < 50; i++)
+            {
+                output.WriteVarint(i * 1000);
+            }
+
+            InputBinaryStream input(output.Release());
+
+            TS_ASSERT_EQUALS(300u, input.ReadVarint());
+            TS_ASSERT_EQUALS(-2, input.ReadSignedVarint());
+            TS_ASSERT_EQUALS("hello", input.ReadString());
+            TS_ASSERT_EQUALS(7u, input.ReadLE<uint32_t>());
+
+            std::vector<uint32_t> values(50);
+            input.ReadVarints(values.data(), values.size());
+
+            TS_ASSERT_EQUALS(49000u, values[49]);
+            TS_ASSERT(input.End());
+            TS_ASSERT_THROWS(input.ReadVarint(), std::runtime_error);
+        }
+
+        void TestTruncatedStringThrows()
+        {
+            auto input = InputBinaryStream::FromHex("0561626364");
+
+            TS_ASSERT_THROWS(input.ReadString(), std::out_of_range);
+        }
+
+        void TestVarintPerformance()
+        {
+            auto values = GenerateValues(10000000, 42);
+            auto encoded = Encode(values);
+            std::vector<uint64_t> decoded(values.size());
+
+            auto t1 = std::chrono::system_clock::now();
+            DecodeVarints(encoded.data(), encoded.data() + encoded.size(), decoded.data(), decoded.size());
+            auto t2 = std::chrono::system_clock::now();
+
+            const uint8_t* pos = encoded.data();
+            for (auto& value : decoded)
+            {
+                pos = DecodeVarint(pos, encoded.data() + encoded.size(), value);
+            }
+            auto t3 = std::chrono::system_clock::now();
+
+            TS_ASSERT(values == decoded);
+
+            std::cout << std::endl << "Varints: " << values.size() << " decoded in bulk in "
+                << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " micros, one by one in "
+                << std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count() << " micros" << std::endl;
+        }
+    };
+} }
@@ -0,0 +1,212 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <sstream>
+
+#include <ccb/compress/InflateStream.hpp>
+#include <ccb/compress/Inflater.hpp>
+
+namespace ccb { namespace compress
+{
+    class InflaterTests : public CxxTest::TestSuite
+    {
+    private:
+
+        static std::string ToString(const std::vector<uint8_t>& data)
+        {
+            return std::string(data.begin(), data.end());
+        }
+
+        // Same generator the dynamic block test vector was produced from.
+        static std::string Generate(size_t size)
+        {
+            static const char letters[] = "aaaaaaaabbbbccde";
+
+            std::string result;
+            uint32_t x = 1;
+
+            for (size_t i = 0; i < size; i++)
+            {
+                x = (x * 1103515245 + 12345) & 0x7fffffff;
+                result += letters[(x >> 16) % 16];
+            }
+
+            return result;
+        }
+
+    public:
+
+        void TestCanInflateStoredBlock()
+        {
+            const uint8_t data[] =
+            {
+                0x01, 0x1a, 0x00, 0xe5, 0xff, 0x68, 0x65, 0x6c, 0x6c, 0x6f, 0x2c, 0x20, 0x68, 0x65, 0x6c, 0x6c,
+                0x6f, 0x2c, 0x20, 0x68, 0x65, 0x6c, 0x6c, 0x6f, 0x2c, 0x20, 0x77, 0x6f, 0x72, 0x6c, 0x64
+            };
+
+            TS_ASSERT_EQUALS("hello, hello, hello, world", ToString(Inflater::Inflate(data, sizeof(data), InflateFormat::Raw)));
+        }
+
+        void TestCanInflateFixedBlock()
+        {
+            const uint8_t data[] =
+            {
+                0xcb, 0x48, 0xcd, 0xc9, 0xc9, 0xd7, 0x51, 0xc8, 0x40, 0xa1, 0xca, 0xf3, 0x8b, 0x72, 0x52, 0x00
+            };
+
+            TS_ASSERT_EQUALS("hello, hello, hello, world", ToString(Inflater::Inflate(data, sizeof(data), InflateFormat::Raw)));
+        }
+
+        void TestCanInflateDynamicBlock()
+        {
+            const uint8_t data[] =
+            {
+                0x35, 0x8c, 0xc1, 0x0d, 0x00, 0x30, 0x08, 0x02, 0x67, 0xe5, 0x80, 0xfd, 0x57, 0xa8, 0xb6, 0x29,
+                0x0f, 0x43, 0x38, 0x50, 0x11, 0x20, 0x24, 0xd7, 0x96, 0x54, 0x65, 0xcf, 0x68, 0x72, 0x0f, 0x5a,
+                0x26, 0xfc, 0xc8, 0x56, 0xc7, 0xa3, 0x14, 0xda, 0x1b, 0xd9, 0x64, 0x4b, 0x31, 0xce, 0x5b, 0xf6,
+                0x8f, 0xe6, 0x01, 0x1c
+            };
+
+            TS_ASSERT_EQUALS(Generate(100), ToString(Inflater::Inflate(data, sizeof(data), InflateFormat::Raw)));
+        }
+
+        void TestCanInflateZlib()
+        {
+            const uint8_t data[] =
+            {
+                0x78, 0x9c, 0xcb, 0x48, 0xcd, 0xc9, 0xc9, 0xd7, 0x51, 0xc8, 0x40, 0xa1, 0xca, 0xf3, 0x8b, 0x72,
+                0x52, 0x00, 0x7c, 0x90, 0x09, 0x49
+            };
+
+            TS_ASSERT_EQUALS("hello, hello, hello, world", ToString(Inflater::Inflate(data, sizeof(data), InflateFormat::Zlib)));
+            TS_ASSERT_EQUALS("hello, hello, hello, world", ToString(Inflater::Inflate(data, sizeof(data))));
+        }
+
+        void TestCanInflateGzip()
+        {
+            const uint8_t data[] =
+            {
+                0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xcb, 0x48, 0xcd, 0xc9, 0xc9, 0xd7,
+                0x51, 0xc8, 0x40, 0xa1, 0xca, 0xf3, 0x8b, 0x72, 0x52, 0x00, 0x90, 0x14, 0xe5, 0x7b, 0x1a, 0x00,
+                0x00, 0x00
+            };
+
+            TS_ASSERT_EQUALS("hello, hello, hello, world", ToString(Inflater::Inflate(data, sizeof(data), InflateFormat::Gzip)));
+            TS_ASSERT_EQUALS("hello, hello, hello, world", ToString(Inflater::Inflate(data, sizeof(data))));
+        }
+
+        void TestCanInflateConcatenatedGzipMembers()
+        {
+            // First member carries a file name.
+            const uint8_t data[] =
+            {
+                0x1f, 0x8b, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x02, 0xff, 0x61, 0x2e, 0x74, 0x78, 0x74, 0x00,
+                0x4b, 0x4c, 0x4a, 0x06, 0x00, 0xc2, 0x41, 0x24, 0x35, 0x03, 0x00, 0x00, 0x00,
+                0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x4b, 0x49, 0x4d, 0x03, 0x00, 0x61,
+                0xe1, 0xc4, 0x0c, 0x03, 0x00, 0x00, 0x00
+            };
+
+            TS_ASSERT_EQUALS("abcdef", ToString(Inflater::Inflate(data, sizeof(data))));
+        }
+
+        void TestChecksumMismatchThrows()
+        {
+            uint8_t data[] =
+            {
+                0x78, 0x9c, 0xcb, 0x48, 0xcd, 0xc9, 0xc9, 0xd7, 0x51, 0xc8, 0x40, 0xa1, 0xca, 0xf3, 0x8b, 0x72,
+                0x52, 0x00, 0x7c, 0x90, 0x09, 0x48
+            };
+
+            TS_ASSERT_THROWS(Inflater::Inflate(data, sizeof(data)), std::runtime_error);
+        }
+
+        void TestTruncatedInputThrows()
+        {
+            const uint8_t data[] =
+            {
+                0xcb, 0x48, 0xcd, 0xc9, 0xc9, 0xd7, 0x51, 0xc8
+            };
+
+            TS_ASSERT_THROWS(Inflater::Inflate(data, sizeof(data), InflateFormat::Raw), std::runtime_error);
+        }
+
+        void TestCorruptDynamicHeaderThrows()
+        {
+            // Dynamic block header with four code length codes of one bit each.
+            const uint8_t data[] =
+            {
+                0x05, 0x00, 0x92, 0x04
+            };
+
+            TS_ASSERT_THROWS(Inflater::Inflate(data, sizeof(data), InflateFormat::Raw), std::runtime_error);
+        }
+
+        void TestCanReadFromStream()
+        {
+            const uint8_t data[] =
+            {
+                0x78, 0x9c, 0xcb, 0x48, 0xcd, 0xc9, 0xc9, 0xd7, 0x51, 0xc8, 0x40, 0xa1, 0xca, 0xf3, 0x8b, 0x72,
+                0x52, 0x00, 0x7c, 0x90, 0x09, 0x49
+            };
+
+            std::istringstream source(std::string(reinterpret_cast<const char*>(data), sizeof(data)));
+            InflateIStream stream(source);
+
+            std::string word;
+            stream >> word;
+            TS_ASSERT_EQUALS("hello,", word);
+
+            std::string rest;
+            std::getline(stream, rest);
+            TS_ASSERT_EQUALS(" hello, hello, world", rest);
+
+            TS_ASSERT(stream.eof());
+        }
+
+        void TestCanReadInSmallPieces()
+        {
+            const uint8_t data[] =
+            {
+                0x35, 0x8c, 0xc1, 0x0d, 0x00, 0x30, 0x08, 0x02, 0x67, 0xe5, 0x80, 0xfd, 0x57, 0xa8, 0xb6, 0x29,
+                0x0f, 0x43, 0x38, 0x50, 0x11, 0x20, 0x24, 0xd7, 0x96, 0x54, 0x65, 0xcf, 0x68, 0x72, 0x0f, 0x5a,
+                0x26, 0xfc, 0xc8, 0x56, 0xc7, 0xa3, 0x14, 0xda, 0x1b, 0xd9, 0x64, 0x4b, 0x31, 0xce, 0x5b, 0xf6,
+                0x8f, 0xe6, 0x01, 0x1c
+            };
+
+            Inflater inflater(data, sizeof(data), InflateFormat::Raw);
+
+            std::string result;
+            char buffer[7];
+            size_t count;
+
+            while ((count = inflater.Read(buffer, sizeof(buffer))) > 0)
+            {
+                result.append(buffer, count);
+            }
+
+            TS_ASSERT(inflater.IsFinished());
+            TS_ASSERT_EQUALS(Generate(100), result);
+        }
+    };
+} }
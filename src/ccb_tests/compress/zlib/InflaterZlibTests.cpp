@@ -0,0 +1,168 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+#include <zlib.h>
+
+#include <ccb/compress/InflateStream.hpp>
+#include <ccb/compress/Inflater.hpp>
+
+namespace ccb { namespace compress
+{
+    class InflaterZlibTests : public CxxTest::TestSuite
+    {
+    private:
+
+        // Text-like data with plenty of long and short matches.
+        static std::vector<uint8_t> Generate(size_t size)
+        {
+            static const char* words[] =
+            {
+                "lorem ", "ipsum ", "dolor ", "sit ", "amet, ", "a", "b", "\n", "consectetur ", "0123456789"
+            };
+
+            std::vector<uint8_t> result;
+            uint32_t x = 1;
+
+            while (result.size() < size)
+            {
+                x = (x * 1103515245 + 12345) & 0x7fffffff;
+
+                auto word = words[(x >> 16) % 10];
+                result.insert(result.end(), word, word + strlen(word));
+
+                if ((x & 0x300) == 0)
+                {
+                    result.push_back(static_cast<uint8_t>(x >> 20));
+                }
+            }
+
+            result.resize(size);
+            return result;
+        }
+
+        static std::vector<uint8_t> Compress(const std::vector<uint8_t>& data, int level, int windowBits)
+        {
+            z_stream stream;
+            memset(&stream, 0, sizeof(stream));
+
+            deflateInit2(&stream, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
+
+            std::vector<uint8_t> result(deflateBound(&stream, static_cast<uLong>(data.size())) + 32);
+
+            stream.next_in = const_cast<Bytef*>(data.data());
+            stream.avail_in = static_cast<uInt>(data.size());
+            stream.next_out = result.data();
+            stream.avail_out = static_cast<uInt>(result.size());
+
+            deflate(&stream, Z_FINISH);
+
+            result.resize(stream.total_out);
+            deflateEnd(&stream);
+
+            return result;
+        }
+
+        static std::vector<uint8_t> Uncompress(const std::vector<uint8_t>& data, size_t size)
+        {
+            std::vector<uint8_t> result(size);
+            auto length = static_cast<uLongf>(size);
+
+            uncompress(result.data(), &length, data.data(), static_cast<uLong>(data.size()));
+
+            result.resize(length);
+            return result;
+        }
+
+    public:
+
+        void TestMatchesZlibOnAllLevels()
+        {
+            auto data = Generate(300000);
+
+            for (int level = 0; level <= 9; level++)
+            {
+                TS_ASSERT(data == Inflater::Inflate(Compress(data, level, -15), InflateFormat::Raw));
+                TS_ASSERT(data == Inflater::Inflate(Compress(data, level, 15)));
+                TS_ASSERT(data == Inflater::Inflate(Compress(data, level, 15 + 16)));
+            }
+        }
+
+        void TestMatchesZlibOnSmallWindows()
+        {
+            auto data = Generate(100000);
+
+            for (int windowBits = 9; windowBits <= 15; windowBits++)
+            {
+                TS_ASSERT(data == Inflater::Inflate(Compress(data, 9, windowBits)));
+            }
+        }
+
+        void TestCanInflateFromStream()
+        {
+            auto data = Generate(1000000);
+            auto compressed = Compress(data, 6, 15 + 16);
+
+            std::istringstream source(std::string(compressed.begin(), compressed.end()));
+            InflateIStream stream(source);
+
+            std::vector<uint8_t> result(data.size() + 1);
+            stream.read(reinterpret_cast<char*>(result.data()), static_cast<std::streamsize>(result.size()));
+
+            TS_ASSERT_EQUALS(data.size(), static_cast<size_t>(stream.gcount()));
+
+            result.resize(static_cast<size_t>(stream.gcount()));
+            TS_ASSERT(data == result);
+        }
+
+        void TestInflatePerformance()
+        {
+            auto data = Generate(16 * 1024 * 1024);
+            auto compressed = Compress(data, 6, 15);
+
+            int64_t ownTotal = 0;
+            int64_t zlibTotal = 0;
+
+            for (int i = 0; i < 5; i++)
+            {
+                auto t1 = std::chrono::system_clock::now();
+                auto own = Inflater::Inflate(compressed);
+                auto t2 = std::chrono::system_clock::now();
+                auto reference = Uncompress(compressed, data.size());
+                auto t3 = std::chrono::system_clock::now();
+
+                TS_ASSERT(own == reference);
+
+                ownTotal += std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+                zlibTotal += std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count();
+            }
+
+            std::cout << std::endl << "Inflate of " << data.size() << " bytes average on " << static_cast<double>(ownTotal) / 5
+                << " micros, zlib on " << static_cast<double>(zlibTotal) / 5 << " micros" << std::endl;
+        }
+    };
+} }
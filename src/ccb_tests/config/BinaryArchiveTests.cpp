@@ -0,0 +1,284 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <ccb/config/BinaryInputArchive.hpp>
+#include <ccb/config/BinaryOutputArchive.hpp>
+#include <ccb_tests/config/TestConfig.hpp>
+#include <ccb_tests/config/TestDefaultConfig.hpp>
+#include <ccb_tests/config/TestProxyConfig.hpp>
+
+namespace ccb { namespace config
+{
+    class BinaryArchiveTests : public CxxTest::TestSuite
+    {
+    public:
+
+        void TestBoolSerialization()
+        {
+            TestConfig<bool> config1(true);
+
+            BinaryOutputArchive output;
+            output.Serialize(config1, L"config");
+
+            auto data = output.GetStream().Release();
+
+            TestConfig<bool> config2(false);
+
+            BinaryInputArchive input(data.data(), data.size());
+            input.Serialize(config2, L"config");
+
+            TS_ASSERT_EQUALS(config1.GetValue(), config2.GetValue());
+        }
+
+        void TestIntSerialization()
+        {
+            TestConfig<int8_t> config8i1(-13);
+            TestConfig<int16_t> config16i1(14);
+            TestConfig<int32_t> config32i1(-15);
+            TestConfig<int64_t> config64i1(std::numeric_limits<int64_t>::min());
+            TestConfig<uint8_t> config8u1(255);
+            TestConfig<uint16_t> config16u1(18);
+            TestConfig<uint32_t> config32u1(19);
+            TestConfig<uint64_t> config64u1(std::numeric_limits<uint64_t>::max());
+
+            BinaryOutputArchive output;
+
+            output.Serialize(config8i1, L"config8i");
+            output.Serialize(config16i1, L"config16i");
+            output.Serialize(config32i1, L"config32i");
+            output.Serialize(config64i1, L"config64i");
+            output.Serialize(config8u1, L"config8u");
+            output.Serialize(config16u1, L"config16u");
+            output.Serialize(config32u1, L"config32u");
+            output.Serialize(config64u1, L"config64u");
+
+            binary::InputBinaryStream stream(output.GetStream().Release());
+
+            TestConfig<int8_t> config8i2;
+            TestConfig<int16_t> config16i2;
+            TestConfig<int32_t> config32i2;
+            TestConfig<int64_t> config64i2;
+            TestConfig<uint8_t> config8u2;
+            TestConfig<uint16_t> config16u2;
+            TestConfig<uint32_t> config32u2;
+            TestConfig<uint64_t> config64u2;
+
+            BinaryInputArchive input(stream);
+
+            input.Serialize(config8i2, L"config8i");
+            input.Serialize(config16i2, L"config16i");
+            input.Serialize(config32i2, L"config32i");
+            input.Serialize(config64i2, L"config64i");
+            input.Serialize(config8u2, L"config8u");
+            input.Serialize(config16u2, L"config16u");
+            input.Serialize(config32u2, L"config32u");
+            input.Serialize(config64u2, L"config64u");
+
+            TS_ASSERT_EQUALS(config8i1.GetValue(), config8i2.GetValue());
+            TS_ASSERT_EQUALS(config16i1.GetValue(), config16i2.GetValue());
+            TS_ASSERT_EQUALS(config32i1.GetValue(), config32i2.GetValue());
+            TS_ASSERT_EQUALS(config64i1.GetValue(), config64i2.GetValue());
+            TS_ASSERT_EQUALS(config8u1.GetValue(), config8u2.GetValue());
+            TS_ASSERT_EQUALS(config16u1.GetValue(), config16u2.GetValue());
+            TS_ASSERT_EQUALS(config32u1.GetValue(), config32u2.GetValue());
+            TS_ASSERT_EQUALS(config64u1.GetValue(), config64u2.GetValue());
+        }
+
+        void TestFloatSerialization()
+        {
+            TestConfig<float> configF1(1.25f);
+            TestConfig<double> configD1(-3.5e100);
+
+            BinaryOutputArchive output;
+            output.Serialize(configF1, L"configf");
+            output.Serialize(configD1, L"configd");
+
+            auto data = output.GetStream().Release();
+
+            TestConfig<float> configF2;
+            TestConfig<double> configD2;
+
+            BinaryInputArchive input(data.data(), data.size());
+            input.Serialize(configF2, L"configf");
+            input.Serialize(configD2, L"configd");
+
+            TS_ASSERT_EQUALS(configF1.GetValue(), configF2.GetValue());
+            TS_ASSERT_EQUALS(configD1.GetValue(), configD2.GetValue());
+        }
+
+        void TestStringSerialization()
+        {
+            TestConfig<std::string> config1("hello");
+            TestConfig<std::wstring> configW1(L"whéllo");
+
+            BinaryOutputArchive output;
+            output.Serialize(config1, L"config");
+            output.Serialize(configW1, L"configw");
+
+            auto data = output.GetStream().Release();
+
+            TestConfig<std::string> config2;
+            TestConfig<std::wstring> configW2;
+            TestConfig<std::wstring> configW3;
+
+            BinaryInputArchive input(data.data(), data.size());
+            input.Serialize(config2, L"config");
+            input.Serialize(configW2, L"configw");
+            input.Serialize(configW3, L"config");
+
+            TS_ASSERT_EQUALS(config1.GetValue(), config2.GetValue());
+            TS_ASSERT_EQUALS(configW1.GetValue(), configW2.GetValue());
+            TS_ASSERT_EQUALS(L"hello", configW3.GetValue());
+        }
+
+        void TestSubclassSerialization()
+        {
+            TestConfig<TestConfig<int>> config1(TestConfig<int>(13));
+
+            BinaryOutputArchive output;
+            output.Serialize(config1, L"config");
+
+            auto data = output.GetStream().Release();
+
+            TestConfig<TestConfig<int>> config2;
+
+            BinaryInputArchive input(data.data(), data.size());
+            input.Serialize(config2, L"config");
+
+            TS_ASSERT_EQUALS(config1.GetValue().GetValue(), config2.GetValue().GetValue());
+        }
+
+        void TestCanReadInAnyOrder()
+        {
+            TestConfig<int> a(1);
+            TestConfig<std::string> b("two");
+            TestConfig<TestConfig<int>> c(TestConfig<int>(3));
+
+            BinaryOutputArchive output;
+            output.Serialize(a, L"a");
+            output.Serialize(b, L"b");
+            output.Serialize(c, L"c");
+
+            auto data = output.GetStream().Release();
+
+            TestConfig<int> a2;
+            TestConfig<std::string> b2;
+            TestConfig<TestConfig<int>> c2;
+
+            BinaryInputArchive input(data.data(), data.size());
+            input.Serialize(c2, L"c");
+            input.Serialize(a2, L"a");
+            input.Serialize(b2, L"b");
+
+            TS_ASSERT_EQUALS(1, a2.GetValue());
+            TS_ASSERT_EQUALS("two", b2.GetValue());
+            TS_ASSERT_EQUALS(3, c2.GetValue().GetValue());
+        }
+
+        void TestRepeatedTagThrows()
+        {
+            TestConfig<int> a(1);
+            TestConfig<int> b(2);
+
+            BinaryOutputArchive duplicate;
+            duplicate.Serialize(a, L"a");
+            TS_ASSERT_THROWS(duplicate.Serialize(b, L"a"), std::logic_error);
+
+            // Both names hash to the same tag.
+            BinaryOutputArchive collision;
+            collision.Serialize(a, L"glbvs");
+            TS_ASSERT_THROWS(collision.Serialize(b, L"yacxa"), std::logic_error);
+
+            // Tags only need to be unique within a map.
+            TestConfig<TestConfig<int>> c(TestConfig<int>(3));
+            BinaryOutputArchive nested;
+            nested.Serialize(c, L"value");
+            nested.Serialize(a, L"c");
+        }
+
+        void TestBoolDefaultSerialization()
+        {
+            // Empty nested object.
+            binary::OutputBinaryStream stream;
+            stream.WriteLE(details::BinaryFieldTag(L"config"));
+            stream.WriteLE(static_cast<uint8_t>(BinaryFieldType::Map));
+            stream.WriteVarint(0);
+
+            auto data = stream.Release();
+
+            TestDefaultConfig<bool> config(true);
+
+            BinaryInputArchive input(data.data(), data.size());
+            input.Serialize(config, L"config");
+
+            TS_ASSERT_EQUALS(true, config.GetValue());
+        }
+
+        void TestMissingFieldThrows()
+        {
+            BinaryInputArchive input(nullptr, 0);
+            TestConfig<int> config;
+
+            TS_ASSERT_THROWS(input.Serialize(config, L"config"), std::runtime_error);
+        }
+
+        void TestOutOfRangeValueThrows()
+        {
+            TestConfig<int32_t> config1(300);
+
+            BinaryOutputArchive output;
+            output.Serialize(config1, L"config");
+
+            auto data = output.GetStream().Release();
+
+            TestConfig<uint8_t> config2;
+
+            BinaryInputArchive input(data.data(), data.size());
+
+            TS_ASSERT_THROWS(input.Serialize(config2, L"config"), std::runtime_error);
+        }
+
+        void TestProxySerialization()
+        {
+            TestProxyConfig<bool, std::string> config1(
+                [](const std::string& v) { return v == "yes"; },
+                [](bool v) { return v ? std::string("yes") : std::string("no"); },
+                true);
+
+            BinaryOutputArchive output;
+            output.Serialize(config1, L"config");
+
+            auto data = output.GetStream().Release();
+
+            TestProxyConfig<bool, std::string> config2(
+                [](const std::string& v) { return v == "yes"; },
+                [](bool v) { return v ? std::string("yes") : std::string("no"); });
+
+            BinaryInputArchive input(data.data(), data.size());
+            input.Serialize(config2, L"config");
+
+            TS_ASSERT_EQUALS(config1.GetValue(), config2.GetValue());
+        }
+    };
+} }
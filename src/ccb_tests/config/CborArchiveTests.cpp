@@ -0,0 +1,90 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <fstream>
+
+#include <ccb/config/CborInputArchive.hpp>
+#include <ccb/config/TreeOutputArchive.hpp>
+#include <ccb/filesystem/FileSystem.hpp>
+#include <ccb_tests/config/TestConfig.hpp>
+
+namespace ccb { namespace config
+{
+    class CborArchiveTests : public CxxTest::TestSuite
+    {
+    public:
+
+        void TestValueSerialization()
+        {
+            filesystem::FileSystem filesystem;
+            auto tempFile = filesystem.GetTempPath() / filesystem.UniquePath();
+
+            TestConfig<bool> configBool1(true);
+            TestConfig<int8_t> configInt81(-13);
+            TestConfig<uint64_t> configUInt641(std::numeric_limits<uint64_t>::max());
+            TestConfig<double> configDouble1(0.1);
+            TestConfig<std::wstring> configString1(L"value");
+            TestConfig<TestConfig<int>> configSub1(TestConfig<int>(13));
+
+            {
+                TreeOutputArchive output;
+                output.Serialize(configBool1, L"bool");
+                output.Serialize(configInt81, L"int8");
+                output.Serialize(configUInt641, L"uint64");
+                output.Serialize(configDouble1, L"double");
+                output.Serialize(configString1, L"string");
+                output.Serialize(configSub1, L"sub");
+
+                std::ofstream stream(tempFile.ToShortString(), std::ios::binary);
+                CborTreeSerializer().Serialize(output.GetTree(), stream);
+            }
+
+            TestConfig<bool> configBool2(false);
+            TestConfig<int8_t> configInt82;
+            TestConfig<uint64_t> configUInt642;
+            TestConfig<double> configDouble2;
+            TestConfig<std::wstring> configString2;
+            TestConfig<TestConfig<int>> configSub2;
+
+            {
+                CborInputArchive input(tempFile.ToShortString());
+                input.Serialize(configBool2, L"bool");
+                input.Serialize(configInt82, L"int8");
+                input.Serialize(configUInt642, L"uint64");
+                input.Serialize(configDouble2, L"double");
+                input.Serialize(configString2, L"string");
+                input.Serialize(configSub2, L"sub");
+            }
+
+            TS_ASSERT_EQUALS(configBool1.GetValue(), configBool2.GetValue());
+            TS_ASSERT_EQUALS(configInt81.GetValue(), configInt82.GetValue());
+            TS_ASSERT_EQUALS(configUInt641.GetValue(), configUInt642.GetValue());
+            TS_ASSERT_EQUALS(configDouble1.GetValue(), configDouble2.GetValue());
+            TS_ASSERT(configString1.GetValue() == configString2.GetValue());
+            TS_ASSERT_EQUALS(configSub1.GetValue().GetValue(), configSub2.GetValue().GetValue());
+
+            filesystem.Remove(tempFile);
+        }
+    };
+} }
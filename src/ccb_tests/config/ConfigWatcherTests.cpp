@@ -0,0 +1,172 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <fstream>
+
+#include <ccb/config/ConfigWatcher.hpp>
+#include <ccb/filesystem/FileSystem.hpp>
+#include <ccb_tests/config/TestConfig.hpp>
+
+namespace ccb { namespace config
+{
+    class ConfigWatcherTests : public CxxTest::TestSuite
+    {
+    private:
+
+        static void Write(const filesystem::Path& path, const std::string& text)
+        {
+            std::ofstream stream(path.ToShortString(), std::ios::binary);
+            stream << text;
+        }
+
+    public:
+
+        void TestReload()
+        {
+            filesystem::FileSystem filesystem;
+            auto tempFile = filesystem.GetTempPath() / filesystem.UniquePath();
+
+            Write(tempFile, "{ \"a\": { \"value\": 1 }, \"b\": { \"value\": { \"value\": 2 } } }");
+
+            ConfigWatcher watcher(tempFile);
+
+            TestConfig<int> a;
+            TestConfig<TestConfig<int>> b;
+            int aCalls = 0;
+            int bCalls = 0;
+            std::vector<tree::TreeChange> rootChanges;
+
+            watcher.Bind(L"/a", a, [&aCalls] (const std::vector<tree::TreeChange>&) { aCalls++; });
+            watcher.Bind(L"/b", b, [&bCalls] (const std::vector<tree::TreeChange>&) { bCalls++; });
+            watcher.Subscribe(L"", [&rootChanges] (const std::vector<tree::TreeChange>& changes) { rootChanges = changes; });
+
+            TS_ASSERT_EQUALS(1, a.GetValue());
+            TS_ASSERT_EQUALS(2, b.GetValue().GetValue());
+            TS_ASSERT(!watcher.Poll());
+
+            Write(tempFile, "{ \"a\": { \"value\": 1 }, \"b\": { \"value\": { \"value\": 30 } } }");
+
+            TS_ASSERT(watcher.Poll());
+            TS_ASSERT_EQUALS(0, aCalls);
+            TS_ASSERT_EQUALS(1, bCalls);
+            TS_ASSERT_EQUALS(30, b.GetValue().GetValue());
+            TS_ASSERT_EQUALS(1u, rootChanges.size());
+            TS_ASSERT(rootChanges[0].path == L"/b/value/value");
+            TS_ASSERT(!watcher.Poll());
+
+            // Same tree in other text: hashed and parsed, but nothing to update.
+            Write(tempFile, "{\"b\": {\"value\": {\"value\": 30}}, \"a\": {\"value\": 1}}");
+
+            TS_ASSERT(!watcher.Poll());
+            TS_ASSERT_EQUALS(0, aCalls);
+            TS_ASSERT_EQUALS(1, bCalls);
+
+            // A broken file keeps the previous tree.
+            Write(tempFile, "{\"b\": ");
+
+            TS_ASSERT_THROWS(watcher.Poll(), std::runtime_error);
+            TS_ASSERT_EQUALS(30, b.GetValue().GetValue());
+
+            Write(tempFile, "{ \"a\": { \"value\": 5 }, \"b\": { \"value\": { \"value\": 30 } } }");
+
+            TS_ASSERT(watcher.Poll());
+            TS_ASSERT_EQUALS(1, aCalls);
+            TS_ASSERT_EQUALS(1, bCalls);
+            TS_ASSERT_EQUALS(5, a.GetValue());
+
+            filesystem.Remove(tempFile);
+        }
+
+        void TestReplacedFile()
+        {
+            filesystem::FileSystem filesystem;
+            auto tempFile = filesystem.GetTempPath() / filesystem.UniquePath();
+            auto otherFile = filesystem::Path(tempFile.ToString() + L".new");
+
+            Write(tempFile, "{ \"a\": { \"value\": 1 } }");
+
+            ConfigWatcher watcher(tempFile);
+
+            TestConfig<int> a;
+            watcher.Bind(L"/a", a);
+
+            Write(otherFile, "{ \"a\": { \"value\": 2 } }");
+            filesystem.Rename(otherFile, tempFile);
+
+            TS_ASSERT(watcher.Poll());
+            TS_ASSERT_EQUALS(2, a.GetValue());
+
+            filesystem.Remove(tempFile);
+        }
+
+        void TestFailingBinding()
+        {
+            filesystem::FileSystem filesystem;
+            auto tempFile = filesystem.GetTempPath() / filesystem.UniquePath();
+
+            Write(tempFile, "{ \"a\": { \"value\": 1 }, \"b\": { \"value\": { \"value\": 2 } } }");
+
+            ConfigWatcher watcher(tempFile);
+
+            TestConfig<TestConfig<int>> b;
+            TestConfig<int> a;
+            int bCalls = 0;
+            int aCalls = 0;
+
+            watcher.Bind(L"/b", b, [&bCalls] (const std::vector<tree::TreeChange>&) { bCalls++; });
+            watcher.Subscribe(L"/a", [] (const std::vector<tree::TreeChange>&) { throw std::logic_error("Callback failed"); });
+            watcher.Bind(L"/a", a, [&aCalls] (const std::vector<tree::TreeChange>&) { aCalls++; });
+
+            // The first binding can't read a value as a map, the second one throws from its callback.
+            Write(tempFile, "{ \"a\": { \"value\": 5 }, \"b\": { \"value\": 3 } }");
+
+            TS_ASSERT_THROWS(watcher.Poll(), std::runtime_error);
+            TS_ASSERT_EQUALS(0, bCalls);
+            TS_ASSERT_EQUALS(1, aCalls);
+            TS_ASSERT_EQUALS(5, a.GetValue());
+            TS_ASSERT(!watcher.Poll());
+
+            filesystem.Remove(tempFile);
+        }
+
+        void TestErrors()
+        {
+            filesystem::FileSystem filesystem;
+            auto tempFile = filesystem.GetTempPath() / filesystem.UniquePath();
+
+            TS_ASSERT_THROWS(ConfigWatcher watcher(tempFile), std::runtime_error);
+
+            Write(tempFile, "{ \"a\": 1 }");
+
+            ConfigWatcher watcher(tempFile);
+            TestConfig<int> a;
+
+            TS_ASSERT_THROWS(watcher.Bind(L"/b", a), std::runtime_error);
+            TS_ASSERT_THROWS(watcher.Bind(L"/a", a), std::runtime_error);
+            TS_ASSERT_THROWS(watcher.Bind(L"/*", a), std::invalid_argument);
+
+            filesystem.Remove(tempFile);
+        }
+    };
+} }
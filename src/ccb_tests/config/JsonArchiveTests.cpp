@@ -120,6 +120,37 @@ namespace ccb { namespace config
             filesystem.Remove(tempFile);
         }
 
+        void TestDoubleSerialization()
+        {
+            filesystem::FileSystem filesystem;
+            auto tempFile = filesystem.GetTempPath() / filesystem.UniquePath();
+
+            TestConfig<double> configDouble1(1.0 / 3);
+            TestConfig<float> configFloat1(0.1f);
+
+            {
+                JsonOutputArchive ar(tempFile.ToShortString());
+
+                ar.Serialize(configDouble1, L"configDouble");
+                ar.Serialize(configFloat1, L"configFloat");
+            }
+
+            TestConfig<double> configDouble2;
+            TestConfig<float> configFloat2;
+
+            {
+                JsonInputArchive ar(tempFile.ToShortString());
+
+                ar.Serialize(configDouble2, L"configDouble");
+                ar.Serialize(configFloat2, L"configFloat");
+            }
+
+            TS_ASSERT_EQUALS(configDouble1.GetValue(), configDouble2.GetValue());
+            TS_ASSERT_EQUALS(configFloat1.GetValue(), configFloat2.GetValue());
+
+            filesystem.Remove(tempFile);
+        }
+
         void TestStringSerialization()
         {
             filesystem::FileSystem filesystem;
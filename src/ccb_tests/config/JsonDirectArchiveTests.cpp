@@ -0,0 +1,356 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <chrono>
+#include <fstream>
+
+#include <ccb/config/JsonDirectInputArchive.hpp>
+#include <ccb/config/JsonInputArchive.hpp>
+#include <ccb/config/JsonOutputArchive.hpp>
+#include <ccb/filesystem/FileSystem.hpp>
+#include <ccb_tests/config/TestConfig.hpp>
+#include <ccb_tests/config/TestDefaultConfig.hpp>
+#include <ccb_tests/config/TestProxyConfig.hpp>
+
+namespace ccb { namespace config
+{
+    class JsonDirectArchiveTests : public CxxTest::TestSuite
+    {
+    private:
+
+        class Settings
+        {
+        public:
+
+            int width = 0;
+
+            int height = 0;
+
+            double scale = 0;
+
+            bool enabled = false;
+
+            std::string name;
+
+            std::wstring title;
+
+            uint64_t id = 0;
+
+            TestConfig<int> limits;
+
+            int retries = 0;
+
+        private:
+
+            template<typename Archive>
+            void Serialize(Archive& ar)
+            {
+                CCB_SERIALIZE(ar, width);
+                CCB_SERIALIZE(ar, height);
+                CCB_SERIALIZE(ar, scale);
+                CCB_SERIALIZE(ar, enabled);
+                CCB_SERIALIZE(ar, name);
+                CCB_SERIALIZE(ar, title);
+                CCB_SERIALIZE(ar, id);
+                CCB_SERIALIZE(ar, limits);
+                CCB_SERIALIZE_DEFAULT(ar, retries, 3);
+            }
+
+            friend class ccb::config::Access;
+        };
+
+        /// Number stored as text, which can't be converted from an empty string.
+        class NumberText
+        {
+        public:
+
+            int value = 0;
+
+        private:
+
+            template<typename Archive>
+            void Serialize(Archive& ar)
+            {
+                CCB_SERIALIZE_AS(std::string, ar, value,
+                    [](const std::string& v) { return std::stoi(v); },
+                    [](int v) { return std::to_string(v); });
+            }
+
+            friend class ccb::config::Access;
+        };
+
+    public:
+
+        void TestValueSerialization()
+        {
+            filesystem::FileSystem filesystem;
+            auto tempFile = filesystem.GetTempPath() / filesystem.UniquePath();
+
+            TestConfig<bool> configBool1(true);
+            TestConfig<int8_t> configInt81(-13);
+            TestConfig<uint64_t> configUInt641(std::numeric_limits<uint64_t>::max());
+            TestConfig<double> configDouble1(1.0 / 3);
+            TestConfig<float> configFloat1(0.1f);
+            TestConfig<std::string> configString1("hello");
+            TestConfig<std::wstring> configWString1(L"\"wéllo\"");
+            TestConfig<TestConfig<int>> configSub1(TestConfig<int>(13));
+
+            {
+                JsonOutputArchive ar(tempFile.ToShortString());
+                ar.Serialize(configBool1, L"bool");
+                ar.Serialize(configInt81, L"int8");
+                ar.Serialize(configUInt641, L"uint64");
+                ar.Serialize(configDouble1, L"double");
+                ar.Serialize(configFloat1, L"float");
+                ar.Serialize(configString1, L"string");
+                ar.Serialize(configWString1, L"wstring");
+                ar.Serialize(configSub1, L"sub");
+            }
+
+            TestConfig<bool> configBool2(false);
+            TestConfig<int8_t> configInt82;
+            TestConfig<uint64_t> configUInt642;
+            TestConfig<double> configDouble2;
+            TestConfig<float> configFloat2;
+            TestConfig<std::string> configString2;
+            TestConfig<std::wstring> configWString2;
+            TestConfig<TestConfig<int>> configSub2;
+
+            {
+                JsonDirectInputArchive ar(tempFile.ToShortString());
+                ar.Serialize(configBool2, L"bool");
+                ar.Serialize(configInt82, L"int8");
+                ar.Serialize(configUInt642, L"uint64");
+                ar.Serialize(configDouble2, L"double");
+                ar.Serialize(configFloat2, L"float");
+                ar.Serialize(configString2, L"string");
+                ar.Serialize(configWString2, L"wstring");
+                ar.Serialize(configSub2, L"sub");
+            }
+
+            TS_ASSERT_EQUALS(configBool1.GetValue(), configBool2.GetValue());
+            TS_ASSERT_EQUALS(configInt81.GetValue(), configInt82.GetValue());
+            TS_ASSERT_EQUALS(configUInt641.GetValue(), configUInt642.GetValue());
+            TS_ASSERT_EQUALS(configDouble1.GetValue(), configDouble2.GetValue());
+            TS_ASSERT_EQUALS(configFloat1.GetValue(), configFloat2.GetValue());
+            TS_ASSERT_EQUALS(configString1.GetValue(), configString2.GetValue());
+            TS_ASSERT(configWString1.GetValue() == configWString2.GetValue());
+            TS_ASSERT_EQUALS(configSub1.GetValue().GetValue(), configSub2.GetValue().GetValue());
+
+            filesystem.Remove(tempFile);
+        }
+
+        void TestFieldsInAnyOrder()
+        {
+            std::string text =
+                "{ \"settings\": { \"limits\": { \"value\": 5 }, \"title\": \"T\\u00e9\", \"id\": 18446744073709551615,"
+                " \"unknown\": [1, {\"x\": 2}], \"scale\": 2.5e1, \"enabled\": true, \"height\": 20,"
+                " \"width\": 10, \"name\": \"n\" } }";
+
+            Settings settings;
+
+            JsonDirectInputArchive ar(text.data(), text.size());
+            ar.Serialize(settings, L"settings");
+
+            TS_ASSERT_EQUALS(10, settings.width);
+            TS_ASSERT_EQUALS(20, settings.height);
+            TS_ASSERT_EQUALS(25.0, settings.scale);
+            TS_ASSERT_EQUALS(true, settings.enabled);
+            TS_ASSERT_EQUALS("n", settings.name);
+            TS_ASSERT(settings.title == L"Té");
+            TS_ASSERT_EQUALS(std::numeric_limits<uint64_t>::max(), settings.id);
+            TS_ASSERT_EQUALS(5, settings.limits.GetValue());
+            TS_ASSERT_EQUALS(3, settings.retries);
+        }
+
+        void TestFieldTable()
+        {
+            Settings settings;
+
+            const auto& table = details::GetConfigFieldTable<Settings>();
+
+            TS_ASSERT_EQUALS(9u, table.GetSize());
+            TS_ASSERT(table.GetName(0) == L"width");
+            TS_ASSERT(table.GetName(8) == L"retries");
+            TS_ASSERT_EQUALS(4, table.Find("name", 4));
+            TS_ASSERT_EQUALS(7, table.Find("limits", 6));
+            TS_ASSERT_EQUALS(-1, table.Find("limit", 5));
+            TS_ASSERT_EQUALS(-1, table.Find("", 0));
+            TS_ASSERT_EQUALS(&table, &details::GetConfigFieldTable<Settings>());
+        }
+
+        void TestErrors()
+        {
+            TestConfig<int> config;
+            TestConfig<TestConfig<int>> subConfig;
+
+            std::string missing = "{ \"config\": { \"other\": 1 } }";
+            TS_ASSERT_THROWS(JsonDirectInputArchive(missing.data(), missing.size()).Serialize(config, L"config"), std::runtime_error);
+
+            std::string duplicate = "{ \"config\": { \"value\": 1, \"value\": 2 } }";
+            TS_ASSERT_THROWS(JsonDirectInputArchive(duplicate.data(), duplicate.size()).Serialize(config, L"config"), std::runtime_error);
+
+            std::string notMap = "{ \"config\": { \"value\": 1 } }";
+            TS_ASSERT_THROWS(JsonDirectInputArchive(notMap.data(), notMap.size()).Serialize(subConfig, L"config"), std::runtime_error);
+
+            std::string notValue = "{ \"config\": { \"value\": [1] } }";
+            TS_ASSERT_THROWS(JsonDirectInputArchive(notValue.data(), notValue.size()).Serialize(config, L"config"), std::runtime_error);
+
+            std::string array = "[1]";
+            TS_ASSERT_THROWS(JsonDirectInputArchive(array.data(), array.size()), std::runtime_error);
+
+            std::string broken = "{ \"config\": { \"value\": 1 }";
+            TS_ASSERT_THROWS(JsonDirectInputArchive(broken.data(), broken.size()), std::runtime_error);
+        }
+
+        void TestDefaultSerialization()
+        {
+            std::string text = "{ \"config\" : {} }";
+
+            TestDefaultConfig<bool> config(true);
+
+            JsonDirectInputArchive ar(text.data(), text.size());
+            ar.Serialize(config, L"config");
+
+            TS_ASSERT_EQUALS(true, config.GetValue());
+        }
+
+        void TestProxySerialization()
+        {
+            filesystem::FileSystem filesystem;
+            auto tempFile = filesystem.GetTempPath() / filesystem.UniquePath();
+
+            TestProxyConfig<bool, std::string> config1(
+                [](const std::string& v) { return v == "yes"; },
+                [](bool v) { return v ? std::string("yes") : std::string("no"); },
+                true);
+
+            {
+                JsonOutputArchive ar(tempFile.ToShortString());
+                ar.Serialize(config1, L"config");
+            }
+
+            TestProxyConfig<bool, std::string> config2(
+                [](const std::string& v) { return v == "yes"; },
+                [](bool v) { return v ? std::string("yes") : std::string("no"); },
+                false);
+
+            {
+                JsonDirectInputArchive ar(tempFile.ToShortString());
+                ar.Serialize(config2, L"config");
+            }
+
+            TS_ASSERT_EQUALS(config1.GetValue(), config2.GetValue());
+
+            filesystem.Remove(tempFile);
+        }
+
+        void TestTypesWithoutFieldTable()
+        {
+            // Converting the empty proxy of the recording pass throws, so the type gets no field table.
+            TS_ASSERT_EQUALS(0u, details::GetConfigFieldTable<NumberText>().GetSize());
+
+            // Types without a default constructor can't be recorded either.
+            TestProxyConfig<int, std::string> config(
+                [](const std::string& v) { return std::stoi(v); },
+                [](int v) { return std::to_string(v); },
+                7);
+
+            TS_ASSERT_EQUALS(0u, details::GetConfigFieldTable<decltype(config)>().GetSize());
+
+            std::string text = "{ \"number\": { \"value\": \"42\" }, \"config\": { \"this->value\": \"43\" } }";
+
+            NumberText number;
+
+            JsonDirectInputArchive ar(text.data(), text.size());
+            ar.Serialize(number, L"number");
+            ar.Serialize(config, L"config");
+
+            TS_ASSERT_EQUALS(42, number.value);
+            TS_ASSERT_EQUALS(43, config.GetValue());
+        }
+
+        void TestPerformance()
+        {
+            filesystem::FileSystem filesystem;
+            auto tempFile = filesystem.GetTempPath() / filesystem.UniquePath();
+
+            const int count = 20000;
+
+            {
+                auto stream = std::ofstream(tempFile.ToShortString());
+
+                stream << "{";
+                for (int i = 0; i < count; i++)
+                {
+                    stream << (i ? "," : "") << "\"s" << i << "\": {\"width\": " << i << ", \"height\": 480, \"scale\": 1.25,"
+                        << " \"enabled\": true, \"name\": \"settings\", \"title\": \"Title\", \"id\": 123456789,"
+                        << " \"limits\": {\"value\": 7}, \"retries\": 5}";
+                }
+                stream << "}";
+            }
+
+            std::vector<std::wstring> names;
+            for (int i = 0; i < count; i++)
+            {
+                names.push_back(L"s" + std::to_wstring(i));
+            }
+
+            std::vector<Settings> settings1(count);
+            std::vector<Settings> settings2(count);
+
+            auto t1 = std::chrono::system_clock::now();
+            {
+                JsonInputArchive ar(tempFile.ToShortString());
+                for (int i = 0; i < count; i++)
+                {
+                    ar.Serialize(settings1[i], names[i]);
+                }
+            }
+            auto t2 = std::chrono::system_clock::now();
+            {
+                JsonDirectInputArchive ar(tempFile.ToShortString());
+                for (int i = 0; i < count; i++)
+                {
+                    ar.Serialize(settings2[i], names[i]);
+                }
+            }
+            auto t3 = std::chrono::system_clock::now();
+
+            for (int i = 0; i < count; i++)
+            {
+                TS_ASSERT_EQUALS(i, settings2[i].width);
+                TS_ASSERT_EQUALS(settings1[i].scale, settings2[i].scale);
+                TS_ASSERT_EQUALS(settings1[i].name, settings2[i].name);
+                TS_ASSERT_EQUALS(settings1[i].limits.GetValue(), settings2[i].limits.GetValue());
+                TS_ASSERT_EQUALS(5, settings2[i].retries);
+            }
+
+            std::cout << std::endl << "JSON config: tree " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count()
+                << " ms, direct " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count() << " ms" << std::endl;
+
+            filesystem.Remove(tempFile);
+        }
+    };
+} }
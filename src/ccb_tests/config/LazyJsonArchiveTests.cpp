@@ -0,0 +1,134 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <fstream>
+
+#include <ccb/config/JsonOutputArchive.hpp>
+#include <ccb/config/LazyJsonInputArchive.hpp>
+#include <ccb/filesystem/FileSystem.hpp>
+#include <ccb_tests/config/TestConfig.hpp>
+#include <ccb_tests/config/TestDefaultConfig.hpp>
+
+namespace ccb { namespace config
+{
+    class LazyJsonArchiveTests : public CxxTest::TestSuite
+    {
+    public:
+
+        void TestValueSerialization()
+        {
+            filesystem::FileSystem filesystem;
+            auto tempFile = filesystem.GetTempPath() / filesystem.UniquePath();
+
+            TestConfig<bool> configBool1(true);
+            TestConfig<int8_t> configInt81(-13);
+            TestConfig<uint64_t> configUInt641(std::numeric_limits<uint64_t>::max());
+            TestConfig<double> configDouble1(2.5);
+            TestConfig<std::wstring> configString1(L"\"value\"");
+            TestConfig<TestConfig<int>> configSub1(TestConfig<int>(13));
+
+            {
+                JsonOutputArchive ar(tempFile.ToShortString());
+                ar.Serialize(configBool1, L"bool");
+                ar.Serialize(configInt81, L"int8");
+                ar.Serialize(configUInt641, L"uint64");
+                ar.Serialize(configDouble1, L"double");
+                ar.Serialize(configString1, L"string");
+                ar.Serialize(configSub1, L"sub");
+            }
+
+            TestConfig<bool> configBool2(false);
+            TestConfig<int8_t> configInt82;
+            TestConfig<uint64_t> configUInt642;
+            TestConfig<double> configDouble2;
+            TestConfig<std::wstring> configString2;
+            TestConfig<TestConfig<int>> configSub2;
+
+            {
+                LazyJsonInputArchive ar(tempFile.ToShortString());
+                ar.Serialize(configBool2, L"bool");
+                ar.Serialize(configInt82, L"int8");
+                ar.Serialize(configUInt642, L"uint64");
+                ar.Serialize(configDouble2, L"double");
+                ar.Serialize(configString2, L"string");
+                ar.Serialize(configSub2, L"sub");
+            }
+
+            TS_ASSERT_EQUALS(configBool1.GetValue(), configBool2.GetValue());
+            TS_ASSERT_EQUALS(configInt81.GetValue(), configInt82.GetValue());
+            TS_ASSERT_EQUALS(configUInt641.GetValue(), configUInt642.GetValue());
+            TS_ASSERT_EQUALS(configDouble1.GetValue(), configDouble2.GetValue());
+            TS_ASSERT(configString1.GetValue() == configString2.GetValue());
+            TS_ASSERT_EQUALS(configSub1.GetValue().GetValue(), configSub2.GetValue().GetValue());
+
+            filesystem.Remove(tempFile);
+        }
+
+        void TestUnusedSectionsAreNotParsed()
+        {
+            filesystem::FileSystem filesystem;
+            auto tempFile = filesystem.GetTempPath() / filesystem.UniquePath();
+
+            {
+                auto stream = std::ofstream(tempFile.ToShortString());
+
+                stream << "{ \"other\" : [1, 2 3], \"config\" : { \"value\": { \"value\": 7 } } }";
+            }
+
+            TestConfig<TestConfig<int>> config;
+
+            {
+                LazyJsonInputArchive ar(tempFile.ToShortString());
+                ar.Serialize(config, L"config");
+            }
+
+            TS_ASSERT_EQUALS(7, config.GetValue().GetValue());
+
+            filesystem.Remove(tempFile);
+        }
+
+        void TestDefaultSerialization()
+        {
+            filesystem::FileSystem filesystem;
+            auto tempFile = filesystem.GetTempPath() / filesystem.UniquePath();
+
+            {
+                auto stream = std::ofstream(tempFile.ToShortString());
+
+                stream << "{ \"config\" : {} }";
+            }
+
+            TestDefaultConfig<bool> config(true);
+
+            {
+                LazyJsonInputArchive ar(tempFile.ToShortString());
+                ar.Serialize(config, L"config");
+            }
+
+            TS_ASSERT_EQUALS(true, config.GetValue());
+
+            filesystem.Remove(tempFile);
+        }
+    };
+} }
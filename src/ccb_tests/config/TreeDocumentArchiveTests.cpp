@@ -0,0 +1,129 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <sstream>
+
+#include <ccb/config/TreeDocumentInputArchive.hpp>
+#include <ccb/config/TreeOutputArchive.hpp>
+#include <ccb/tree/JsonTreeSerializer.hpp>
+#include <ccb_tests/config/TestConfig.hpp>
+#include <ccb_tests/config/TestDefaultConfig.hpp>
+
+namespace ccb { namespace config
+{
+    class TreeDocumentArchiveTests : public CxxTest::TestSuite
+    {
+    private:
+
+        static TreeDocument ToDocument(TreeOutputArchive& output)
+        {
+            JsonTreeSerializer serializer;
+
+            std::stringstream stream;
+            serializer.Serialize(output.GetTree(), stream);
+
+            return serializer.DeserializeDocument(stream);
+        }
+
+    public:
+
+        void TestValueSerialization()
+        {
+            TestConfig<bool> configBool1(true);
+            TestConfig<int8_t> configInt81(-13);
+            TestConfig<uint64_t> configUInt641(std::numeric_limits<uint64_t>::max());
+            TestConfig<double> configDouble1(2.5);
+            TestConfig<std::wstring> configString1(L"value");
+
+            TreeOutputArchive output;
+            output.Serialize(configBool1, L"bool");
+            output.Serialize(configInt81, L"int8");
+            output.Serialize(configUInt641, L"uint64");
+            output.Serialize(configDouble1, L"double");
+            output.Serialize(configString1, L"string");
+
+            auto document = ToDocument(output);
+
+            TestConfig<bool> configBool2(false);
+            TestConfig<int8_t> configInt82;
+            TestConfig<uint64_t> configUInt642;
+            TestConfig<double> configDouble2;
+            TestConfig<std::wstring> configString2;
+
+            TreeDocumentInputArchive input(document.GetRoot());
+            input.Serialize(configBool2, L"bool");
+            input.Serialize(configInt82, L"int8");
+            input.Serialize(configUInt642, L"uint64");
+            input.Serialize(configDouble2, L"double");
+            input.Serialize(configString2, L"string");
+
+            TS_ASSERT_EQUALS(configBool1.GetValue(), configBool2.GetValue());
+            TS_ASSERT_EQUALS(configInt81.GetValue(), configInt82.GetValue());
+            TS_ASSERT_EQUALS(configUInt641.GetValue(), configUInt642.GetValue());
+            TS_ASSERT_EQUALS(configDouble1.GetValue(), configDouble2.GetValue());
+            TS_ASSERT(configString1.GetValue() == configString2.GetValue());
+        }
+
+        void TestSubclassSerialization()
+        {
+            TestConfig<TestConfig<int>> config1(TestConfig<int>(13));
+
+            TreeOutputArchive output;
+            output.Serialize(config1, L"config");
+
+            auto document = ToDocument(output);
+
+            TestConfig<TestConfig<int>> config2;
+
+            TreeDocumentInputArchive input(document.GetRoot());
+            input.Serialize(config2, L"config");
+
+            TS_ASSERT_EQUALS(config1.GetValue().GetValue(), config2.GetValue().GetValue());
+        }
+
+        void TestDefaultSerialization()
+        {
+            std::string text = "{ \"config\" : {} }";
+            auto document = JsonTreeSerializer().DeserializeDocument(text.data(), text.size());
+
+            TestDefaultConfig<bool> config(true);
+
+            TreeDocumentInputArchive input(document.GetRoot());
+            input.Serialize(config, L"config");
+
+            TS_ASSERT_EQUALS(true, config.GetValue());
+        }
+
+        void TestMissingField()
+        {
+            std::string text = "{ \"config\" : {} }";
+            auto document = JsonTreeSerializer().DeserializeDocument(text.data(), text.size());
+
+            TestConfig<int> config;
+
+            TreeDocumentInputArchive input(document.GetRoot());
+            TS_ASSERT_THROWS(input.Serialize(config, L"config"), std::runtime_error);
+        }
+    };
+} }
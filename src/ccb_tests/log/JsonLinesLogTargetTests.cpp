@@ -0,0 +1,97 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <limits>
+#include <sstream>
+
+#include <ccb/log/JsonLinesLogTarget.hpp>
+
+namespace ccb { namespace log
+{
+    class JsonLinesLogTargetTests : public CxxTest::TestSuite
+    {
+    private:
+
+        static Time GetTime()
+        {
+            // 2020-01-02T03:04:05.678Z
+            return Time(std::chrono::system_clock::from_time_t(1577934245) + std::chrono::milliseconds(678));
+        }
+
+    public:
+
+        void TestMessage()
+        {
+            std::ostringstream stream;
+            JsonLinesLogTarget target(stream);
+
+            target.LogMessage(GetTime(), LogLevel::Warning, L".app", L"started");
+            target.Flush();
+
+            TS_ASSERT_EQUALS(
+                "{\"time\":\"2020-01-02T03:04:05.678Z\",\"level\":\"Warning\",\"source\":\".app\",\"message\":\"started\"}\n",
+                stream.str());
+        }
+
+        void TestFieldTypes()
+        {
+            std::ostringstream stream;
+            JsonLinesLogTarget target(stream);
+
+            LogFields fields;
+            fields.push_back(Field("bool", true));
+            fields.push_back(Field("int", -12));
+            fields.push_back(Field("uint", 18446744073709551615ull));
+            fields.push_back(Field("double", 0.5));
+            fields.push_back(Field("nan", std::numeric_limits<double>::quiet_NaN()));
+            fields.push_back(Field("str", "text"));
+
+            target.LogStructuredMessage(GetTime(), LogLevel::Info, L".app", L"m", fields);
+            target.Flush();
+
+            TS_ASSERT_EQUALS(
+                "{\"time\":\"2020-01-02T03:04:05.678Z\",\"level\":\"Info\",\"source\":\".app\",\"message\":\"m\","
+                "\"bool\":true,\"int\":-12,\"uint\":18446744073709551615,\"double\":0.5,\"nan\":null,\"str\":\"text\"}\n",
+                stream.str());
+        }
+
+        void TestEscaping()
+        {
+            std::ostringstream stream;
+            JsonLinesLogTarget target(stream);
+
+            LogFields fields;
+            fields.push_back(Field("na\"me\\", "va\"l\\ue\n\t\x01"));
+            fields.push_back(Field("wide\n", L"\x00e9\x20ac\r"));
+
+            target.LogStructuredMessage(GetTime(), LogLevel::Error, L"src\"", L"line1\nline2", fields);
+            target.Flush();
+
+            TS_ASSERT_EQUALS(
+                "{\"time\":\"2020-01-02T03:04:05.678Z\",\"level\":\"Error\",\"source\":\"src\\\"\",\"message\":\"line1\\nline2\","
+                "\"na\\\"me\\\\\":\"va\\\"l\\\\ue\\n\\t\\u0001\",\"wide\\n\":\"\xc3\xa9\xe2\x82\xac\\r\"}\n",
+                stream.str());
+        }
+    };
+} }
@@ -0,0 +1,157 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <ccb/log/Logger.hpp>
+#include <ccb_tests/log/TestLogTarget.hpp>
+
+namespace ccb { namespace log
+{
+    class LogCallSiteTests : public CxxTest::TestSuite
+    {
+    private:
+
+        static const int64_t MILLISECOND = 1000000;
+
+    public:
+
+        void TestTokenBucket()
+        {
+            // Ten messages per second with a burst of three.
+            LogCallSite callSite(10, 3);
+
+            int64_t now = 1000 * MILLISECOND;
+
+            TS_ASSERT(callSite.Allow(now));
+            TS_ASSERT(callSite.Allow(now));
+            TS_ASSERT(callSite.Allow(now));
+            TS_ASSERT(!callSite.Allow(now));
+            TS_ASSERT(!callSite.Allow(now + 50 * MILLISECOND));
+            TS_ASSERT_EQUALS(2u, callSite.TakeSuppressed());
+            TS_ASSERT_EQUALS(0u, callSite.TakeSuppressed());
+
+            // One token comes back every 100 ms.
+            TS_ASSERT(callSite.Allow(now + 100 * MILLISECOND));
+            TS_ASSERT(!callSite.Allow(now + 100 * MILLISECOND));
+
+            // A long pause refills the bucket up to the burst size only.
+            now += 10000 * MILLISECOND;
+
+            size_t admitted = 0;
+            for (int i = 0; i < 10; i++)
+            {
+                admitted += callSite.Allow(now) ? 1 : 0;
+            }
+
+            TS_ASSERT_EQUALS(3u, admitted);
+            TS_ASSERT_EQUALS(8u, callSite.TakeSuppressed());
+        }
+
+        void TestSampling()
+        {
+            LogCallSite none(0, 1, 0.0);
+            LogCallSite all(0, 1, 1.0);
+            LogCallSite half(0, 1, 0.5);
+
+            size_t admitted = 0;
+
+            for (int i = 0; i < 10000; i++)
+            {
+                TS_ASSERT(!none.Allow());
+                TS_ASSERT(all.Allow());
+                admitted += half.Allow() ? 1 : 0;
+            }
+
+            TS_ASSERT_EQUALS(10000u, none.TakeSuppressed());
+            TS_ASSERT_EQUALS(0u, all.TakeSuppressed());
+            TS_ASSERT(admitted > 4000 && admitted < 6000);
+            TS_ASSERT_EQUALS(10000u - admitted, half.TakeSuppressed());
+        }
+
+        void TestSuppressedArgumentsAreNotEvaluated()
+        {
+            TestLogTarget target;
+            LogSink::GetSink().AddTarget(&target);
+
+            Logger logger("limited");
+            int evaluated = 0;
+
+            auto argument = [&evaluated] ()
+            {
+                evaluated++;
+                return std::wstring(L"value");
+            };
+
+            for (int i = 0; i < 100; i++)
+            {
+                CCB_LOG_LIMITED(logger, LogLevel::Info, 0.001, 1, L"message ", argument());
+            }
+
+            TS_ASSERT_EQUALS(1, evaluated);
+
+            auto entries = target.WaitEntries(1);
+            TS_ASSERT_EQUALS(1u, entries.size());
+            TS_ASSERT(entries[0].message == L"message value");
+
+            LogSink::GetSink().RemoveTarget(&target);
+        }
+
+        void TestSuppressedSummary()
+        {
+            TestLogTarget target;
+            LogSink::GetSink().AddTarget(&target);
+
+            Logger logger("summary");
+
+            for (int i = 0; i < 100; i++)
+            {
+                CCB_LOG_LIMITED(logger, LogLevel::Warning, 0.001, 1, L"storm");
+            }
+
+            // The dispatcher reports the count on its own once the storm is over.
+            LogSink::GetSink().SetSummaryInterval(std::chrono::milliseconds(10));
+
+            target.WaitEntries(2);
+
+            LogSink::GetSink().SetSummaryInterval(std::chrono::milliseconds(1000));
+            LogSink::GetSink().RemoveTarget(&target);
+
+            // Other call sites may report their own counts meanwhile.
+            std::vector<TestLogTarget::Entry> entries;
+            for (const auto& entry : target.GetEntries())
+            {
+                if (entry.source == L".summary")
+                {
+                    entries.push_back(entry);
+                }
+            }
+
+            TS_ASSERT_EQUALS(2u, entries.size());
+            TS_ASSERT(entries[0].message == L"storm");
+            TS_ASSERT(entries[1].level == LogLevel::Warning);
+            TS_ASSERT_EQUALS(1u, entries[1].fields.size());
+            TS_ASSERT_EQUALS("suppressed", entries[1].fields[0].GetName());
+            TS_ASSERT_EQUALS(99u, entries[1].fields[0].GetUInt());
+        }
+    };
+} }
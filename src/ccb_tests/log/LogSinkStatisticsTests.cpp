@@ -0,0 +1,132 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <ccb/log/LogSink.hpp>
+#include <ccb_tests/log/TestLogTarget.hpp>
+
+namespace ccb { namespace log
+{
+    class LogSinkStatisticsTests : public CxxTest::TestSuite
+    {
+    public:
+
+        void TestHistogramPercentiles()
+        {
+            LogHistogram histogram;
+
+            for (uint64_t i = 1; i <= 1000; i++)
+            {
+                histogram.Record(i);
+            }
+
+            auto snapshot = histogram.GetSnapshot();
+
+            TS_ASSERT_EQUALS(1000u, snapshot.GetCount());
+            TS_ASSERT_EQUALS(500500u, snapshot.GetSum());
+            TS_ASSERT_EQUALS(1000u, snapshot.GetMax());
+            TS_ASSERT_DELTA(500.5, snapshot.GetMean(), 1e-9);
+
+            // Buckets keep the relative error within 1/16.
+            TS_ASSERT_DELTA(500.0, snapshot.GetPercentile(50), 500.0 / 16);
+            TS_ASSERT_DELTA(900.0, snapshot.GetPercentile(90), 900.0 / 16);
+            TS_ASSERT_DELTA(990.0, snapshot.GetPercentile(99), 990.0 / 16);
+            TS_ASSERT(snapshot.GetPercentile(50) >= 500);
+            TS_ASSERT_EQUALS(1000u, snapshot.GetPercentile(100));
+            TS_ASSERT_EQUALS(1u, snapshot.GetPercentile(0));
+        }
+
+        void TestHistogramSmallAndLargeValues()
+        {
+            LogHistogram histogram;
+
+            histogram.Record(0);
+            histogram.Record(3);
+            histogram.Record(15);
+            histogram.Record(1ull << 40);
+
+            auto snapshot = histogram.GetSnapshot();
+
+            TS_ASSERT_EQUALS(4u, snapshot.GetCount());
+            TS_ASSERT_EQUALS(0u, snapshot.GetPercentile(25));
+            TS_ASSERT_EQUALS(3u, snapshot.GetPercentile(50));
+            TS_ASSERT_EQUALS(15u, snapshot.GetPercentile(75));
+            TS_ASSERT_EQUALS(1ull << 40, snapshot.GetPercentile(100));
+            TS_ASSERT_EQUALS(0u, LogHistogramSnapshot().GetPercentile(50));
+        }
+
+        void TestSinkCounters()
+        {
+            TestLogTarget target;
+
+            {
+                LogSink sink;
+                sink.AddTarget(&target);
+
+                for (int i = 0; i < 100; i++)
+                {
+                    sink.WriteMessage(LogLevel::Info, L".test", L"message");
+                }
+
+                target.WaitEntries(100);
+
+                // Counters are updated right after the targets get the entry.
+                auto statistics = sink.GetStatistics();
+                for (int i = 0; (i < 500) && (statistics.delivered < 100); i++)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    statistics = sink.GetStatistics();
+                }
+
+                TS_ASSERT_EQUALS(100u, statistics.enqueued);
+                TS_ASSERT_EQUALS(100u, statistics.delivered);
+                TS_ASSERT_EQUALS(0u, statistics.dropped);
+                TS_ASSERT_EQUALS(0u, statistics.queueDepth);
+                TS_ASSERT_EQUALS(100u, statistics.latency.GetCount());
+                TS_ASSERT_EQUALS(100u, statistics.batchSize.GetSum());
+                TS_ASSERT_EQUALS(1u, statistics.targetTimes.size());
+                TS_ASSERT_EQUALS(100u, statistics.targetTimes[&target].GetCount());
+            }
+
+            TS_ASSERT_EQUALS(100u, target.GetEntries().size());
+        }
+
+        void TestSinkDropsOverQueueLimit()
+        {
+            LogSink sink;
+
+            // Without targets the dispatcher still drains the queue, so fill it faster than it can.
+            sink.SetMaxQueueSize(1);
+
+            for (int i = 0; i < 10000; i++)
+            {
+                sink.WriteMessage(LogLevel::Info, L".test", L"message");
+            }
+
+            auto statistics = sink.GetStatistics();
+
+            TS_ASSERT_EQUALS(10000u, statistics.enqueued + statistics.dropped);
+            TS_ASSERT(statistics.enqueued >= 1);
+        }
+    };
+} }
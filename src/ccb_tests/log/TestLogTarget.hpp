@@ -0,0 +1,104 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ccb/log/ILogTarget.hpp>
+
+namespace ccb { namespace log
+{
+    /// Keeps the messages it gets, for checking what LogSink delivered.
+    class TestLogTarget : public ILogTarget
+    {
+    public:
+
+        struct Entry
+        {
+            LogLevel level;
+
+            std::wstring source;
+
+            std::wstring message;
+
+            LogFields fields;
+        };
+
+    private:
+
+        std::mutex mutex;
+
+        std::vector<Entry> entries;
+
+    public:
+
+        virtual void LogMessage(
+            const Time& time,
+            LogLevel level,
+            const std::wstring& source,
+            const std::wstring& message) override
+        {
+            this->LogStructuredMessage(time, level, source, message, LogFields());
+        }
+
+        virtual void LogStructuredMessage(
+            const Time& time,
+            LogLevel level,
+            const std::wstring& source,
+            const std::wstring& message,
+            const LogFields& fields) override
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+
+            this->entries.push_back(Entry{level, source, message, fields});
+        }
+
+        std::vector<Entry> GetEntries()
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+
+            return this->entries;
+        }
+
+        /// Waits up to a few seconds for the sink to deliver the given number of entries.
+        std::vector<Entry> WaitEntries(size_t count)
+        {
+            for (int i = 0; i < 500; i++)
+            {
+                auto result = this->GetEntries();
+                if (result.size() >= count)
+                {
+                    return result;
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+
+            return this->GetEntries();
+        }
+    };
+} }
@@ -0,0 +1,185 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <chrono>
+#include <limits>
+#include <sstream>
+
+#include <ccb/binary/Hex.hpp>
+#include <ccb/tree/CborTreeSerializer.hpp>
+#include <ccb/tree/JsonTreeSerializer.hpp>
+
+namespace ccb { namespace tree
+{
+    class CborTreeSerializerTests : public CxxTest::TestSuite
+    {
+    public:
+
+        void TestEncoding()
+        {
+            TreeMap map;
+            map.Set<TreeValue>(L"a").SetValue(1);
+            map.Set<TreeValue>(L"b").SetValue(-500);
+            map.Set<TreeValue>(L"c").SetValue(1.5);
+            map.Set<TreeValue>(L"d").SetValue(true);
+            map.Set<TreeValue>(L"e").SetNull();
+            map.Set<TreeArray>(L"f").Add<TreeValue>().SetString(L"x");
+
+            auto bytes = CborTreeSerializer().Serialize(map);
+
+            // {"a": 1, "b": -500, "c": 1.5 as a float, "d": true, "e": null, "f": 24(h'816178')}
+            TS_ASSERT_EQUALS("a661610161623901f36163fa3fc000006164f56165f66166d8185a00000003816178", binary::ToHex(bytes.data(), bytes.size()));
+        }
+
+        void TestRoundTrip()
+        {
+            std::string text = "{\"name\": \"\\u043f\\u0440\\u0438\\u0432\\u0435\\u0442\", \"count\": 42, \"big\": 18446744073709551615,"
+                " \"min\": -9223372036854775808, \"pi\": 3.141592653589793, \"items\": [[], {}, [1, [2, {\"x\": null}]]], \"ok\": false}";
+
+            JsonTreeSerializer json;
+            auto source = json.Deserialize(text.data(), text.size());
+
+            CborTreeSerializer cbor;
+            std::stringstream stream;
+            cbor.Serialize(*source, stream);
+
+            auto node = cbor.Deserialize(stream);
+            TS_ASSERT_EQUALS(json.Serialize(*source, JsonStyle::Compact), json.Serialize(*node, JsonStyle::Compact));
+
+            const auto& map = static_cast<const TreeMap&>(*node);
+            TS_ASSERT(map.Get<TreeValue>(L"name").GetString() == L"привет");
+            TS_ASSERT_EQUALS(std::numeric_limits<uint64_t>::max(), map.Get<TreeValue>(L"big").GetValue<uint64_t>());
+            TS_ASSERT_EQUALS(std::numeric_limits<int64_t>::min(), map.Get<TreeValue>(L"min").GetValue<int64_t>());
+            TS_ASSERT_EQUALS(3.141592653589793, map.Get<TreeValue>(L"pi").GetValue<double>());
+        }
+
+        void TestInPlace()
+        {
+            TreeMap map;
+            auto& servers = map.Set<TreeArray>(L"servers");
+            for (int i = 0; i < 3; i++)
+            {
+                auto& server = servers.Add<TreeMap>();
+                server.Set<TreeValue>(L"port").SetValue(8080 + i);
+                server.Set<TreeArray>(L"tags").Add<TreeValue>().SetString(L"tag");
+            }
+            map.Set<TreeValue>(L"name").SetString(L"main");
+
+            CborDocument document(CborTreeSerializer().Serialize(map));
+            auto root = document.GetRoot();
+
+            TS_ASSERT(root.GetType() == TreeNodeType::Map);
+            TS_ASSERT_EQUALS(2u, root.GetSize());
+            TS_ASSERT(root.GetNode(L"name").GetString() == L"main");
+            TS_ASSERT(root.GetNode(L"name").GetValueType() == TreeValueType::String);
+            TS_ASSERT(!root.HasNode(L"other"));
+            TS_ASSERT_THROWS(root.GetNode(L"other"), std::runtime_error);
+
+            auto list = root.GetNode(L"servers");
+            TS_ASSERT(list.GetType() == TreeNodeType::Array);
+            TS_ASSERT_EQUALS(3u, list.GetSize());
+            TS_ASSERT_EQUALS(8082, list.Get(2).GetNode(L"port").GetValue<int>());
+            TS_ASSERT(list.Get(1).Get(1).Get(0).GetString() == L"tag");
+            TS_ASSERT_THROWS(list.Get(3), std::runtime_error);
+        }
+
+        void TestForeignEncoding()
+        {
+            // Plain nested containers, a tag other than 24 and a half float, as other encoders write them.
+            // {"a": [1, {"b": 2}], "t": 1(1000), "h": 1.5 (half)}
+            auto bytes = binary::FromHex("a3616182" "01" "a1616202" "6174c11903e8" "6168f93e00");
+
+            CborDocument document(std::move(bytes));
+            auto root = document.GetRoot();
+
+            TS_ASSERT_EQUALS(2, root.GetNode(L"a").Get(1).GetNode(L"b").GetValue<int>());
+            TS_ASSERT_EQUALS(1000, root.GetNode(L"t").GetValue<int>());
+            TS_ASSERT_EQUALS(1.5, root.GetNode(L"h").GetValue<double>());
+        }
+
+        void TestErrors()
+        {
+            const char* bad[] =
+            {
+                "",
+                "a1",
+                "a16161",
+                "8201",
+                "9f01ff",
+                "6261",
+                "0101",
+            };
+
+            for (auto hex : bad)
+            {
+                auto bytes = binary::FromHex(hex);
+                TS_ASSERT_THROWS(CborTreeSerializer().Deserialize(bytes.data(), bytes.size()), std::runtime_error);
+            }
+
+            // Non-text keys.
+            auto bytes = binary::FromHex("a10101");
+            TS_ASSERT_THROWS(CborTreeSerializer().Deserialize(bytes.data(), bytes.size()), std::runtime_error);
+
+            // Deep nesting.
+            std::vector<uint8_t> deep(100000, 0x81);
+            deep.push_back(0x01);
+            TS_ASSERT_THROWS(CborTreeSerializer().Deserialize(deep.data(), deep.size()), std::runtime_error);
+        }
+
+        void TestStartupPerformance()
+        {
+            std::ostringstream text;
+            text << "{\"items\": [";
+            for (size_t i = 0; i < 100000; i++)
+            {
+                text << "{\"id\": " << i << ", \"name\": \"item " << i << "\", \"active\": true, \"tags\": [\"x\", \"y\"]},\n";
+            }
+            text << "], \"version\": 3}";
+
+            JsonTreeSerializer json;
+            auto jsonText = text.str();
+            auto tree = json.Deserialize(jsonText.data(), jsonText.size());
+
+            CborTreeSerializer cbor;
+            auto bytes = cbor.Serialize(*tree);
+            auto size = bytes.size();
+
+            auto t1 = std::chrono::system_clock::now();
+            json.Deserialize(jsonText.data(), jsonText.size());
+            auto t2 = std::chrono::system_clock::now();
+            cbor.Deserialize(bytes.data(), bytes.size());
+            auto t3 = std::chrono::system_clock::now();
+            CborDocument document(std::move(bytes));
+            auto version = document.GetRoot().GetNode(L"version").GetValue<int>();
+            auto t4 = std::chrono::system_clock::now();
+
+            TS_ASSERT_EQUALS(3, version);
+
+            std::cout << std::endl << "JSON: " << jsonText.size() << " bytes parsed in "
+                << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " micros, CBOR: " << size << " bytes to tree in "
+                << std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count() << " micros, one field in place in "
+                << std::chrono::duration_cast<std::chrono::microseconds>(t4 - t3).count() << " micros" << std::endl;
+        }
+    };
+} }
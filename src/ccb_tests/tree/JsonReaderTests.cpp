@@ -0,0 +1,157 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <ccb/tree/JsonReader.hpp>
+
+namespace ccb { namespace tree
+{
+    class JsonReaderTests : public CxxTest::TestSuite
+    {
+    public:
+
+        void TestEvents()
+        {
+            std::string text = "{\"a\": [1, -2.5e3, true, false, null], \"b\": {\"c\": \"d\"}}";
+            JsonReader reader(text.data(), text.size());
+
+            TS_ASSERT(reader.Next() == JsonEvent::StartObject);
+            TS_ASSERT(reader.Next() == JsonEvent::Key);
+            TS_ASSERT_EQUALS("a", reader.GetString());
+            TS_ASSERT(reader.Next() == JsonEvent::StartArray);
+            TS_ASSERT(reader.Next() == JsonEvent::Number);
+            TS_ASSERT_EQUALS("1", reader.GetString());
+            TS_ASSERT(reader.Next() == JsonEvent::Number);
+            TS_ASSERT_EQUALS("-2.5e3", reader.GetString());
+            TS_ASSERT(reader.Next() == JsonEvent::Bool);
+            TS_ASSERT(reader.GetBool());
+            TS_ASSERT(reader.Next() == JsonEvent::Bool);
+            TS_ASSERT(!reader.GetBool());
+            TS_ASSERT(reader.Next() == JsonEvent::Null);
+            TS_ASSERT(reader.Next() == JsonEvent::EndArray);
+            TS_ASSERT(reader.Next() == JsonEvent::Key);
+            TS_ASSERT_EQUALS("b", reader.GetString());
+            TS_ASSERT(reader.Next() == JsonEvent::StartObject);
+            TS_ASSERT(reader.Next() == JsonEvent::Key);
+            TS_ASSERT(reader.Next() == JsonEvent::String);
+            TS_ASSERT_EQUALS("d", reader.GetString());
+            TS_ASSERT_EQUALS(2u, reader.GetDepth());
+            TS_ASSERT(reader.Next() == JsonEvent::EndObject);
+            TS_ASSERT(reader.Next() == JsonEvent::EndObject);
+            TS_ASSERT(reader.Next() == JsonEvent::End);
+        }
+
+        void TestStringInPlace()
+        {
+            std::string text = "\"abc\"";
+            JsonReader reader(text.data(), text.size());
+
+            TS_ASSERT(reader.Next() == JsonEvent::String);
+            TS_ASSERT_EQUALS(text.data() + 1, reader.GetData());
+            TS_ASSERT_EQUALS(3u, reader.GetSize());
+        }
+
+        void TestEscapes()
+        {
+            std::string text = "\"a\\\"\\\\\\/\\b\\f\\n\\r\\t\\u0041\\u00e9\\u20ac\\ud83d\\ude00\"";
+            JsonReader reader(text.data(), text.size());
+
+            TS_ASSERT(reader.Next() == JsonEvent::String);
+            TS_ASSERT_EQUALS("a\"\\/\b\f\n\r\tA\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80", reader.GetString());
+        }
+
+        void TestTrailingCommas()
+        {
+            std::string text = "\xef\xbb\xbf{\"a\": [1, 2, ], }";
+            JsonReader reader(text.data(), text.size());
+
+            size_t count = 0;
+            while (reader.Next() != JsonEvent::End)
+            {
+                count++;
+            }
+
+            TS_ASSERT_EQUALS(7u, count);
+        }
+
+        void TestSkipValue()
+        {
+            std::string text = "[{\"a\": [1, {\"b\": 2}]}, 3]";
+            JsonReader reader(text.data(), text.size());
+
+            TS_ASSERT(reader.Next() == JsonEvent::StartArray);
+            reader.SkipValue(reader.Next());
+            TS_ASSERT(reader.Next() == JsonEvent::Number);
+            TS_ASSERT_EQUALS("3", reader.GetString());
+            TS_ASSERT_EQUALS(text.size() - 1, reader.GetOffset());
+        }
+
+        void TestSkipValueErrors()
+        {
+            std::string mismatched = "[[1, {\"a\": \"]\"}}, 2]";
+            JsonReader reader1(mismatched.data(), mismatched.size());
+            reader1.Next();
+            TS_ASSERT_THROWS(reader1.SkipValue(reader1.Next()), std::runtime_error);
+
+            std::string unterminated = "[[1, 2]";
+            JsonReader reader2(unterminated.data(), unterminated.size());
+            reader2.Next();
+            reader2.SkipValue(reader2.Next());
+            TS_ASSERT_THROWS(reader2.Next(), std::runtime_error);
+        }
+
+        void TestErrors()
+        {
+            const char* bad[] =
+            {
+                "",
+                "{",
+                "[1 2]",
+                "{\"a\" 1}",
+                "{1: 2}",
+                "[1}",
+                "01",
+                "1.",
+                "-",
+                "1e",
+                "tru",
+                "\"abc",
+                "\"a\x01\"",
+                "\"\\x\"",
+                "\"\\u12\"",
+                "\"\\ud800\"",
+                "\"\\udc00\"",
+                "[,]",
+                "1 2",
+                "{\"a\": }",
+            };
+
+            for (auto text : bad)
+            {
+                JsonReader reader(text, strlen(text));
+
+                TS_ASSERT_THROWS(while (reader.Next() != JsonEvent::End) {}, std::runtime_error);
+            }
+        }
+    };
+} }
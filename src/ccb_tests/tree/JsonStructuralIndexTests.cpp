@@ -0,0 +1,177 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <random>
+
+#include <ccb/tree/JsonStructuralIndex.hpp>
+
+namespace ccb { namespace tree
+{
+    class JsonStructuralIndexTests : public CxxTest::TestSuite
+    {
+    private:
+
+        static std::vector<size_t> GetPositions(const std::string& text)
+        {
+            JsonStructuralIndex index(text.data(), text.size());
+
+            std::vector<size_t> result;
+            for (auto pos = index.Next(); pos != text.data() + text.size(); pos = index.Next())
+            {
+                result.push_back(pos - text.data());
+            }
+
+            return result;
+        }
+
+        // Byte by byte version of what the index computes. Returns false if the index must throw.
+        static bool GetExpectedPositions(const std::string& text, std::vector<size_t>& result)
+        {
+            bool inString = false;
+            bool escaped = false;
+            bool prevScalar = false;
+
+            for (size_t i = 0; i < text.size(); i++)
+            {
+                auto c = text[i];
+                auto isEscaped = escaped;
+                escaped = (c == '\\') && !isEscaped;
+
+                if ((c == '"') && !isEscaped)
+                {
+                    inString = !inString;
+                    result.push_back(i);
+                    prevScalar = false;
+                }
+                else if (inString)
+                {
+                    if (static_cast<uint8_t>(c) < 0x20)
+                    {
+                        return false;
+                    }
+
+                    if (escaped)
+                    {
+                        result.push_back(i);
+                    }
+
+                    prevScalar = false;
+                }
+                else if ((c == '{') || (c == '}') || (c == '[') || (c == ']') || (c == ':') || (c == ','))
+                {
+                    result.push_back(i);
+                    prevScalar = false;
+                }
+                else if ((c == ' ') || (c == '\t') || (c == '\n') || (c == '\r'))
+                {
+                    prevScalar = false;
+                }
+                else
+                {
+                    if (!prevScalar)
+                    {
+                        result.push_back(i);
+                    }
+
+                    prevScalar = true;
+                }
+            }
+
+            return !inString;
+        }
+
+    public:
+
+        void TestPositions()
+        {
+            std::string text = "{\"a\\\"b\": [12, true], \"c\":\"\\\\\"}";
+
+            std::vector<size_t> expected = { 0, 1, 3, 6, 7, 9, 10, 12, 14, 18, 19, 21, 23, 24, 25, 26, 28, 29 };
+            TS_ASSERT(GetPositions(text) == expected);
+        }
+
+        void TestRandomInput()
+        {
+            const char alphabet[] = "\\\\\\\"\"{}[]:, \n\tab1-";
+
+            std::mt19937 random(42);
+            std::uniform_int_distribution<size_t> symbol(0, sizeof(alphabet) - 2);
+
+            for (size_t size = 0; size < 400; size += 7)
+            {
+                for (size_t attempt = 0; attempt < 20; attempt++)
+                {
+                    std::string text;
+                    for (size_t i = 0; i < size; i++)
+                    {
+                        text.push_back(alphabet[symbol(random)]);
+                    }
+
+                    std::vector<size_t> expected;
+                    if (!GetExpectedPositions(text, expected))
+                    {
+                        TS_ASSERT_THROWS(GetPositions(text), std::runtime_error);
+                        continue;
+                    }
+
+                    TS_ASSERT(GetPositions(text) == expected);
+                }
+            }
+        }
+
+        void TestControlCharacterInString()
+        {
+            std::string text(100, ' ');
+            text[70] = '"';
+            text[80] = '\n';
+            text[90] = '"';
+
+            TS_ASSERT_THROWS(GetPositions(text), std::runtime_error);
+
+            text[80] = 'a';
+            TS_ASSERT_EQUALS(2u, GetPositions(text).size());
+        }
+
+        void TestLongEscapeRun()
+        {
+            // Backslash runs crossing a block boundary.
+            for (size_t count = 1; count < 140; count++)
+            {
+                std::string text = "\"" + std::string(count, '\\') + "\"\"";
+
+                if ((count % 2) == 0)
+                {
+                    TS_ASSERT_THROWS(GetPositions(text), std::runtime_error);
+                }
+                else
+                {
+                    auto positions = GetPositions(text);
+                    TS_ASSERT_EQUALS(0u, positions.front());
+                    TS_ASSERT_EQUALS(count + 2, positions.back());
+                    TS_ASSERT_EQUALS(count / 2 + 3, positions.size());
+                }
+            }
+        }
+    };
+} }
@@ -0,0 +1,114 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <chrono>
+#include <sstream>
+
+#include <ccb/tree/JsonTreeSerializer.hpp>
+
+namespace ccb { namespace tree
+{
+    class JsonTreeSerializerTests : public CxxTest::TestSuite
+    {
+    public:
+
+        void TestRoundTrip()
+        {
+            TreeMap map;
+            map.Set<TreeValue>(L"name").SetString(L"привет");
+            map.Set<TreeValue>(L"count").SetValue(42);
+
+            auto& array = map.Set<TreeArray>(L"items");
+            array.Add<TreeValue>().SetString(L"a");
+            array.Add<TreeMap>().Set<TreeValue>(L"b").SetString(L"c");
+
+            JsonTreeSerializer serializer;
+
+            std::stringstream stream;
+            serializer.Serialize(map, stream);
+
+            auto node = serializer.Deserialize(stream);
+            TS_ASSERT(node->GetType() == TreeNodeType::Map);
+
+            const auto& result = static_cast<const TreeMap&>(*node);
+            TS_ASSERT(result.Get<TreeValue>(L"name").GetString() == L"привет");
+            TS_ASSERT_EQUALS(42, result.Get<TreeValue>(L"count").GetValue<int>());
+
+            const auto& items = result.Get<TreeArray>(L"items");
+            TS_ASSERT_EQUALS(2u, items.GetSize());
+            TS_ASSERT(items.Get<TreeValue>(0).GetString() == L"a");
+            TS_ASSERT(items.Get<TreeMap>(1).Get<TreeValue>(L"b").GetString() == L"c");
+        }
+
+        void TestScalars()
+        {
+            std::string text = "{\"i\": 12, \"f\": -1.5, \"t\": true, \"n\": null, \"s\": \"a\\nb\"}";
+
+            JsonTreeSerializer serializer;
+            auto node = serializer.Deserialize(text.data(), text.size());
+
+            const auto& map = static_cast<const TreeMap&>(*node);
+            TS_ASSERT(map.Get<TreeValue>(L"i").GetString() == L"12");
+            TS_ASSERT(map.Get<TreeValue>(L"f").GetString() == L"-1.5");
+            TS_ASSERT(map.Get<TreeValue>(L"t").GetString() == L"true");
+            TS_ASSERT(map.Get<TreeValue>(L"i").GetValueType() == TreeValueType::Int);
+            TS_ASSERT(map.Get<TreeValue>(L"f").GetValueType() == TreeValueType::Double);
+            TS_ASSERT(map.Get<TreeValue>(L"t").GetValueType() == TreeValueType::Bool);
+            TS_ASSERT(map.Get<TreeValue>(L"n").IsNull());
+            TS_ASSERT(map.Get<TreeValue>(L"n").GetString() == L"null");
+            TS_ASSERT(map.Get<TreeValue>(L"s").GetString() == L"a\nb");
+        }
+
+        void TestDuplicateField()
+        {
+            std::string text = "{\"a\": 1, \"a\": 2}";
+
+            JsonTreeSerializer serializer;
+            TS_ASSERT_THROWS(serializer.Deserialize(text.data(), text.size()), std::runtime_error);
+        }
+
+        void TestDeserializePerformance()
+        {
+            std::ostringstream text;
+            text << "[";
+            for (size_t i = 0; i < 100000; i++)
+            {
+                text << "{\"id\": " << i << ", \"name\": \"item " << i << "\", \"active\": true, \"tags\": [\"x\", \"y\"]},\n";
+            }
+            text << "]";
+
+            std::istringstream stream(text.str());
+            JsonTreeSerializer serializer;
+
+            auto t1 = std::chrono::system_clock::now();
+            auto node = serializer.Deserialize(stream);
+            auto t2 = std::chrono::system_clock::now();
+
+            TS_ASSERT_EQUALS(100000u, static_cast<const TreeArray&>(*node).GetSize());
+
+            std::cout << std::endl << "JSON: " << text.str().size() << " bytes deserialized in "
+                << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " micros" << std::endl;
+        }
+    };
+} }
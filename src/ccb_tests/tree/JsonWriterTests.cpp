@@ -0,0 +1,234 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <chrono>
+#include <limits>
+#include <sstream>
+
+#include <ccb/tree/JsonTreeSerializer.hpp>
+#include <ccb/tree/JsonWriter.hpp>
+
+namespace ccb { namespace tree
+{
+    class JsonWriterTests : public CxxTest::TestSuite
+    {
+    public:
+
+        void TestCompact()
+        {
+            JsonWriter writer;
+            writer.StartObject();
+            writer.Key("a");
+            writer.Int(-12);
+            writer.Key("b");
+            writer.StartArray();
+            writer.Bool(true);
+            writer.Null();
+            writer.StartObject();
+            writer.EndObject();
+            writer.StartArray();
+            writer.EndArray();
+            writer.EndArray();
+            writer.EndObject();
+
+            TS_ASSERT_EQUALS("{\"a\":-12,\"b\":[true,null,{},[]]}", writer.GetString());
+        }
+
+        void TestPretty()
+        {
+            JsonWriter writer(JsonStyle::Pretty);
+            writer.StartObject();
+            writer.Key("a");
+            writer.StartArray();
+            writer.Int(1);
+            writer.Int(2);
+            writer.EndArray();
+            writer.Key("b");
+            writer.StartObject();
+            writer.EndObject();
+            writer.EndObject();
+
+            TS_ASSERT_EQUALS("{\n    \"a\": [\n        1,\n        2\n    ],\n    \"b\": {}\n}", writer.GetString());
+        }
+
+        void TestEscapes()
+        {
+            std::string value = "quote \" backslash \\ tab \t newline \n bell \x07 unicode \xd0\xbf";
+
+            JsonWriter writer;
+            writer.String(value);
+
+            TS_ASSERT_EQUALS("\"quote \\\" backslash \\\\ tab \\t newline \\n bell \\u0007 unicode \xd0\xbf\"", writer.GetString());
+        }
+
+        void TestLongStringEscapes()
+        {
+            // Escapes at every position relative to the vector block boundaries.
+            for (size_t i = 0; i < 70; i++)
+            {
+                std::string value(70, 'x');
+                value[i] = '"';
+
+                JsonWriter writer;
+                writer.String(value);
+
+                std::string expected = "\"" + std::string(i, 'x') + "\\\"" + std::string(69 - i, 'x') + "\"";
+                TS_ASSERT_EQUALS(expected, writer.GetString());
+            }
+        }
+
+        void TestWideStrings()
+        {
+            JsonWriter writer;
+            writer.StartObject();
+            writer.Key(std::wstring(L"имя"));
+            writer.String(std::wstring(L"значение"));
+            writer.EndObject();
+
+            TS_ASSERT_EQUALS("{\"\xd0\xb8\xd0\xbc\xd1\x8f\":\"\xd0\xb7\xd0\xbd\xd0\xb0\xd1\x87\xd0\xb5\xd0\xbd\xd0\xb8\xd0\xb5\"}", writer.GetString());
+        }
+
+        void TestNumbers()
+        {
+            JsonWriter writer;
+            writer.StartArray();
+            writer.Int(0);
+            writer.Int(std::numeric_limits<int64_t>::min());
+            writer.Int(std::numeric_limits<int64_t>::max());
+            writer.Double(0.1);
+            writer.Double(-2.5);
+            writer.Double(1e300);
+            writer.Double(std::numeric_limits<double>::infinity());
+            writer.Double(std::numeric_limits<double>::quiet_NaN());
+            writer.EndArray();
+
+            TS_ASSERT_EQUALS("[0,-9223372036854775808,9223372036854775807,0.1,-2.5,1e+300,null,null]", writer.GetString());
+        }
+
+        void TestDoubleRoundTrip()
+        {
+            double values[] = { 0.1 + 0.2, 1.0 / 3.0, 123456789.123456789, 5e-324, 1.7976931348623157e308 };
+
+            for (auto value : values)
+            {
+                JsonWriter writer;
+                writer.Double(value);
+
+                auto text = writer.GetString();
+                TS_ASSERT_EQUALS(value, std::strtod(text.c_str(), nullptr));
+            }
+        }
+
+        void TestUnbalanced()
+        {
+            JsonWriter writer;
+            TS_ASSERT_THROWS(writer.EndObject(), std::logic_error);
+            TS_ASSERT_THROWS(writer.Key("a"), std::logic_error);
+
+            writer.StartObject();
+            writer.Key("a");
+            TS_ASSERT_THROWS(writer.Key("b"), std::logic_error);
+            TS_ASSERT_THROWS(writer.EndObject(), std::logic_error);
+        }
+
+        void TestChunkedStream()
+        {
+            std::ostringstream stream;
+
+            {
+                JsonWriter writer(stream, JsonStyle::Compact, 16);
+                writer.StartArray();
+                for (int i = 0; i < 100; i++)
+                {
+                    writer.Int(i);
+                }
+                writer.EndArray();
+                writer.Flush();
+            }
+
+            JsonWriter expected;
+            expected.StartArray();
+            for (int i = 0; i < 100; i++)
+            {
+                expected.Int(i);
+            }
+            expected.EndArray();
+
+            TS_ASSERT_EQUALS(expected.GetString(), stream.str());
+        }
+
+        void TestTreeRoundTrip()
+        {
+            TreeMap map;
+            map.Set<TreeValue>(L"text").SetString(L"line\n\"quoted\"\\");
+            map.Set<TreeValue>(L"double").SetValue(0.1);
+            map.Set<TreeValue>(L"null").SetNull();
+
+            auto& array = map.Set<TreeArray>(L"items");
+            array.Add<TreeValue>().SetValue(1);
+            array.Add<TreeValue>().SetValue(false);
+
+            JsonTreeSerializer serializer;
+
+            for (auto style : { JsonStyle::Compact, JsonStyle::Pretty })
+            {
+                auto text = serializer.Serialize(map, style);
+                auto node = serializer.Deserialize(text.data(), text.size());
+
+                const auto& result = static_cast<const TreeMap&>(*node);
+                TS_ASSERT(result.Get<TreeValue>(L"text").GetString() == L"line\n\"quoted\"\\");
+                TS_ASSERT_EQUALS(0.1, result.Get<TreeValue>(L"double").GetValue<double>());
+                TS_ASSERT(result.Get<TreeValue>(L"null").IsNull());
+
+                const auto& items = result.Get<TreeArray>(L"items");
+                TS_ASSERT_EQUALS(2u, items.GetSize());
+                TS_ASSERT_EQUALS(1, items.Get<TreeValue>(0).GetValue<int>());
+                TS_ASSERT_EQUALS(false, items.Get<TreeValue>(1).GetValue<bool>());
+            }
+        }
+
+        void TestSerializePerformance()
+        {
+            TreeArray array;
+            for (size_t i = 0; i < 100000; i++)
+            {
+                auto& item = array.Add<TreeMap>();
+                item.Set<TreeValue>(L"id").SetValue(i);
+                item.Set<TreeValue>(L"name").SetString(L"item " + std::to_wstring(i));
+                item.Set<TreeValue>(L"score").SetValue(i * 0.25);
+                item.Set<TreeValue>(L"active").SetValue(true);
+            }
+
+            JsonTreeSerializer serializer;
+            std::ostringstream stream;
+
+            auto t1 = std::chrono::system_clock::now();
+            serializer.Serialize(array, stream);
+            auto t2 = std::chrono::system_clock::now();
+
+            std::cout << std::endl << "JSON: " << stream.str().size() << " bytes serialized in "
+                << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " micros" << std::endl;
+        }
+    };
+} }
@@ -0,0 +1,156 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+#include <ccb/tree/LazyJsonDocument.hpp>
+
+namespace ccb { namespace tree
+{
+    class LazyJsonDocumentTests : public CxxTest::TestSuite
+    {
+    public:
+
+        void TestNavigation()
+        {
+            LazyJsonDocument document(std::string("\xef\xbb\xbf { \"b\": [1, \"x\\\"y\" , {\"c\": null},], \"a\": {\"s\": \"text\"}, \"f\": 2.5, \"t\": true } \n"));
+
+            auto root = document.GetRoot();
+            TS_ASSERT(root.GetType() == TreeNodeType::Map);
+            TS_ASSERT_EQUALS(4u, root.GetSize());
+            TS_ASSERT(root.HasNode(L"a"));
+            TS_ASSERT(!root.HasNode(L"c"));
+
+            auto items = root.GetNode(L"b");
+            TS_ASSERT(items.GetType() == TreeNodeType::Array);
+            TS_ASSERT_EQUALS(3u, items.GetSize());
+            TS_ASSERT_EQUALS(1, items.Get(0).GetValue<int>());
+            TS_ASSERT(items.Get(1).GetString() == L"x\"y");
+            TS_ASSERT_EQUALS("\"x\\\"y\"", items.Get(1).GetText());
+            TS_ASSERT(items.Get(2).GetNode(L"c").GetTreeValue().IsNull());
+
+            TS_ASSERT(root.GetNode(L"a").GetNode(L"s").GetString() == L"text");
+            TS_ASSERT_EQUALS(2.5, root.GetNode(L"f").GetValue<double>());
+            TS_ASSERT_EQUALS(true, root.GetNode(L"t").GetValue<bool>());
+
+            // Map members keep the document order for positional access.
+            TS_ASSERT_EQUALS("[1, \"x\\\"y\" , {\"c\": null},]", root.Get(0).GetText());
+        }
+
+        void TestErrors()
+        {
+            LazyJsonDocument document(std::string("{\"a\": 1, \"b\": {\"c\": tru}, \"d\": [}"));
+            auto root = document.GetRoot();
+
+            // Only the first token of each member is checked when the map is listed.
+            TS_ASSERT_THROWS(root.HasNode(L"a"), std::runtime_error);
+
+            LazyJsonDocument nested(std::string("{\"a\": 1, \"b\": {\"c\": tru}}"));
+            TS_ASSERT_EQUALS(1, nested.GetRoot().GetNode(L"a").GetValue<int>());
+            TS_ASSERT_THROWS(nested.GetRoot().GetNode(L"b").HasNode(L"c"), std::runtime_error);
+
+            TS_ASSERT_THROWS(LazyJsonDocument(std::string(" ")), std::runtime_error);
+            TS_ASSERT_THROWS(LazyJsonDocument(std::string("1 2")), std::runtime_error);
+            TS_ASSERT_THROWS(LazyJsonDocument(std::string("{} 2")).GetRoot().GetSize(), std::runtime_error);
+            TS_ASSERT_THROWS(LazyJsonDocument(std::string("{\"a\": 1, \"a\": 2}")).GetRoot().HasNode(L"a"), std::runtime_error);
+            TS_ASSERT_THROWS(LazyJsonDocument(std::string("[1]")).GetRoot().GetNode(L"a"), std::runtime_error);
+            TS_ASSERT_THROWS(LazyJsonDocument(std::string("[1]")).GetRoot().Get(1), std::runtime_error);
+
+            LazyJsonNode empty;
+            TS_ASSERT_THROWS(empty.GetType(), std::logic_error);
+            TS_ASSERT_THROWS(empty.GetText(), std::logic_error);
+        }
+
+        void TestConcurrentReads()
+        {
+            std::ostringstream text;
+            text << "{";
+            for (int i = 0; i < 100; i++)
+            {
+                text << ((i != 0) ? ", " : "") << "\"m" << i << "\": {\"a\": [" << i << ", " << i << "]}";
+            }
+            text << "}";
+
+            LazyJsonDocument document(text.str());
+
+            auto read = [&document] (int from)
+            {
+                int64_t sum = 0;
+
+                for (int i = 0; i < 100; i++)
+                {
+                    auto items = document.GetRoot().GetNode(L"m" + std::to_wstring((from + i) % 100)).GetNode(L"a");
+                    sum += items.GetSize() * items.Get(1).GetValue<int64_t>();
+                }
+
+                return sum;
+            };
+
+            int64_t other = 0;
+            std::thread reader([&read, &other] () { other = read(50); });
+
+            auto sum = read(0);
+            reader.join();
+
+            TS_ASSERT_EQUALS(9900, sum);
+            TS_ASSERT_EQUALS(9900, other);
+        }
+
+        void TestToTreeNode()
+        {
+            LazyJsonDocument document(std::string("{\"skip\": [1, 2], \"map\": {\"a\": [true, \"b\"]}}"));
+
+            auto node = document.GetRoot().GetNode(L"map").ToTreeNode();
+            const auto& map = static_cast<const TreeMap&>(*node);
+
+            TS_ASSERT_EQUALS(2u, map.Get<TreeArray>(L"a").GetSize());
+            TS_ASSERT(map.Get<TreeArray>(L"a").Get<TreeValue>(1).GetString() == L"b");
+        }
+
+        void TestLazyPerformance()
+        {
+            std::ostringstream text;
+            text << "{\"items\": [";
+            for (size_t i = 0; i < 100000; i++)
+            {
+                text << "{\"id\": " << i << ", \"name\": \"item " << i << "\", \"active\": true, \"tags\": [\"x\", \"y\"]},\n";
+            }
+            text << "], \"version\": 3}";
+
+            auto size = text.str().size();
+            LazyJsonDocument document(text.str());
+
+            auto t1 = std::chrono::system_clock::now();
+            auto version = document.GetRoot().GetNode(L"version").GetValue<int>();
+            auto t2 = std::chrono::system_clock::now();
+
+            TS_ASSERT_EQUALS(3, version);
+
+            std::cout << std::endl << "JSON: one field of " << size << " bytes read in "
+                << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " micros" << std::endl;
+        }
+    };
+} }
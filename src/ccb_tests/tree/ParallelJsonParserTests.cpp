@@ -0,0 +1,240 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <chrono>
+#include <sstream>
+
+#include <ccb/tree/ParallelJsonParser.hpp>
+
+namespace ccb { namespace tree
+{
+    class ParallelJsonParserTests : public CxxTest::TestSuite
+    {
+    private:
+
+        static std::string MakeItems(size_t count, const char* separator)
+        {
+            std::ostringstream text;
+
+            for (size_t i = 0; i < count; i++)
+            {
+                text << ((i != 0) ? separator : "") << "{\"id\": " << i << ", \"name\": \"item " << i
+                    << "\", \"tags\": [\"a\", \"b\\\"c\"], \"score\": " << (i * 0.5) << ", \"ok\": " << ((i % 2) ? "true" : "false") << "}";
+            }
+
+            return text.str();
+        }
+
+        static void CheckItems(const TreeArray& array, size_t count)
+        {
+            TS_ASSERT_EQUALS(count, array.GetSize());
+
+            for (size_t i = 0; i < array.GetSize(); i++)
+            {
+                const auto& item = array.Get<TreeMap>(i);
+
+                TS_ASSERT_EQUALS(static_cast<int64_t>(i), item.Get<TreeValue>(L"id").GetValue<int64_t>());
+                TS_ASSERT(item.Get<TreeValue>(L"name").GetString() == L"item " + std::to_wstring(i));
+                TS_ASSERT(item.Get<TreeArray>(L"tags").Get<TreeValue>(1).GetString() == L"b\"c");
+            }
+        }
+
+    public:
+
+        void TestArray()
+        {
+            auto text = "\xef\xbb\xbf [" + MakeItems(50000, ",\n ") + ", 7, \"x\", [], null ]\n";
+
+            for (size_t threads = 1; threads <= 4; threads *= 4)
+            {
+                auto array = ParallelJsonParser(threads).ParseArray(text.data(), text.size());
+
+                TS_ASSERT_EQUALS(50004u, array->GetSize());
+                TS_ASSERT_EQUALS(7, array->Get<TreeValue>(50000).GetValue<int>());
+                TS_ASSERT(array->Get<TreeValue>(50001).GetString() == L"x");
+                TS_ASSERT_EQUALS(0u, array->Get<TreeArray>(50002).GetSize());
+                TS_ASSERT(array->Get<TreeValue>(50003).IsNull());
+            }
+        }
+
+        void TestSmallInputs()
+        {
+            std::string empty = " [ ] ";
+            TS_ASSERT_EQUALS(0u, ParallelJsonParser(4).ParseArray(empty.data(), empty.size())->GetSize());
+
+            std::string single = "[{\"a\": 1}]";
+            TS_ASSERT_EQUALS(1u, ParallelJsonParser(4).ParseArray(single.data(), single.size())->GetSize());
+
+            std::string lines = "\n{\"a\": 1}\r\n  \n2";
+            auto array = ParallelJsonParser(4).ParseLines(lines.data(), lines.size());
+            TS_ASSERT_EQUALS(2u, array->GetSize());
+            TS_ASSERT_EQUALS(2, array->Get<TreeValue>(1).GetValue<int>());
+        }
+
+        void TestLines()
+        {
+            auto text = MakeItems(50000, "\n") + "\n";
+
+            for (size_t threads = 1; threads <= 8; threads *= 2)
+            {
+                auto array = ParallelJsonParser(threads).ParseLines(text.data(), text.size());
+                CheckItems(*array, 50000);
+            }
+        }
+
+        void TestCallback()
+        {
+            auto text = "[" + MakeItems(20000, ",") + "]";
+
+            size_t expected = 0;
+            bool ordered = true;
+
+            ParallelJsonParser(4).ParseArray(text.data(), text.size(), [&] (size_t idx, std::unique_ptr<TreeNode>&& node)
+            {
+                ordered = ordered && (idx == expected) &&
+                    (static_cast<TreeMap&>(*node).Get<TreeValue>(L"id").GetValue<size_t>() == idx);
+                expected++;
+            });
+
+            TS_ASSERT(ordered);
+            TS_ASSERT_EQUALS(20000u, expected);
+
+            // An exception from the callback stops the workers.
+            size_t calls = 0;
+            TS_ASSERT_THROWS(ParallelJsonParser(4).ParseArray(text.data(), text.size(), [&calls] (size_t, std::unique_ptr<TreeNode>&&)
+            {
+                if (++calls == 10)
+                {
+                    throw std::logic_error("stop");
+                }
+            }), std::logic_error);
+        }
+
+        void TestErrors()
+        {
+            auto items = MakeItems(20000, "\n");
+            auto broken = items + "\n{\"a\" 1}\n" + items;
+
+            std::string message;
+
+            try
+            {
+                ParallelJsonParser(4).ParseLines(broken.data(), broken.size());
+            }
+            catch (const std::runtime_error& e)
+            {
+                message = e.what();
+            }
+
+            TS_ASSERT_EQUALS("Missing colon after field name at offset 5 of line 20001", message);
+
+            auto array = "[" + MakeItems(20000, ",") + ", {\"a\" 1}, 2]";
+
+            message.clear();
+
+            try
+            {
+                ParallelJsonParser(4).ParseArray(array.data(), array.size());
+            }
+            catch (const std::runtime_error& e)
+            {
+                message = e.what();
+            }
+
+            TS_ASSERT_EQUALS("Missing colon after field name at offset 5 of item 20000", message);
+
+            std::string notArray = "{\"a\": 1}";
+            TS_ASSERT_THROWS(ParallelJsonParser(4).ParseArray(notArray.data(), notArray.size()), std::runtime_error);
+
+            std::string unclosed = "[1, 2";
+            TS_ASSERT_THROWS(ParallelJsonParser(4).ParseArray(unclosed.data(), unclosed.size()), std::runtime_error);
+        }
+
+        void TestItemsBeforeErrorAreDelivered()
+        {
+            auto array = "[" + MakeItems(20000, ",") + ", {\"a\" 1}, 2]";
+            auto lines = MakeItems(20000, "\n") + "\n{\"a\" 1}\n2";
+
+            for (size_t threads = 1; threads <= 4; threads *= 4)
+            {
+                size_t arrayItems = 0;
+                TS_ASSERT_THROWS(ParallelJsonParser(threads).ParseArray(array.data(), array.size(), [&arrayItems] (size_t idx, std::unique_ptr<TreeNode>&&)
+                {
+                    arrayItems += (idx == arrayItems) ? 1 : 0;
+                }), std::runtime_error);
+
+                TS_ASSERT_EQUALS(20000u, arrayItems);
+
+                size_t lineItems = 0;
+                TS_ASSERT_THROWS(ParallelJsonParser(threads).ParseLines(lines.data(), lines.size(), [&lineItems] (size_t idx, std::unique_ptr<TreeNode>&&)
+                {
+                    lineItems += (idx == lineItems) ? 1 : 0;
+                }), std::runtime_error);
+
+                TS_ASSERT_EQUALS(20000u, lineItems);
+            }
+        }
+
+        void TestOneThreadCallback()
+        {
+            auto text = " [" + MakeItems(1000, ",") + ", 7 ] ";
+
+            std::unique_ptr<TreeArray> array(new TreeArray());
+            ParallelJsonParser(1).ParseArray(text.data(), text.size(), [&array] (size_t, std::unique_ptr<TreeNode>&& node)
+            {
+                array->Add(std::move(node));
+            });
+
+            TS_ASSERT_EQUALS(1001u, array->GetSize());
+            TS_ASSERT_EQUALS(7, array->Get<TreeValue>(1000).GetValue<int>());
+
+            auto ignore = [] (size_t, std::unique_ptr<TreeNode>&&) {};
+
+            std::string notArray = "{\"a\": 1}";
+            TS_ASSERT_THROWS(ParallelJsonParser(1).ParseArray(notArray.data(), notArray.size(), ignore), std::runtime_error);
+
+            std::string trailing = "[1, 2] 3";
+            TS_ASSERT_THROWS(ParallelJsonParser(1).ParseArray(trailing.data(), trailing.size(), ignore), std::runtime_error);
+        }
+
+        void TestPerformance()
+        {
+            auto text = "[" + MakeItems(400000, ",\n") + "]";
+
+            auto t1 = std::chrono::system_clock::now();
+            auto single = JsonTreeSerializer().Deserialize(text.data(), text.size());
+            auto t2 = std::chrono::system_clock::now();
+            auto parallel = ParallelJsonParser().ParseArray(text.data(), text.size());
+            auto t3 = std::chrono::system_clock::now();
+
+            CheckItems(*parallel, 400000);
+            TS_ASSERT_EQUALS(static_cast<TreeArray&>(*single).GetSize(), parallel->GetSize());
+
+            std::cout << std::endl << "JSON: " << text.size() << " bytes parsed in "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count() << " ms on one thread, "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count() << " ms on "
+                << std::thread::hardware_concurrency() << " threads" << std::endl;
+        }
+    };
+} }
@@ -0,0 +1,106 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <ccb/tree/JsonTreeSerializer.hpp>
+#include <ccb/tree/TreeDiff.hpp>
+
+namespace ccb { namespace tree
+{
+    class TreeDiffTests : public CxxTest::TestSuite
+    {
+    private:
+
+        static std::vector<TreeChange> Compare(const std::string& before, const std::string& after)
+        {
+            auto beforeTree = JsonTreeSerializer().Deserialize(before.data(), before.size());
+            auto afterTree = JsonTreeSerializer().Deserialize(after.data(), after.size());
+
+            return TreeDiff().Compare(*beforeTree, *afterTree);
+        }
+
+    public:
+
+        void TestEqualTrees()
+        {
+            auto changes = Compare(
+                "{\"a\": 1, \"b\": [true, null, 2.5, \"s\"], \"c\": {\"d\": {}}}",
+                "{\"c\": {\"d\": {}}, \"b\": [true, null, 2.5, \"s\"], \"a\": 1}");
+
+            TS_ASSERT(changes.empty());
+        }
+
+        void TestChanges()
+        {
+            auto changes = Compare(
+                "{\"a\": 1, \"b\": [1, 2, 3], \"c\": {\"d\": \"x\", \"e/f\": 1}, \"g\": 1, \"h\": 1}",
+                "{\"a\": 2, \"b\": [1, 5], \"c\": {\"d\": \"x\", \"e/f\": 2, \"n\": 0}, \"g\": 1.0, \"i\": 1}");
+
+            TS_ASSERT_EQUALS(8u, changes.size());
+
+            TS_ASSERT(changes[0].type == TreeChangeType::Modified);
+            TS_ASSERT(changes[0].path == L"/a");
+            TS_ASSERT(changes[1].type == TreeChangeType::Modified);
+            TS_ASSERT(changes[1].path == L"/b/1");
+            TS_ASSERT(changes[2].type == TreeChangeType::Removed);
+            TS_ASSERT(changes[2].path == L"/b/2");
+            TS_ASSERT(changes[3].type == TreeChangeType::Modified);
+            TS_ASSERT(changes[3].path == L"/c/e~1f");
+            TS_ASSERT(changes[4].type == TreeChangeType::Added);
+            TS_ASSERT(changes[4].path == L"/c/n");
+            TS_ASSERT(changes[5].type == TreeChangeType::Modified);
+            TS_ASSERT(changes[5].path == L"/g");
+            TS_ASSERT(changes[6].type == TreeChangeType::Removed);
+            TS_ASSERT(changes[6].path == L"/h");
+            TS_ASSERT(changes[7].type == TreeChangeType::Added);
+            TS_ASSERT(changes[7].path == L"/i");
+        }
+
+        void TestTypeChange()
+        {
+            auto changes = Compare("{\"a\": {\"b\": 1}}", "{\"a\": [1]}");
+
+            TS_ASSERT_EQUALS(1u, changes.size());
+            TS_ASSERT(changes[0].type == TreeChangeType::Modified);
+            TS_ASSERT(changes[0].path == L"/a");
+
+            changes = Compare("[1]", "{}");
+
+            TS_ASSERT_EQUALS(1u, changes.size());
+            TS_ASSERT(changes[0].path == L"");
+        }
+
+        void TestAffects()
+        {
+            TreeChange change(TreeChangeType::Modified, L"/a/b");
+
+            TS_ASSERT(change.Affects(L"/a/b"));
+            TS_ASSERT(change.Affects(L"/a"));
+            TS_ASSERT(change.Affects(L""));
+            TS_ASSERT(change.Affects(L"/a/b/c"));
+            TS_ASSERT(!change.Affects(L"/a/bc"));
+            TS_ASSERT(!change.Affects(L"/a/c"));
+            TS_ASSERT(!change.Affects(L"/ab"));
+        }
+    };
+} }
@@ -0,0 +1,145 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <chrono>
+#include <sstream>
+
+#include <ccb/tree/JsonTreeSerializer.hpp>
+
+namespace ccb { namespace tree
+{
+    class TreeDocumentTests : public CxxTest::TestSuite
+    {
+    private:
+
+        static TreeDocument Parse(const std::string& text)
+        {
+            return JsonTreeSerializer().DeserializeDocument(text.data(), text.size());
+        }
+
+    public:
+
+        void TestNavigation()
+        {
+            auto document = Parse("{\"b\": [1, \"x\", {\"c\": null}], \"a\": true, \"\xd0\xb8\": \"\xd0\xb9\"}");
+            auto root = document.GetRoot();
+
+            TS_ASSERT(root.GetType() == TreeNodeType::Map);
+            TS_ASSERT_EQUALS(3u, root.GetSize());
+
+            // Members keep document order.
+            TS_ASSERT(root.Get(0).GetName() == L"b");
+            TS_ASSERT(root.Get(1).GetName() == L"a");
+
+            auto array = root.GetNode(L"b");
+            TS_ASSERT(array.GetType() == TreeNodeType::Array);
+            TS_ASSERT_EQUALS(3u, array.GetSize());
+            TS_ASSERT_EQUALS(1, array.Get(0).GetValue<int>());
+            TS_ASSERT(array.Get(1).GetString() == L"x");
+            TS_ASSERT_EQUALS("null", array.Get(2).GetNode(L"c").GetText());
+
+            TS_ASSERT_EQUALS("true", root.GetNode(L"a").GetText());
+            TS_ASSERT(root.GetNode(L"a").GetValue<bool>());
+            TS_ASSERT(root.GetNode(L"a").GetValueType() == TreeValueType::Bool);
+            TS_ASSERT(array.Get(0).GetValueType() == TreeValueType::Int);
+            TS_ASSERT(array.Get(1).GetValueType() == TreeValueType::String);
+            TS_ASSERT(root.GetNode(L"и").GetString() == L"й");
+
+            TS_ASSERT(root.HasNode(L"a"));
+            TS_ASSERT(!root.HasNode(L"z"));
+            TS_ASSERT_THROWS(root.GetNode(L"z"), std::runtime_error);
+            TS_ASSERT_THROWS(array.Get(3), std::runtime_error);
+            TS_ASSERT_THROWS(array.GetNode(L"a"), std::runtime_error);
+            TS_ASSERT_THROWS(root.GetText(), std::runtime_error);
+        }
+
+        void TestNodesAreContiguous()
+        {
+            auto document = Parse("[[1, 2], [3, [4, 5]], 6]");
+
+            TS_ASSERT_EQUALS(10u, document.GetNodeCount());
+
+            auto root = document.GetRoot();
+            TS_ASSERT_EQUALS(4, root.Get(1).Get(1).Get(0).GetValue<int>());
+            TS_ASSERT_EQUALS(6, root.Get(2).GetValue<int>());
+        }
+
+        void TestMoveKeepsNodes()
+        {
+            auto document = Parse("{\"a\": \"b\"}");
+            auto node = document.GetRoot().GetNode(L"a");
+
+            TreeDocument moved(std::move(document));
+
+            TS_ASSERT(node.GetString() == L"b");
+            TS_ASSERT(moved.GetRoot().GetNode(L"a").GetString() == L"b");
+        }
+
+        void TestDuplicateField()
+        {
+            TS_ASSERT_THROWS(Parse("{\"a\": 1, \"b\": 2, \"a\": 3}"), std::runtime_error);
+            TS_ASSERT_THROWS_NOTHING(Parse("{\"a\": {\"a\": 1}, \"b\": [{\"a\": 1}, {\"a\": 2}]}"));
+        }
+
+        void TestToTreeNode()
+        {
+            auto document = Parse("{\"a\": [\"x\", {\"b\": 2}]}");
+
+            auto node = document.GetRoot().ToTreeNode();
+            const auto& map = static_cast<const TreeMap&>(*node);
+
+            const auto& array = map.Get<TreeArray>(L"a");
+            TS_ASSERT(array.Get<TreeValue>(0).GetString() == L"x");
+            TS_ASSERT_EQUALS(2, array.Get<TreeMap>(1).Get<TreeValue>(L"b").GetValue<int>());
+            TS_ASSERT(array.Get<TreeMap>(1).Get<TreeValue>(L"b").GetValueType() == TreeValueType::Int);
+        }
+
+        void TestDocumentPerformance()
+        {
+            std::ostringstream stream;
+            stream << "[";
+            for (size_t i = 0; i < 100000; i++)
+            {
+                stream << "{\"id\": " << i << ", \"name\": \"item " << i << "\", \"active\": true, \"tags\": [\"x\", \"y\"]},\n";
+            }
+            stream << "]";
+
+            auto text = stream.str();
+            JsonTreeSerializer serializer;
+
+            auto t1 = std::chrono::system_clock::now();
+            auto tree = serializer.Deserialize(text.data(), text.size());
+            auto t2 = std::chrono::system_clock::now();
+            auto document = serializer.DeserializeDocument(text.data(), text.size());
+            auto t3 = std::chrono::system_clock::now();
+
+            TS_ASSERT_EQUALS(100000u, document.GetRoot().GetSize());
+
+            std::cout << std::endl << "JSON: " << text.size() << " bytes to tree in "
+                << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " micros, to document in "
+                << std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count() << " micros, "
+                << document.GetMemorySize() << " bytes" << std::endl;
+        }
+    };
+} }
@@ -0,0 +1,159 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <chrono>
+#include <map>
+
+#include <ccb/tree/TreeMap.hpp>
+
+namespace ccb { namespace tree
+{
+    class TreeMapTests : public CxxTest::TestSuite
+    {
+    public:
+
+        void TestInsertionOrder()
+        {
+            TreeMap map;
+            map.Set<TreeValue>(L"b").SetValue(1);
+            map.Set<TreeValue>(L"a").SetValue(2);
+            map.Set<TreeValue>(L"c").SetValue(3);
+
+            // Replacing keeps the original position.
+            map.Set<TreeValue>(L"b").SetValue(4);
+
+            TS_ASSERT_EQUALS(3u, map.GetSize());
+            TS_ASSERT(map.GetNodes()[0].first == L"b");
+            TS_ASSERT(map.GetNodes()[1].first == L"a");
+            TS_ASSERT(map.GetNodes()[2].first == L"c");
+            TS_ASSERT_EQUALS(4, map.Get<TreeValue>(L"b").GetValue<int>());
+        }
+
+        void TestLookup()
+        {
+            TreeMap map;
+            map.Set<TreeValue>(L"name").SetString(L"value");
+
+            std::wstring buffer = L"name and more";
+
+            TS_ASSERT(map.HasNode(L"name"));
+            TS_ASSERT(map.HasNode(buffer.data(), 4));
+            TS_ASSERT(!map.HasNode(buffer.data(), 3));
+            TS_ASSERT(!map.HasNode(buffer));
+            TS_ASSERT(map.Get<TreeValue>(buffer.data(), 4).GetString() == L"value");
+            TS_ASSERT_THROWS(map.GetNode(L"other"), std::runtime_error);
+            TS_ASSERT_THROWS(map.Get<TreeMap>(L"name"), std::runtime_error);
+        }
+
+        void TestAdd()
+        {
+            TreeMap map;
+            TS_ASSERT(map.Add(L"a", std::unique_ptr<TreeNode>(new TreeValue(L"1"))));
+            TS_ASSERT(!map.Add(L"a", std::unique_ptr<TreeNode>(new TreeValue(L"2"))));
+            TS_ASSERT(map.Get<TreeValue>(L"a").GetString() == L"1");
+        }
+
+        void TestManyKeys()
+        {
+            // Goes through the linear and the indexed lookup, and several rehashes.
+            TreeMap map;
+            for (int i = 0; i < 5000; i++)
+            {
+                map.Set<TreeValue>(L"key" + std::to_wstring(i)).SetValue(i);
+
+                TS_ASSERT(map.HasNode(L"key0"));
+                TS_ASSERT(map.HasNode(L"key" + std::to_wstring(i)));
+                TS_ASSERT(!map.HasNode(L"key" + std::to_wstring(i + 1)));
+            }
+
+            TS_ASSERT_EQUALS(5000u, map.GetSize());
+            for (int i = 0; i < 5000; i++)
+            {
+                TS_ASSERT(map.GetNodes()[i].first == L"key" + std::to_wstring(i));
+                TS_ASSERT_EQUALS(i, map.Get<TreeValue>(L"key" + std::to_wstring(i)).GetValue<int>());
+            }
+        }
+
+        void TestReserve()
+        {
+            TreeMap map;
+            map.Set<TreeValue>(L"a").SetValue(1);
+            map.Reserve(100);
+
+            for (int i = 0; i < 100; i++)
+            {
+                map.Set<TreeValue>(std::to_wstring(i)).SetValue(i);
+            }
+
+            TS_ASSERT_EQUALS(1, map.Get<TreeValue>(L"a").GetValue<int>());
+            TS_ASSERT_EQUALS(99, map.Get<TreeValue>(L"99").GetValue<int>());
+        }
+
+        void TestLookupPerformance()
+        {
+            const int count = 5000;
+
+            std::vector<std::wstring> names;
+            for (int i = 0; i < count; i++)
+            {
+                names.push_back(L"config.section.field" + std::to_wstring(i));
+            }
+
+            TreeMap map;
+            std::map<std::wstring, int> reference;
+            for (int i = 0; i < count; i++)
+            {
+                map.Set<TreeValue>(names[i]).SetValue(i);
+                reference[names[i]] = i;
+            }
+
+            int64_t sum1 = 0;
+            int64_t sum2 = 0;
+
+            auto t1 = std::chrono::system_clock::now();
+            for (int r = 0; r < 100; r++)
+            {
+                for (const auto& name : names)
+                {
+                    sum1 += map.Get<TreeValue>(name).GetValue<int>();
+                }
+            }
+            auto t2 = std::chrono::system_clock::now();
+            for (int r = 0; r < 100; r++)
+            {
+                for (const auto& name : names)
+                {
+                    sum2 += reference.find(name)->second;
+                }
+            }
+            auto t3 = std::chrono::system_clock::now();
+
+            TS_ASSERT_EQUALS(sum1, sum2);
+
+            std::cout << std::endl << "TreeMap: " << 100 * count << " lookups in "
+                << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " micros, std::map in "
+                << std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count() << " micros" << std::endl;
+        }
+    };
+} }
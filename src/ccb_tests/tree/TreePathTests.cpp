@@ -0,0 +1,167 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <chrono>
+#include <sstream>
+
+#include <ccb/tree/JsonPathExtractor.hpp>
+#include <ccb/tree/JsonTreeSerializer.hpp>
+#include <ccb/tree/LazyJsonDocument.hpp>
+#include <ccb/tree/TreeDocument.hpp>
+#include <ccb/tree/TreePath.hpp>
+
+namespace ccb { namespace tree
+{
+    class TreePathTests : public CxxTest::TestSuite
+    {
+    private:
+
+        static const char* GetText()
+        {
+            return "{\"servers\": [{\"name\": \"a\", \"port\": 80}, {\"name\": \"b\", \"port\": 81}],"
+                " \"a/b\": {\"m~n\": 1}, \"10\": 2, \"*\": 3}";
+        }
+
+    public:
+
+        void TestParse()
+        {
+            TreePath path(L"/a~1b/m~0n/*/01/1");
+
+            TS_ASSERT_EQUALS(5u, path.GetSize());
+            TS_ASSERT(path.GetStep(0).name == L"a/b");
+            TS_ASSERT(path.GetStep(1).name == L"m~n");
+            TS_ASSERT(path.GetStep(2).any);
+            TS_ASSERT(!path.GetStep(3).isIndex);
+            TS_ASSERT(path.GetStep(4).isIndex);
+            TS_ASSERT_EQUALS(1u, path.GetStep(4).index);
+            TS_ASSERT(path.HasWildcards());
+            TS_ASSERT(path.ToString() == L"/a~1b/m~0n/*/01/1");
+
+            TS_ASSERT_EQUALS(0u, TreePath(L"").GetSize());
+            TS_ASSERT_EQUALS(1u, TreePath(L"/").GetSize());
+            TS_ASSERT_THROWS(TreePath(L"a"), std::invalid_argument);
+            TS_ASSERT_THROWS(TreePath(L"/a~2"), std::invalid_argument);
+            TS_ASSERT_THROWS(TreePath(L"/a~"), std::invalid_argument);
+        }
+
+        void TestTree()
+        {
+            std::string text = GetText();
+            auto root = JsonTreeSerializer().Deserialize(text.data(), text.size());
+
+            TS_ASSERT(TreePath(L"/servers/1/name").Get<TreeValue>(*root).GetString() == L"b");
+            TS_ASSERT_EQUALS(1, TreePath(L"/a~1b/m~0n").Get<TreeValue>(*root).GetValue<int>());
+            TS_ASSERT_EQUALS(2, TreePath(L"/10").Get<TreeValue>(*root).GetValue<int>());
+            TS_ASSERT_EQUALS(root.get(), TreePath(L"").Find(*root));
+            TS_ASSERT(TreePath(L"/servers/2").Find(*root) == nullptr);
+            TS_ASSERT(TreePath(L"/servers/name").Find(*root) == nullptr);
+            TS_ASSERT_THROWS(TreePath(L"/servers").Get<TreeValue>(*root), std::runtime_error);
+
+            auto ports = TreePath(L"/servers/*/port").FindAll(*root);
+            TS_ASSERT_EQUALS(2u, ports.size());
+            TS_ASSERT_EQUALS(81, static_cast<const TreeValue&>(*ports[1]).GetValue<int>());
+
+            TS_ASSERT_EQUALS(4u, TreePath(L"/*").FindAll(*root).size());
+        }
+
+        void TestHandles()
+        {
+            std::string text = GetText();
+            auto document = JsonTreeSerializer().DeserializeDocument(text.data(), text.size());
+            LazyJsonDocument lazy(std::move(text));
+
+            auto names = TreePath(L"/servers/*/name").Select(document.GetRoot());
+            TS_ASSERT_EQUALS(2u, names.size());
+            TS_ASSERT(names[0].GetString() == L"a");
+
+            auto lazyNames = TreePath(L"/servers/*/name").Select(lazy.GetRoot());
+            TS_ASSERT_EQUALS(2u, lazyNames.size());
+            TS_ASSERT(lazyNames[1].GetString() == L"b");
+
+            TS_ASSERT_EQUALS(1u, TreePath(L"/servers/0/port").Select(lazy.GetRoot()).size());
+            TS_ASSERT_EQUALS(0u, TreePath(L"/servers/x").Select(lazy.GetRoot()).size());
+        }
+
+        void TestExtractor()
+        {
+            std::string text = GetText();
+
+            JsonPathExtractor extractor;
+            auto names = extractor.Add(TreePath(L"/servers/*/name"));
+            auto servers = extractor.Add(TreePath(L"/servers"));
+            auto second = extractor.Add(TreePath(L"/servers/1/port"));
+            auto missing = extractor.Add(TreePath(L"/none"));
+            auto escaped = extractor.Add(TreePath(L"/a~1b/m~0n"));
+
+            std::vector<std::wstring> results[5];
+
+            extractor.Extract(text.data(), text.size(), [&](size_t path, const TreeNode& node)
+            {
+                results[path].push_back(node.GetType() == TreeNodeType::Value ? static_cast<const TreeValue&>(node).GetString() : L"container");
+            });
+
+            TS_ASSERT_EQUALS(2u, results[names].size());
+            TS_ASSERT(results[names][1] == L"b");
+            TS_ASSERT_EQUALS(1u, results[servers].size());
+            TS_ASSERT_EQUALS(1u, results[second].size());
+            TS_ASSERT(results[second][0] == L"81");
+            TS_ASSERT_EQUALS(0u, results[missing].size());
+            TS_ASSERT(results[escaped] == std::vector<std::wstring>(1, L"1"));
+
+            std::string bad = "{\"a\": [1, 2], \"b\": 1} x";
+            TS_ASSERT_THROWS(extractor.Extract(bad.data(), bad.size(), [](size_t, const TreeNode&) {}), std::runtime_error);
+        }
+
+        void TestExtractorPerformance()
+        {
+            std::ostringstream stream;
+            stream << "{\"items\": [";
+            for (size_t i = 0; i < 100000; i++)
+            {
+                stream << "{\"id\": " << i << ", \"name\": \"item " << i << "\", \"active\": true, \"tags\": [\"x\", \"y\"]},\n";
+            }
+            stream << "]}";
+
+            auto text = stream.str();
+
+            JsonPathExtractor extractor;
+            extractor.Add(TreePath(L"/items/*/id"));
+
+            int64_t sum = 0;
+
+            auto t1 = std::chrono::system_clock::now();
+            extractor.Extract(text.data(), text.size(), [&](size_t, const TreeNode& node)
+            {
+                sum += static_cast<const TreeValue&>(node).GetValue<int64_t>();
+            });
+            auto t2 = std::chrono::system_clock::now();
+
+            TS_ASSERT_EQUALS(int64_t(99999) * 100000 / 2, sum);
+
+            std::cout << std::endl << "JSON: " << text.size() << " bytes, ids extracted in "
+                << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " micros" << std::endl;
+        }
+    };
+} }
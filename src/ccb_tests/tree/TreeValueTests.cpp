@@ -0,0 +1,155 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Mikhail Balakhno
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cxxtest/TestSuite.h>
+
+#include <limits>
+#include <thread>
+
+#include <ccb/tree/TreeValue.hpp>
+
+namespace ccb { namespace tree
+{
+    class TreeValueTests : public CxxTest::TestSuite
+    {
+    public:
+
+        void TestNativeValues()
+        {
+            TreeValue value;
+
+            value.SetValue(true);
+            TS_ASSERT(value.GetValueType() == TreeValueType::Bool);
+            TS_ASSERT(value.GetValue<bool>());
+            TS_ASSERT(value.GetString() == L"true");
+
+            value.SetValue(-42);
+            TS_ASSERT(value.GetValueType() == TreeValueType::Int);
+            TS_ASSERT_EQUALS(-42, value.GetValue<int>());
+            TS_ASSERT_EQUALS(-42.0, value.GetValue<double>());
+            TS_ASSERT(value.GetString() == L"-42");
+
+            value.SetValue(0.1);
+            TS_ASSERT(value.GetValueType() == TreeValueType::Double);
+            TS_ASSERT_EQUALS(0.1, value.GetValue<double>());
+            TS_ASSERT(value.GetString() == L"0.1");
+
+            value.SetNull();
+            TS_ASSERT(value.IsNull());
+            TS_ASSERT(value.GetString() == L"null");
+            TS_ASSERT_EQUALS(0, value.GetValue<int>());
+
+            value.SetString(L"text");
+            TS_ASSERT(value.GetValueType() == TreeValueType::String);
+            TS_ASSERT(value.GetString() == L"text");
+        }
+
+        void TestConcurrentConstReads()
+        {
+            TreeValue value;
+            value.SetValue(0.25);
+
+            const auto& shared = value;
+            bool same = true;
+
+            std::thread reader([&shared, &same] ()
+            {
+                for (int i = 0; i < 1000; i++)
+                {
+                    same = same && (shared.GetString() == L"0.25");
+                }
+            });
+
+            for (int i = 0; i < 1000; i++)
+            {
+                TS_ASSERT(shared.GetString() == L"0.25");
+            }
+
+            reader.join();
+            TS_ASSERT(same);
+        }
+
+        void TestStringValues()
+        {
+            TreeValue value(L"-5");
+            TS_ASSERT_EQUALS(-5, value.GetValue<int8_t>());
+            TS_ASSERT_EQUALS(-5, value.GetValue<int64_t>());
+
+            value.SetString(L"200");
+            TS_ASSERT_EQUALS(200u, value.GetValue<uint8_t>());
+
+            value.SetString(L"true");
+            TS_ASSERT(value.GetValue<bool>());
+
+            value.SetString(L"2.5");
+            TS_ASSERT_EQUALS(2.5, value.GetValue<double>());
+        }
+
+        void TestLargeUnsigned()
+        {
+            auto max = std::numeric_limits<uint64_t>::max();
+
+            TreeValue value;
+            value.SetValue(max);
+
+            TS_ASSERT(value.GetValueType() == TreeValueType::String);
+            TS_ASSERT_EQUALS(max, value.GetValue<uint64_t>());
+        }
+
+        void TestSetNumber()
+        {
+            TreeValue value;
+
+            value.SetNumber("-9223372036854775808", 20);
+            TS_ASSERT(value.GetValueType() == TreeValueType::Int);
+            TS_ASSERT_EQUALS(std::numeric_limits<int64_t>::min(), value.GetValue<int64_t>());
+
+            value.SetNumber("18446744073709551615", 20);
+            TS_ASSERT(value.GetValueType() == TreeValueType::String);
+            TS_ASSERT_EQUALS(std::numeric_limits<uint64_t>::max(), value.GetValue<uint64_t>());
+
+            value.SetNumber("1.5e3", 5);
+            TS_ASSERT(value.GetValueType() == TreeValueType::Double);
+            TS_ASSERT_EQUALS(1500.0, value.GetValue<double>());
+            TS_ASSERT(value.GetString() == L"1500");
+        }
+
+        void TestFormatDouble()
+        {
+            char buffer[32];
+
+            double values[] = { 0.1, 1.0 / 3, 1e300, -2.5e-10, 123456789012345678.0 };
+            for (auto v : values)
+            {
+                auto size = details::FormatDouble(v, buffer);
+                TS_ASSERT_EQUALS(v, strtod(std::string(buffer, size).c_str(), nullptr));
+            }
+
+            TS_ASSERT_EQUALS("0.1", std::string(buffer, details::FormatDouble(0.1, buffer)));
+            TS_ASSERT_EQUALS("-0.0025", std::string(buffer, details::FormatDouble(-0.0025, buffer)));
+            TS_ASSERT_EQUALS("12345.75", std::string(buffer, details::FormatDouble(12345.75, buffer)));
+            TS_ASSERT_EQUALS("100", std::string(buffer, details::FormatDouble(100.0, buffer)));
+            TS_ASSERT_EQUALS("1e-05", std::string(buffer, details::FormatDouble(1e-5, buffer)));
+            TS_ASSERT_EQUALS("0.30000000000000004", std::string(buffer, details::FormatDouble(0.1 + 0.2, buffer)));
+        }
+    };
+} }